@@ -0,0 +1,432 @@
+/*
+ * Aggregates - agrégats et top-K UserAssist en une passe (moteur de "Comparer Users")
+ * Par utilisateur, par application et par GUID : lignes, exécutions, focus, temps de focus,
+ * première/dernière exécution et nombre d'éléments distincts ; top-K par tas min borné, pris
+ * sur les totaux par application (une application vue dans plusieurs hives n'y figure qu'une fois).
+ *
+ * Chaque shard (plage de lignes, hive) agrège dans son propre moteur sans verrou, les
+ * moteurs partiels sont fusionnés à la fin : le résultat ne dépend pas du découpage.
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+enum AggregateMetric : uint8_t {
+    UA_METRIC_RUNS = 0,         // Compteur d'exécutions
+    UA_METRIC_FOCUS_TIME = 1    // Temps de focus (ms)
+};
+
+struct AggregateOptions {
+    size_t topK = 5;
+    AggregateMetric metric = UA_METRIC_RUNS;
+};
+
+// K meilleurs éléments : tas min borné (la racine est le moins bon, évincé en O(log K))
+// Égalité de score départagée par la valeur, pour un résultat indépendant de l'ordre d'arrivée
+template <typename T>
+class BoundedTopK {
+public:
+    using Item = std::pair<uint64_t, T>;
+
+private:
+    size_t capacity = 0;
+    std::vector<Item> heap;
+
+    static bool Better(const Item& a, const Item& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    }
+
+public:
+    explicit BoundedTopK(size_t k = 0) : capacity(k) {}
+
+    size_t size() const { return heap.size(); }
+
+    void Reset(size_t k) {
+        capacity = k;
+        heap.clear();
+    }
+
+    // Permet d'éviter de construire la valeur quand elle serait rejetée
+    template <typename V>
+    bool Accepts(uint64_t score, const V& value) const {
+        if (heap.size() < capacity) {
+            return true;
+        }
+        if (capacity == 0) {
+            return false;
+        }
+        const Item& worst = heap.front();
+        return score > worst.first || (score == worst.first && value < worst.second);
+    }
+
+    void Push(uint64_t score, T value) {
+        if (!Accepts(score, value)) {
+            return;
+        }
+        if (heap.size() == capacity) {
+            std::pop_heap(heap.begin(), heap.end(), Better);
+            heap.pop_back();
+        }
+        heap.emplace_back(score, std::move(value));
+        std::push_heap(heap.begin(), heap.end(), Better);
+    }
+
+    void Merge(const BoundedTopK& other) {
+        for (const Item& item : other.heap) {
+            Push(item.first, item.second);
+        }
+    }
+
+    // Du meilleur au moins bon
+    std::vector<Item> Sorted() const {
+        std::vector<Item> items = heap;
+        std::sort(items.begin(), items.end(), Better);
+        return items;
+    }
+};
+
+// Totaux d'une application dans un groupe utilisateur ou GUID
+struct AggregateApplication {
+    std::wstring path;
+    uint64_t runs = 0;
+    uint64_t focusTime = 0;                     // ms
+};
+
+// Agrégat d'un groupe (utilisateur, application ou GUID)
+struct AggregateGroup {
+    std::wstring key;
+    uint64_t rows = 0;
+    uint64_t runs = 0;
+    uint64_t focusCount = 0;
+    uint64_t focusTime = 0;                     // ms
+    uint64_t firstExecution = UINT64_MAX;       // FILETIME, dates valides uniquement
+    uint64_t lastExecution = 0;
+    std::unordered_set<uint64_t> users;         // Hachages des utilisateurs (groupe application)
+    // Totaux par application, clé = hachage du chemin (groupes utilisateur et GUID) ; classés à la sortie
+    std::unordered_map<uint64_t, AggregateApplication> perApplication;
+
+    // Groupes utilisateur et GUID uniquement (0 pour un groupe application)
+    size_t DistinctApplications() const { return perApplication.size(); }
+    // Groupe application uniquement (0 pour un groupe utilisateur ou GUID)
+    size_t DistinctUsers() const { return users.size(); }
+
+    void AddApplication(uint64_t hash, std::wstring_view path, uint64_t appRuns, uint64_t appFocusTime) {
+        auto result = perApplication.try_emplace(hash);
+        AggregateApplication& application = result.first->second;
+        if (result.second) {
+            application.path = path;
+        }
+        application.runs += appRuns;
+        application.focusTime += appFocusTime;
+    }
+
+    void Merge(const AggregateGroup& other) {
+        rows += other.rows;
+        runs += other.runs;
+        focusCount += other.focusCount;
+        focusTime += other.focusTime;
+        firstExecution = std::min(firstExecution, other.firstExecution);
+        lastExecution = std::max(lastExecution, other.lastExecution);
+        users.insert(other.users.begin(), other.users.end());
+        for (const auto& pair : other.perApplication) {
+            AddApplication(pair.first, pair.second.path, pair.second.runs, pair.second.focusTime);
+        }
+    }
+};
+
+// Hachage FNV-1a 64 d'une chaîne (éléments distincts)
+inline uint64_t AggregateHash(std::wstring_view text) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (wchar_t ch : text) {
+        h ^= static_cast<uint32_t>(ch);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+class AggregateEngine {
+public:
+    using GroupMap = std::unordered_map<std::wstring, AggregateGroup>;
+
+private:
+    AggregateOptions options;
+    GroupMap users;
+    GroupMap applications;
+    GroupMap guids;
+    uint64_t rows = 0;
+
+    // Caches par ID du pool de chaînes (valables pour un seul Add) : une recherche par chaîne distincte
+    std::vector<AggregateGroup*> userCache;
+    std::vector<AggregateGroup*> applicationCache;
+    std::vector<AggregateGroup*> guidCache;
+    std::vector<uint64_t> hashCache;
+    std::vector<uint8_t> hashKnown;
+
+    AggregateGroup& Group(GroupMap& map, std::vector<AggregateGroup*>& cache, uint32_t id, std::wstring_view key) {
+        AggregateGroup*& group = cache[id];
+        if (!group) {
+            auto result = map.try_emplace(std::wstring(key));
+            group = &result.first->second;
+            if (result.second) {
+                group->key = result.first->first;
+            }
+        }
+        return *group;
+    }
+
+    uint64_t Hash(const EntryStore& store, uint32_t id) {
+        if (!hashKnown[id]) {
+            hashCache[id] = AggregateHash(store.strings.Get(id));
+            hashKnown[id] = 1;
+        }
+        return hashCache[id];
+    }
+
+    static void Accumulate(AggregateGroup& group, const EntryStore& store, size_t row) {
+        group.rows++;
+        group.runs += store.runCount[row];
+        group.focusCount += store.focusCount[row];
+        group.focusTime += store.focusTime[row];
+        uint64_t ft = store.lastExecution[row];
+        if (store.timeStatus[row] == UA_TIME_VALID && ft != 0) {
+            group.firstExecution = std::min(group.firstExecution, ft);
+            group.lastExecution = std::max(group.lastExecution, ft);
+        }
+    }
+
+    static std::vector<const AggregateGroup*> SortedByKey(const GroupMap& map) {
+        std::vector<const AggregateGroup*> result;
+        result.reserve(map.size());
+        for (const auto& pair : map) {
+            result.push_back(&pair.second);
+        }
+        std::sort(result.begin(), result.end(),
+                  [](const AggregateGroup* a, const AggregateGroup* b) { return a->key < b->key; });
+        return result;
+    }
+
+    static void MergeMap(GroupMap& target, const GroupMap& source) {
+        for (const auto& pair : source) {
+            auto result = target.try_emplace(pair.first);
+            if (result.second) {
+                result.first->second.key = pair.first;
+            }
+            result.first->second.Merge(pair.second);
+        }
+    }
+
+public:
+    explicit AggregateEngine(const AggregateOptions& opts = AggregateOptions()) : options(opts) {}
+
+    const AggregateOptions& Options() const { return options; }
+    uint64_t Rows() const { return rows; }
+
+    uint64_t Score(uint64_t runs, uint64_t focusTime) const {
+        return options.metric == UA_METRIC_FOCUS_TIME ? focusTime : runs;
+    }
+
+    // Agrège les lignes [first, last) d'un store
+    void Add(const EntryStore& store, size_t first, size_t last) {
+        size_t ids = store.strings.size();
+        userCache.assign(ids, nullptr);
+        applicationCache.assign(ids, nullptr);
+        guidCache.assign(ids, nullptr);
+        hashCache.assign(ids, 0);
+        hashKnown.assign(ids, 0);
+
+        for (size_t row = first; row < last; row++) {
+            uint32_t path = store.pathId[row];
+            uint32_t user = store.userId[row];
+            uint32_t guid = store.guidId[row];
+            std::wstring_view pathText = store.strings.Get(path);
+            uint64_t pathHash = Hash(store, path);
+
+            AggregateGroup& byUser = Group(users, userCache, user, store.strings.Get(user));
+            Accumulate(byUser, store, row);
+            byUser.AddApplication(pathHash, pathText, store.runCount[row], store.focusTime[row]);
+
+            AggregateGroup& byGuid = Group(guids, guidCache, guid, store.strings.Get(guid));
+            Accumulate(byGuid, store, row);
+            byGuid.AddApplication(pathHash, pathText, store.runCount[row], store.focusTime[row]);
+
+            AggregateGroup& byApplication = Group(applications, applicationCache, path, pathText);
+            Accumulate(byApplication, store, row);
+            byApplication.users.insert(Hash(store, user));
+        }
+        rows += last - first;
+    }
+
+    void Add(const EntryStore& store) { Add(store, 0, store.size()); }
+
+    void Merge(const AggregateEngine& other) {
+        MergeMap(users, other.users);
+        MergeMap(guids, other.guids);
+        MergeMap(applications, other.applications);
+        rows += other.rows;
+    }
+
+    void Clear() {
+        users.clear();
+        applications.clear();
+        guids.clear();
+        rows = 0;
+    }
+
+    size_t UserCount() const { return users.size(); }
+    size_t ApplicationCount() const { return applications.size(); }
+    size_t GuidCount() const { return guids.size(); }
+
+    std::vector<const AggregateGroup*> Users() const { return SortedByKey(users); }
+    std::vector<const AggregateGroup*> Guids() const { return SortedByKey(guids); }
+
+    // Top-K des applications d'un groupe utilisateur ou GUID, du meilleur au moins bon
+    std::vector<BoundedTopK<std::wstring_view>::Item> Top(const AggregateGroup& group) const {
+        BoundedTopK<std::wstring_view> top(options.topK);
+        for (const auto& pair : group.perApplication) {
+            top.Push(Score(pair.second.runs, pair.second.focusTime), pair.second.path);
+        }
+        return top.Sorted();
+    }
+
+    // Top-K global des applications (tous utilisateurs confondus) selon la métrique
+    std::vector<const AggregateGroup*> TopApplications() const {
+        BoundedTopK<std::wstring_view> top(options.topK);
+        for (const auto& pair : applications) {
+            top.Push(Score(pair.second.runs, pair.second.focusTime), pair.first);
+        }
+        std::vector<const AggregateGroup*> result;
+        for (const auto& item : top.Sorted()) {
+            result.push_back(&applications.find(std::wstring(item.second))->second);
+        }
+        return result;
+    }
+
+    uint64_t TotalFocusTime() const {
+        uint64_t total = 0;
+        for (const auto& pair : users) {
+            total += pair.second.focusTime;
+        }
+        return total;
+    }
+};
+
+// Agrège un store en parallèle : un moteur par shard de lignes, fusion en fin de passe
+inline void AggregateEntries(const EntryStore& store, AggregateEngine& result, ThreadPool& pool) {
+    constexpr size_t MIN_SHARD_ROWS = 16384;
+    size_t shards = std::max<size_t>(1, std::min(pool.size(), store.size() / MIN_SHARD_ROWS));
+    if (shards == 1) {
+        result.Add(store);
+        return;
+    }
+
+    std::vector<std::unique_ptr<AggregateEngine>> partial;
+    for (size_t s = 0; s < shards; s++) {
+        partial.push_back(std::make_unique<AggregateEngine>(result.Options()));
+    }
+    for (size_t s = 0; s < shards; s++) {
+        size_t first = store.size() * s / shards;
+        size_t last = store.size() * (s + 1) / shards;
+        AggregateEngine* engine = partial[s].get();
+        pool.Submit([engine, &store, first, last] { engine->Add(store, first, last); });
+    }
+    pool.Wait();
+
+    for (const auto& engine : partial) {
+        result.Merge(*engine);
+    }
+}
+
+// Rapport JSON (un document, terminé par un saut de ligne)
+inline void WriteAggregatesJson(JsonWriter& json, const AggregateEngine& engine) {
+    const AggregateOptions& options = engine.Options();
+
+    auto writeGroup = [&json](const AggregateGroup& group, std::string_view nameKey, std::string_view distinctKey,
+                              size_t distinct) {
+        json.BeginObject();
+        json.Key(nameKey);
+        json.String(std::wstring_view(group.key));
+        json.Key("entrees");
+        json.Number(group.rows);
+        json.Key("executions");
+        json.Number(group.runs);
+        json.Key("focus");
+        json.Number(group.focusCount);
+        json.Key("tempsFocusMs");
+        json.Number(group.focusTime);
+        json.Key(distinctKey);
+        json.Number(static_cast<uint64_t>(distinct));
+        json.Key("premiereExecution");
+        json.Time(group.firstExecution == UINT64_MAX ? 0 : group.firstExecution);
+        json.Key("derniereExecution");
+        json.Time(group.lastExecution);
+    };
+    auto writeTop = [&json, &engine](const AggregateGroup& group) {
+        json.Key("top");
+        json.BeginArray();
+        for (const auto& item : engine.Top(group)) {
+            json.BeginObject();
+            json.Key("application");
+            json.String(std::wstring_view(item.second));
+            json.Key("score");
+            json.Number(item.first);
+            json.EndObject();
+        }
+        json.EndArray();
+    };
+
+    json.BeginObject();
+    json.Key("entrees");
+    json.Number(engine.Rows());
+    json.Key("metrique");
+    json.String(std::string_view(options.metric == UA_METRIC_FOCUS_TIME ? "focustime" : "runs"));
+    json.Key("k");
+    json.Number(static_cast<uint64_t>(options.topK));
+    json.Key("applicationsDistinctes");
+    json.Number(static_cast<uint64_t>(engine.ApplicationCount()));
+    json.Key("tempsFocusTotalMs");
+    json.Number(engine.TotalFocusTime());
+
+    json.Key("utilisateurs");
+    json.BeginArray();
+    for (const AggregateGroup* group : engine.Users()) {
+        writeGroup(*group, "utilisateur", "applicationsDistinctes", group->DistinctApplications());
+        writeTop(*group);
+        json.EndObject();
+    }
+    json.EndArray();
+
+    json.Key("guids");
+    json.BeginArray();
+    for (const AggregateGroup* group : engine.Guids()) {
+        writeGroup(*group, "guid", "applicationsDistinctes", group->DistinctApplications());
+        writeTop(*group);
+        json.EndObject();
+    }
+    json.EndArray();
+
+    json.Key("topApplications");
+    json.BeginArray();
+    for (const AggregateGroup* group : engine.TopApplications()) {
+        writeGroup(*group, "application", "utilisateursDistincts", group->DistinctUsers());
+        json.EndObject();
+    }
+    json.EndArray();
+
+    json.EndObject();
+    json.EndDocument();
+}
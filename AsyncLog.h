@@ -0,0 +1,305 @@
+/*
+ * AsyncLog - journal asynchrone à file circulaire sans verrou
+ * Les producteurs (thread UI, workers) déposent un enregistrement de taille fixe dans un
+ * anneau borné multi-producteurs (séquences par case, un CAS par message) ; un thread
+ * d'écriture unique formate et écrit par lots, vidés toutes les FLUSH_INTERVAL, dès
+ * LOG_WAKE_BATCH messages en attente ou immédiatement pour une erreur.
+ *
+ * - Niveaux : DEBUG, INFO, ATTENTION, ERREUR (filtrés côté producteur, sans formatage)
+ * - Horodatage capturé en ms par le producteur, préfixe local formaté une fois par seconde
+ * - File pleine : le producteur cède la main jusqu'à libération d'une case (aucune perte)
+ * - Drain() attend l'écriture de tout ce qui a été déposé ; Close() vide la file puis arrête
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "ExportSink.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum LogLevel : uint8_t {
+    UA_LOG_DEBUG = 0,
+    UA_LOG_INFO = 1,
+    UA_LOG_WARNING = 2,
+    UA_LOG_ERROR = 3
+};
+
+constexpr size_t LOG_RING_SLOTS = 2048;         // Puissance de 2
+constexpr size_t LOG_MESSAGE_BYTES = 1000;      // Au-delà, message tronqué (frontière UTF-8)
+constexpr size_t LOG_WAKE_BATCH = 256;
+constexpr std::chrono::milliseconds LOG_FLUSH_INTERVAL(200);
+
+class AsyncLogger {
+    struct Slot {
+        std::atomic<size_t> sequence;
+        int64_t timeMs;
+        uint16_t length;
+        uint8_t level;
+        char text[LOG_MESSAGE_BYTES];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<size_t> head{0};    // Prochaine case à réserver (producteurs)
+    alignas(64) size_t tail = 0;                // Prochaine case à lire (thread d'écriture)
+    alignas(64) std::atomic<size_t> written{0}; // Messages écrits (pour Drain)
+
+    std::atomic<uint8_t> minLevel{UA_LOG_INFO};
+    std::atomic<bool> running{false};
+    std::atomic<bool> wakeRequested{false};
+    bool stopping = false;
+    bool timestamps = true;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::thread thread;
+
+    FileSink file;
+    Utf8Writer writer;
+
+    // Préfixe horodaté en cache (recalculé au changement de seconde)
+    int64_t cachedSecond = INT64_MIN;
+    char cachedPrefix[32] = {};
+    size_t cachedPrefixLength = 0;
+
+    static int64_t NowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static std::string_view LevelName(uint8_t level) {
+        switch (level) {
+        case UA_LOG_DEBUG: return "DEBUG";
+        case UA_LOG_INFO: return "INFO";
+        case UA_LOG_WARNING: return "ATTENTION";
+        default: return "ERREUR";
+        }
+    }
+
+    void RequestWake() {
+        wakeRequested.store(true, std::memory_order_release);
+        wake.notify_one();
+    }
+
+    // Réserve une case (attend si l'anneau est plein), renvoie sa position
+    bool Reserve(size_t& pos, Slot*& slot) {
+        pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            slot = &slots[pos & (LOG_RING_SLOTS - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Anneau plein : le thread d'écriture libère des cases
+                if (!running.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                RequestWake();
+                std::this_thread::yield();
+                pos = head.load(std::memory_order_relaxed);
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void Publish(size_t pos, Slot* slot, uint8_t level) {
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        if (level >= UA_LOG_ERROR || (pos + 1) % LOG_WAKE_BATCH == 0) {
+            RequestWake();
+        }
+    }
+
+    void AppendPrefix(int64_t timeMs) {
+        int64_t second = timeMs >= 0 ? timeMs / 1000 : (timeMs - 999) / 1000;
+        if (second != cachedSecond) {
+            std::time_t t = static_cast<std::time_t>(second);
+            std::tm local = {};
+#ifdef _WIN32
+            localtime_s(&local, &t);
+#else
+            localtime_r(&t, &local);
+#endif
+            int length = std::snprintf(cachedPrefix, sizeof(cachedPrefix), "[%02d/%02d/%04d %02d:%02d:%02d] ",
+                                       local.tm_mday, local.tm_mon + 1, local.tm_year + 1900,
+                                       local.tm_hour, local.tm_min, local.tm_sec);
+            cachedPrefixLength = length > 0 ? static_cast<size_t>(length) : 0;
+            cachedSecond = second;
+        }
+        writer.Append(cachedPrefix, cachedPrefixLength);
+    }
+
+    // Vide les cases publiées dans le buffer d'écriture ; renvoie le nombre de messages
+    size_t DrainRing() {
+        size_t count = 0;
+        while (true) {
+            Slot& slot = slots[tail & (LOG_RING_SLOTS - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                break;
+            }
+            if (timestamps) {
+                AppendPrefix(slot.timeMs);
+                writer.Append('[');
+                writer.Append(LevelName(slot.level));
+                writer.Append(std::string_view("] "));
+            }
+            writer.Append(slot.text, slot.length);
+#ifdef _WIN32
+            writer.Append('\r');
+#endif
+            writer.Append('\n');
+            writer.EndRecord();
+
+            slot.sequence.store(tail + LOG_RING_SLOTS, std::memory_order_release);
+            tail++;
+            count++;
+        }
+        return count;
+    }
+
+    void WriterLoop() {
+        while (true) {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(wakeLock);
+                wake.wait_for(lock, LOG_FLUSH_INTERVAL, [this] {
+                    return stopping || wakeRequested.load(std::memory_order_acquire);
+                });
+                wakeRequested.store(false, std::memory_order_relaxed);
+                stop = stopping;
+            }
+
+            size_t count = DrainRing();
+            if (count > 0) {
+                writer.Flush();
+                written.fetch_add(count, std::memory_order_release);
+                std::lock_guard<std::mutex> guard(wakeLock);
+                drained.notify_all();
+            }
+            // Arrêt : les producteurs ne réservent plus, la dernière passe a tout vidé
+            if (stop && tail == head.load(std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    bool Start() {
+        slots.reset(new Slot[LOG_RING_SLOTS]);
+        for (size_t i = 0; i < LOG_RING_SLOTS; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        head.store(0);
+        tail = 0;
+        written.store(0);
+        stopping = false;
+        writer.Attach(file);
+        running.store(true, std::memory_order_release);
+        thread = std::thread(&AsyncLogger::WriterLoop, this);
+        return true;
+    }
+
+public:
+    AsyncLogger() = default;
+    ~AsyncLogger() { Close(); }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Journal fichier (UTF-8, ajout en fin)
+    bool Open(const std::filesystem::path& path) {
+        Close();
+        timestamps = true;
+        return file.Open(path.c_str(), true) && Start();
+    }
+
+    // Sortie console : message brut (ni horodatage ni niveau)
+    bool OpenStderr() {
+        Close();
+        timestamps = false;
+        return file.OpenStderr() && Start();
+    }
+
+    bool is_open() const { return running.load(std::memory_order_acquire); }
+
+    void SetLevel(LogLevel level) { minLevel.store(level, std::memory_order_relaxed); }
+    bool Enabled(LogLevel level) const {
+        return level >= minLevel.load(std::memory_order_relaxed) && running.load(std::memory_order_relaxed);
+    }
+
+    // Message UTF-8
+    void Write(LogLevel level, std::string_view message) {
+        if (!Enabled(level)) {
+            return;
+        }
+        size_t pos;
+        Slot* slot;
+        if (!Reserve(pos, slot)) {
+            return;
+        }
+        size_t length = message.size();
+        if (length > LOG_MESSAGE_BYTES) {
+            length = LOG_MESSAGE_BYTES;
+            while (length > 0 && (static_cast<unsigned char>(message[length]) & 0xC0) == 0x80) {
+                length--;
+            }
+        }
+        std::memcpy(slot->text, message.data(), length);
+        slot->length = static_cast<uint16_t>(length);
+        slot->level = level;
+        slot->timeMs = NowMs();
+        Publish(pos, slot, level);
+    }
+
+    // Message UTF-16 : transcodé dans un buffer réutilisé par thread
+    void Write(LogLevel level, std::wstring_view message) {
+        if (!Enabled(level)) {
+            return;
+        }
+        static thread_local std::string utf8;
+        utf8.clear();
+        AppendUtf8(utf8, message.data(), message.size());
+        Write(level, std::string_view(utf8));
+    }
+
+    // Attend que tous les messages déjà déposés soient écrits
+    void Drain() {
+        if (!running.load(std::memory_order_acquire)) {
+            return;
+        }
+        size_t target = head.load(std::memory_order_acquire);
+        RequestWake();
+        std::unique_lock<std::mutex> lock(wakeLock);
+        drained.wait(lock, [this, target] { return written.load(std::memory_order_acquire) >= target; });
+    }
+
+    // Vide la file et arrête le thread d'écriture (messages ultérieurs ignorés)
+    void Close() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(wakeLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+        writer.Flush();
+        file.Close();
+    }
+};
@@ -0,0 +1,444 @@
+/*
+ * EntryStore - stockage colonnaire des entrées UserAssist
+ * Compteurs et FILETIME dans des tableaux contigus, chaînes internées (ID 32 bits)
+ * dans une arène : un GUID ou un nom d'utilisateur n'est stocké qu'une fois.
+ *
+ * Le nom encodé n'est pas conservé : ROT13 étant involutif, il est recalculé
+ * à la demande depuis le chemin décodé. De même, la date n'est conservée qu'en
+ * FILETIME brut et formatée (ISO-8601 UTC) uniquement pour les lignes affichées
+ * ou exportées. Un index trié sur le FILETIME, reconstruit paresseusement,
+ * répond aux requêtes "exécutions entre T1 et T2". Le dossier connu en tête du
+ * chemin ({GUID}\...) est identifié à l'ajout (un octet par ligne, KnownFolders.h).
+ *
+ * Non thread-safe : un seul écrivain, lectures après remplissage.
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "KnownFolders.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arène de chaînes : blocs jamais réalloués, les vues restent valides jusqu'à Clear()
+class StringArena {
+    static constexpr size_t BLOCK_CHARS = 64 * 1024;
+
+    std::vector<std::unique_ptr<wchar_t[]>> blocks;
+    std::vector<size_t> blockSizes;
+    size_t used;        // Caractères utilisés dans le bloc courant
+    size_t current;     // Index du bloc courant
+    size_t totalChars;
+
+public:
+    StringArena() : used(0), current(0), totalChars(0) {}
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    // Copie terminée par un zéro (utilisable directement comme LPCWSTR)
+    const wchar_t* Store(const wchar_t* text, size_t length) {
+        size_t needed = length + 1;
+        if (blocks.empty() || used + needed > blockSizes[current]) {
+            // Réutilise les blocs conservés par Clear() avant d'en allouer un nouveau
+            size_t next = blocks.empty() ? 0 : current + 1;
+            while (next < blocks.size() && blockSizes[next] < needed) {
+                next++;
+            }
+            if (next >= blocks.size()) {
+                size_t size = needed > BLOCK_CHARS ? needed : BLOCK_CHARS;
+                blocks.push_back(std::make_unique<wchar_t[]>(size));
+                blockSizes.push_back(size);
+                next = blocks.size() - 1;
+            }
+            current = next;
+            used = 0;
+        }
+
+        wchar_t* dest = blocks[current].get() + used;
+        if (length) {
+            std::memcpy(dest, text, length * sizeof(wchar_t));
+        }
+        dest[length] = L'\0';
+        used += needed;
+        totalChars += needed;
+        return dest;
+    }
+
+    // Conserve les blocs alloués pour le remplissage suivant
+    void Clear() {
+        used = 0;
+        current = 0;
+        totalChars = 0;
+    }
+
+    size_t MemoryUsage() const {
+        size_t bytes = 0;
+        for (size_t size : blockSizes) {
+            bytes += size * sizeof(wchar_t);
+        }
+        return bytes;
+    }
+
+    size_t StoredChars() const { return totalChars; }
+};
+
+// Table d'internement : chaîne ↔ ID 32 bits (adressage ouvert, sondage linéaire)
+class StringPool {
+    StringArena arena;
+    std::vector<std::wstring_view> strings;     // Par ID
+    std::vector<uint32_t> hashes;               // Par ID (évite de rehacher à l'agrandissement)
+    std::vector<uint32_t> slots;                // ID + 1, 0 = vide
+
+    static uint32_t Hash(const wchar_t* text, size_t length) {
+        uint64_t h = 0xcbf29ce484222325ull;     // FNV-1a 64 bits
+        for (size_t i = 0; i < length; i++) {
+            h ^= static_cast<uint32_t>(text[i]);
+            h *= 0x100000001b3ull;
+        }
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }
+
+    void Grow() {
+        size_t capacity = slots.empty() ? 1024 : slots.size() * 2;
+        slots.assign(capacity, 0);
+        size_t mask = capacity - 1;
+        for (uint32_t id = 0; id < strings.size(); id++) {
+            size_t slot = hashes[id] & mask;
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = id + 1;
+        }
+    }
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    uint32_t Intern(const wchar_t* text, size_t length) {
+        // Facteur de charge maximal 1/2
+        if ((strings.size() + 1) * 2 > slots.size()) {
+            Grow();
+        }
+
+        uint32_t h = Hash(text, length);
+        size_t mask = slots.size() - 1;
+        size_t slot = h & mask;
+        while (slots[slot] != 0) {
+            uint32_t id = slots[slot] - 1;
+            if (hashes[id] == h && strings[id].size() == length &&
+                (length == 0 || std::wmemcmp(strings[id].data(), text, length) == 0)) {
+                return id;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(arena.Store(text, length), length);
+        hashes.push_back(h);
+        slots[slot] = id + 1;
+        return id;
+    }
+
+    uint32_t Intern(std::wstring_view text) { return Intern(text.data(), text.size()); }
+
+    // Vue terminée par un zéro : Get(id).data() est utilisable comme LPCWSTR
+    std::wstring_view Get(uint32_t id) const {
+        return id < strings.size() ? strings[id] : std::wstring_view(L"", 0);
+    }
+
+    size_t size() const { return strings.size(); }
+
+    void Clear() {
+        arena.Clear();
+        strings.clear();
+        hashes.clear();
+        std::fill(slots.begin(), slots.end(), 0u);
+    }
+
+    size_t MemoryUsage() const {
+        return arena.MemoryUsage() + strings.capacity() * sizeof(std::wstring_view) +
+               hashes.capacity() * sizeof(uint32_t) + slots.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Entrées UserAssist en colonnes (structure-of-arrays)
+class EntryStore {
+public:
+    StringPool strings;
+
+    // Colonnes de chaînes (ID dans strings)
+    std::vector<uint32_t> pathId;
+    std::vector<uint32_t> guidId;
+    std::vector<uint32_t> userId;
+
+    // Colonnes numériques
+    std::vector<uint32_t> runCount;
+    std::vector<uint32_t> focusCount;
+    std::vector<uint32_t> focusTime;
+    std::vector<uint64_t> lastExecution;    // FILETIME brut
+    std::vector<uint8_t> timeStatus;        // UserAssistTimeStatus
+    std::vector<uint8_t> knownFolder;       // Dossier connu en tête du chemin (0 = aucun)
+
+    EntryStore() = default;
+    EntryStore(const EntryStore&) = delete;
+    EntryStore& operator=(const EntryStore&) = delete;
+
+    size_t size() const { return pathId.size(); }
+    bool empty() const { return pathId.empty(); }
+
+    void clear() {
+        strings.Clear();
+        pathId.clear();
+        guidId.clear();
+        userId.clear();
+        runCount.clear();
+        focusCount.clear();
+        focusTime.clear();
+        lastExecution.clear();
+        timeStatus.clear();
+        knownFolder.clear();
+        timeKeys.clear();
+        timeRows.clear();
+        timeIndexDirty = false;
+    }
+
+    void reserve(size_t rows) {
+        pathId.reserve(rows);
+        guidId.reserve(rows);
+        userId.reserve(rows);
+        runCount.reserve(rows);
+        focusCount.reserve(rows);
+        focusTime.reserve(rows);
+        lastExecution.reserve(rows);
+        timeStatus.reserve(rows);
+        knownFolder.reserve(rows);
+    }
+
+    // Ajout d'une ligne ; path est le chemin décodé, guid/user des ID déjà internés
+    size_t Append(std::wstring_view decodedPath, uint32_t guid, uint32_t user, const UserAssistCounters& counters) {
+        pathId.push_back(strings.Intern(decodedPath));
+        guidId.push_back(guid);
+        userId.push_back(user);
+        runCount.push_back(counters.runCount);
+        focusCount.push_back(counters.focusCount);
+        focusTime.push_back(counters.focusTime);
+        lastExecution.push_back(counters.lastExecution);
+        timeStatus.push_back(counters.status);
+        knownFolder.push_back(FindKnownFolder(decodedPath));
+        timeIndexDirty = true;
+        return size() - 1;
+    }
+
+    // Ajout d'un lot : chemins déjà internés, données Count décodées directement dans les colonnes
+    void Append(const std::vector<uint32_t>& paths, uint32_t guid, uint32_t user,
+                const std::vector<UserAssistBlob>& blobs) {
+        size_t start = size();
+        size_t count = paths.size() < blobs.size() ? paths.size() : blobs.size();
+        pathId.insert(pathId.end(), paths.begin(), paths.begin() + count);
+        guidId.insert(guidId.end(), count, guid);
+        userId.insert(userId.end(), count, user);
+        for (size_t i = 0; i < count; i++) {
+            knownFolder.push_back(FindKnownFolder(strings.Get(paths[i])));
+        }
+        runCount.resize(start + count);
+        focusCount.resize(start + count);
+        focusTime.resize(start + count);
+        lastExecution.resize(start + count);
+        timeStatus.resize(start + count);
+        UserAssistColumns columns = { runCount.data() + start, focusCount.data() + start, focusTime.data() + start,
+                                      lastExecution.data() + start, timeStatus.data() + start };
+        DecodeUserAssistBatch(blobs.data(), count, columns);
+        timeIndexDirty = true;
+    }
+
+    size_t Append(const UserAssistEntry& entry) {
+        UserAssistCounters counters;
+        counters.runCount = entry.runCount;
+        counters.focusCount = entry.focusCount;
+        counters.focusTime = entry.focusTime;
+        counters.lastExecution = entry.lastExecutionTime;
+        counters.status = entry.timeStatus;
+        return Append(entry.decodedPath, strings.Intern(entry.guid), strings.Intern(entry.username), counters);
+    }
+
+    // Ajout de toutes les lignes d'un autre store (fusion des résultats partiels d'un scan parallèle)
+    void Append(const EntryStore& other) {
+        std::vector<uint32_t> remap(other.strings.size(), UINT32_MAX);
+        auto id = [&](uint32_t otherId) {
+            uint32_t& mapped = remap[otherId];
+            if (mapped == UINT32_MAX) {
+                mapped = strings.Intern(other.strings.Get(otherId));
+            }
+            return mapped;
+        };
+        reserve(size() + other.size());
+        for (size_t row = 0; row < other.size(); row++) {
+            pathId.push_back(id(other.pathId[row]));
+            guidId.push_back(id(other.guidId[row]));
+            userId.push_back(id(other.userId[row]));
+        }
+        runCount.insert(runCount.end(), other.runCount.begin(), other.runCount.end());
+        focusCount.insert(focusCount.end(), other.focusCount.begin(), other.focusCount.end());
+        focusTime.insert(focusTime.end(), other.focusTime.begin(), other.focusTime.end());
+        lastExecution.insert(lastExecution.end(), other.lastExecution.begin(), other.lastExecution.end());
+        timeStatus.insert(timeStatus.end(), other.timeStatus.begin(), other.timeStatus.end());
+        knownFolder.insert(knownFolder.end(), other.knownFolder.begin(), other.knownFolder.end());
+        timeIndexDirty = true;
+    }
+
+    // Ajout des lignes choisies d'un autre store (résultat d'un filtre), dans l'ordre de rows
+    void Append(const EntryStore& other, const std::vector<uint32_t>& rows) {
+        std::vector<uint32_t> remap(other.strings.size(), UINT32_MAX);
+        auto id = [&](uint32_t otherId) {
+            uint32_t& mapped = remap[otherId];
+            if (mapped == UINT32_MAX) {
+                mapped = strings.Intern(other.strings.Get(otherId));
+            }
+            return mapped;
+        };
+        reserve(size() + rows.size());
+        for (uint32_t row : rows) {
+            pathId.push_back(id(other.pathId[row]));
+            guidId.push_back(id(other.guidId[row]));
+            userId.push_back(id(other.userId[row]));
+            runCount.push_back(other.runCount[row]);
+            focusCount.push_back(other.focusCount[row]);
+            focusTime.push_back(other.focusTime[row]);
+            lastExecution.push_back(other.lastExecution[row]);
+            timeStatus.push_back(other.timeStatus[row]);
+            knownFolder.push_back(other.knownFolder[row]);
+        }
+        timeIndexDirty = true;
+    }
+
+    std::wstring_view DecodedPath(size_t row) const { return strings.Get(pathId[row]); }
+    std::wstring_view Guid(size_t row) const { return strings.Get(guidId[row]); }
+    std::wstring_view Username(size_t row) const { return strings.Get(userId[row]); }
+
+    // Chemin avec le GUID de dossier connu remplacé par son emplacement (sans copie)
+    ResolvedPath Resolved(size_t row) const { return ResolveKnownFolder(DecodedPath(row), knownFolder[row]); }
+
+    // Chemin résolu dans un buffer réutilisable (affichage)
+    const std::wstring& ResolvedPathString(size_t row, std::wstring& buffer) const {
+        ResolvedPath resolved = Resolved(row);
+        buffer.assign(resolved.folder.data(), resolved.folder.size());
+        buffer.append(resolved.rest.data(), resolved.rest.size());
+        return buffer;
+    }
+
+    UserAssistCounters Counters(size_t row) const {
+        UserAssistCounters counters;
+        counters.runCount = runCount[row];
+        counters.focusCount = focusCount[row];
+        counters.focusTime = focusTime[row];
+        counters.lastExecution = lastExecution[row];
+        counters.status = timeStatus[row];
+        return counters;
+    }
+
+    // Texte "Dernière Exec" formaté à la demande (buffer de UA_TIME_TEXT_CHARS) ; renvoie la longueur
+    template <typename CharT>
+    size_t FormatLastExecution(size_t row, CharT* buffer) const {
+        return ::FormatLastExecution(timeStatus[row], lastExecution[row], buffer);
+    }
+
+    std::wstring LastExecutionString(size_t row) const {
+        return LastExecutionText(timeStatus[row], lastExecution[row]);
+    }
+
+    // Index temporel : lignes à date valide triées par FILETIME croissant
+    struct TimeRange {
+        const uint32_t* first;
+        const uint32_t* last;
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+    };
+
+    TimeRange Timeline() const {
+        BuildTimeIndex();
+        return TimeRange{ timeRows.data(), timeRows.data() + timeRows.size() };
+    }
+
+    // Lignes exécutées dans [from, to] (FILETIME), par date croissante
+    TimeRange ExecutedBetween(uint64_t from, uint64_t to) const {
+        BuildTimeIndex();
+        if (from > to) {
+            return TimeRange{ timeRows.data(), timeRows.data() };
+        }
+        size_t lo = std::lower_bound(timeKeys.begin(), timeKeys.end(), from) - timeKeys.begin();
+        size_t hi = std::upper_bound(timeKeys.begin() + lo, timeKeys.end(), to) - timeKeys.begin();
+        return TimeRange{ timeRows.data() + lo, timeRows.data() + hi };
+    }
+
+    // Nom de valeur d'origine (ROT13 du chemin décodé) dans un buffer réutilisable
+    const std::wstring& EncodedName(size_t row, std::wstring& buffer) const {
+        std::wstring_view path = DecodedPath(row);
+        buffer.assign(path.data(), path.size());
+        DecodeROT13InPlace(&buffer[0], buffer.size());
+        return buffer;
+    }
+
+    // Matérialisation d'une ligne (exports, compatibilité)
+    void GetEntry(size_t row, UserAssistEntry& entry) const {
+        std::wstring_view path = DecodedPath(row);
+        entry.decodedPath.assign(path.data(), path.size());
+        EncodedName(row, entry.application);
+        entry.runCount = runCount[row];
+        wchar_t text[UA_TIME_TEXT_CHARS];
+        entry.lastExecution.assign(text, FormatLastExecution(row, text));
+        entry.lastExecutionTime = lastExecution[row];
+        entry.timeStatus = timeStatus[row];
+        entry.focusCount = focusCount[row];
+        entry.focusTime = focusTime[row];
+        std::wstring_view guid = Guid(row);
+        entry.guid.assign(guid.data(), guid.size());
+        std::wstring_view user = Username(row);
+        entry.username.assign(user.data(), user.size());
+    }
+
+    size_t MemoryUsage() const {
+        return strings.MemoryUsage() +
+               (pathId.capacity() + guidId.capacity() + userId.capacity() + runCount.capacity() +
+                focusCount.capacity() + focusTime.capacity() + timeRows.capacity()) * sizeof(uint32_t) +
+               (lastExecution.capacity() + timeKeys.capacity()) * sizeof(uint64_t) + timeStatus.capacity() +
+               knownFolder.capacity();
+    }
+
+private:
+    // Index temporel (colonnes parallèles, clés contiguës pour la recherche dichotomique)
+    mutable std::vector<uint64_t> timeKeys;
+    mutable std::vector<uint32_t> timeRows;
+    mutable bool timeIndexDirty = false;
+
+    void BuildTimeIndex() const {
+        if (!timeIndexDirty) {
+            return;
+        }
+        timeRows.clear();
+        for (uint32_t row = 0; row < size(); row++) {
+            uint64_t ft = lastExecution[row];
+            if (timeStatus[row] == UA_TIME_VALID && ft != 0 && ft <= FILETIME_MAX_VALID) {
+                timeRows.push_back(row);
+            }
+        }
+        const uint64_t* keys = lastExecution.data();
+        std::stable_sort(timeRows.begin(), timeRows.end(),
+                         [keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        timeKeys.resize(timeRows.size());
+        for (size_t i = 0; i < timeRows.size(); i++) {
+            timeKeys[i] = keys[timeRows[i]];
+        }
+        timeIndexDirty = false;
+    }
+};
@@ -0,0 +1,154 @@
+/*
+ * EventStream - sortie en flux vers un consommateur lent (pipe, collecteur de logs) avec contre-pression
+ * Les workers déposent leurs blocs dans une file bornée ; un thread dédié les écrit sur la sortie.
+ * Quand la file est pleine, le worker attend qu'un bloc soit libéré : un consommateur lent ralentit
+ * le parsing au lieu de faire grossir la mémoire (budget fixe = nombre de blocs × taille d'un bloc).
+ *
+ * - Blocs alloués une fois à la construction, recyclés ensuite : aucune allocation en régime établi
+ * - Un appel à Write reste contigu dans la sortie (lignes jamais entremêlées entre workers)
+ * - Sortie en échec (consommateur fermé) : blocs rendus sans écriture, Write renvoie false
+ *
+ * Portable : ne dépend que de ByteSink (ExportSink.h).
+ */
+
+#pragma once
+
+#include "ExportSink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr size_t EVENT_STREAM_CHUNK_BYTES = 256 * 1024;
+constexpr uint64_t EVENT_STREAM_DEFAULT_BUDGET = 16ull << 20;
+
+class EventStream : public ByteSink {
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    ByteSink& target;
+    std::unique_ptr<char[]> storage;
+    std::vector<char*> available;       // Blocs libres
+    std::vector<Chunk> ring;            // Blocs pleins dans l'ordre d'écriture
+    size_t head = 0;
+    size_t queued = 0;
+
+    std::mutex lock;
+    std::condition_variable freed;
+    std::condition_variable filled;
+    std::mutex order;                   // Un Write à la fois : ses blocs se suivent dans la file
+    std::thread writer;
+    bool closing = false;
+    std::atomic<bool> failed{false};
+
+    uint64_t bytes = 0;
+    uint64_t chunks = 0;
+    uint64_t stalls = 0;                // Attentes d'un bloc libre (file pleine)
+    uint64_t stallNs = 0;
+    size_t peakQueued = 0;
+
+    void Drain() {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            filled.wait(guard, [&] { return queued > 0 || closing; });
+            if (queued == 0) {
+                return;
+            }
+            Chunk chunk = ring[head];
+            head = (head + 1) % ring.size();
+            queued--;
+            guard.unlock();
+
+            if (!failed.load(std::memory_order_relaxed) && !target.Write(chunk.data, chunk.size)) {
+                failed.store(true);
+            }
+
+            guard.lock();
+            bytes += chunk.size;
+            chunks++;
+            available.push_back(chunk.data);
+            freed.notify_one();
+        }
+    }
+
+public:
+    // budget : mémoire totale des blocs en attente (au moins deux blocs)
+    explicit EventStream(ByteSink& sink, uint64_t budget = EVENT_STREAM_DEFAULT_BUDGET) : target(sink) {
+        size_t count = static_cast<size_t>(std::max<uint64_t>(2, budget / EVENT_STREAM_CHUNK_BYTES));
+        storage.reset(new char[count * EVENT_STREAM_CHUNK_BYTES]);
+        available.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            available.push_back(storage.get() + i * EVENT_STREAM_CHUNK_BYTES);
+        }
+        ring.resize(count);
+        writer = std::thread([this] { Drain(); });
+    }
+
+    ~EventStream() { Close(); }
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    // Appelé par les workers : copie dans des blocs libres, bloquant tant que la file est pleine
+    bool Write(const char* data, size_t size) override {
+        std::lock_guard<std::mutex> sequence(order);
+        while (size > 0) {
+            std::unique_lock<std::mutex> guard(lock);
+            if (available.empty()) {
+                auto start = std::chrono::steady_clock::now();
+                freed.wait(guard, [&] { return !available.empty(); });
+                stalls++;
+                stallNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            char* block = available.back();
+            available.pop_back();
+            guard.unlock();
+
+            size_t length = std::min(size, EVENT_STREAM_CHUNK_BYTES);
+            std::memcpy(block, data, length);
+            data += length;
+            size -= length;
+
+            guard.lock();
+            ring[(head + queued) % ring.size()] = Chunk{ block, length };
+            queued++;
+            peakQueued = std::max(peakQueued, queued);
+            filled.notify_one();
+        }
+        return !failed.load(std::memory_order_relaxed);
+    }
+
+    // Écrit les blocs restants puis arrête le thread d'écriture ; false si la sortie a échoué
+    bool Close() {
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                closing = true;
+            }
+            filled.notify_one();
+            writer.join();
+        }
+        return ok();
+    }
+
+    bool ok() const { return !failed.load(); }
+
+    // Statistiques (après Close)
+    uint64_t BytesWritten() const { return bytes; }
+    uint64_t Chunks() const { return chunks; }
+    uint64_t Stalls() const { return stalls; }
+    double StallMs() const { return stallNs / 1e6; }
+    uint64_t PeakBytes() const { return static_cast<uint64_t>(peakQueued) * EVENT_STREAM_CHUNK_BYTES; }
+    uint64_t Budget() const { return static_cast<uint64_t>(ring.size()) * EVENT_STREAM_CHUNK_BYTES; }
+};
@@ -0,0 +1,624 @@
+/*
+ * ExportSink - pipeline d'export UTF-8 en flux, mémoire constante
+ * ByteSink (fichier, stdout, partagé entre threads) ← Utf8Writer (grand buffer réutilisé,
+ * transcodage wchar_t → UTF-8 direct) ← CsvWriter (échappement RFC 4180) / JsonWriter.
+ *
+ * Le buffer n'est vidé qu'en fin de ligne : une ligne n'est jamais coupée entre deux
+ * écritures, ce qui permet à plusieurs writers de partager une même sortie.
+ *
+ * Portable : Windows (CreateFile/WriteFile) et POSIX (open/write).
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Destination d'octets (écritures par gros blocs)
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+    virtual bool Write(const char* data, size_t size) = 0;
+};
+
+// RAII pour fichier de sortie (ou stdout/stderr, non fermés)
+class FileSink : public ByteSink {
+#ifdef _WIN32
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+    bool owned = false;
+
+public:
+    FileSink() = default;
+    ~FileSink() { Close(); }
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+#ifdef _WIN32
+    // append : écritures en fin de fichier existant (journaux)
+    bool Open(const wchar_t* path, bool append = false) {
+        Close();
+        hFile = CreateFileW(path, append ? FILE_APPEND_DATA : GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            append ? OPEN_ALWAYS : CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        owned = hFile != INVALID_HANDLE_VALUE;
+        return owned;
+    }
+
+    bool OpenStdout() {
+        Close();
+        hFile = GetStdHandle(STD_OUTPUT_HANDLE);
+        return hFile != INVALID_HANDLE_VALUE && hFile != nullptr;
+    }
+
+    bool OpenStderr() {
+        Close();
+        hFile = GetStdHandle(STD_ERROR_HANDLE);
+        return hFile != INVALID_HANDLE_VALUE && hFile != nullptr;
+    }
+
+    bool Write(const char* data, size_t size) override {
+        while (size > 0) {
+            DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+            DWORD written = 0;
+            if (!WriteFile(hFile, data, chunk, &written, nullptr) || written == 0) {
+                return false;
+            }
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    void Close() {
+        if (owned) {
+            CloseHandle(hFile);
+        }
+        hFile = INVALID_HANDLE_VALUE;
+        owned = false;
+    }
+#else
+    bool Open(const char* path, bool append = false) {
+        Close();
+        fd = ::open(path, O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+        owned = fd >= 0;
+        return owned;
+    }
+
+    bool OpenStdout() {
+        Close();
+        fd = STDOUT_FILENO;
+        return true;
+    }
+
+    bool OpenStderr() {
+        Close();
+        fd = STDERR_FILENO;
+        return true;
+    }
+
+    bool Write(const char* data, size_t size) override {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    void Close() {
+        if (owned) {
+            ::close(fd);
+        }
+        fd = -1;
+        owned = false;
+    }
+#endif
+};
+
+// Sortie partagée par plusieurs writers (un bloc = une suite de lignes complètes)
+class SharedSink : public ByteSink {
+    ByteSink& target;
+    std::mutex lock;
+    bool failed = false;
+
+public:
+    explicit SharedSink(ByteSink& sink) : target(sink) {}
+
+    bool Write(const char* data, size_t size) override {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!failed && !target.Write(data, size)) {
+            failed = true;
+        }
+        return !failed;
+    }
+
+    bool ok() {
+        std::lock_guard<std::mutex> guard(lock);
+        return !failed;
+    }
+};
+
+// Buffer UTF-8 réutilisable, vidé vers le sink par blocs de FLUSH_BYTES en fin de ligne
+class Utf8Writer {
+public:
+    static constexpr size_t FLUSH_BYTES = 1 << 20;
+
+private:
+    std::unique_ptr<char[]> buffer;
+    size_t capacity = 0;
+    size_t used = 0;
+    ByteSink* sink = nullptr;
+    uint64_t totalBytes = 0;
+    bool failed = false;
+
+    // Une ligne plus longue que le buffer l'agrandit (jamais de vidage en milieu de ligne)
+    void Grow(size_t needed) {
+        size_t size = capacity ? capacity : FLUSH_BYTES + 64 * 1024;
+        while (size < used + needed) {
+            size *= 2;
+        }
+        std::unique_ptr<char[]> grown(new char[size]);
+        if (used) {
+            std::memcpy(grown.get(), buffer.get(), used);
+        }
+        buffer = std::move(grown);
+        capacity = size;
+    }
+
+public:
+    Utf8Writer() = default;
+    explicit Utf8Writer(ByteSink& target) : sink(&target) {}
+
+    Utf8Writer(const Utf8Writer&) = delete;
+    Utf8Writer& operator=(const Utf8Writer&) = delete;
+
+    // Rattache le writer à une autre sortie (le buffer est conservé)
+    void Attach(ByteSink& target) {
+        Flush();
+        sink = &target;
+        failed = false;
+    }
+
+    // Réserve size octets et renvoie le pointeur d'écriture ; Commit(n) valide n octets
+    char* Reserve(size_t size) {
+        if (used + size > capacity) {
+            Grow(size);
+        }
+        return buffer.get() + used;
+    }
+
+    void Commit(size_t size) { used += size; }
+
+    void Append(char ch) {
+        *Reserve(1) = ch;
+        used++;
+    }
+
+    void Append(const char* data, size_t size) {
+        std::memcpy(Reserve(size), data, size);
+        used += size;
+    }
+
+    void Append(std::string_view text) { Append(text.data(), text.size()); }
+
+    void AppendUtf16(const wchar_t* text, size_t length) {
+        used += EncodeUtf8(text, length, Reserve(length * UTF8_MAX_PER_WCHAR));
+    }
+
+    void AppendUInt(uint64_t value) {
+        char digits[20];
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value);
+        char* p = Reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            p[i] = digits[count - 1 - i];
+        }
+        used += count;
+    }
+
+    // Fin de ligne : vidage si le seuil est atteint
+    void EndRecord() {
+        if (used >= FLUSH_BYTES) {
+            Flush();
+        }
+    }
+
+    bool Flush() {
+        if (used && sink && !failed) {
+            failed = !sink->Write(buffer.get(), used);
+            totalBytes += used;
+        }
+        used = 0;
+        return !failed;
+    }
+
+    bool ok() const { return !failed; }
+    uint64_t BytesWritten() const { return totalBytes; }
+};
+
+// Écriture CSV RFC 4180 : champs entre guillemets, '"' doublé, lignes terminées par CRLF
+class CsvWriter {
+    Utf8Writer& out;
+    bool firstField = true;
+
+    void Separator() {
+        if (!firstField) {
+            out.Append(',');
+        }
+        firstField = false;
+    }
+
+public:
+    explicit CsvWriter(Utf8Writer& writer) : out(writer) {}
+
+    Utf8Writer& writer() { return out; }
+
+    void Field(const wchar_t* text, size_t length) {
+        Separator();
+        char* p = out.Reserve(length * UTF8_MAX_PER_WCHAR + 2);   // '"' doublé : 2 octets, sous la borne
+        size_t size = 0;
+        p[size++] = '"';
+        size += EncodeUtf8<true>(text, length, p + size);
+        p[size++] = '"';
+        out.Commit(size);
+    }
+
+    void Field(std::wstring_view text) { Field(text.data(), text.size()); }
+
+    // Champ formé de deux morceaux contigus (chemin résolu : dossier + reste), sans concaténation
+    void Field(std::wstring_view head, std::wstring_view tail) {
+        Separator();
+        char* p = out.Reserve((head.size() + tail.size()) * UTF8_MAX_PER_WCHAR + 2);
+        size_t size = 0;
+        p[size++] = '"';
+        size += EncodeUtf8<true>(head.data(), head.size(), p + size);
+        size += EncodeUtf8<true>(tail.data(), tail.size(), p + size);
+        p[size++] = '"';
+        out.Commit(size);
+    }
+
+    // Texte déjà en UTF-8
+    void Field(const char* text, size_t length) {
+        Separator();
+        char* p = out.Reserve(length * 2 + 2);
+        size_t size = 0;
+        p[size++] = '"';
+        for (size_t i = 0; i < length; i++) {
+            p[size++] = text[i];
+            if (text[i] == '"') {
+                p[size++] = '"';
+            }
+        }
+        p[size++] = '"';
+        out.Commit(size);
+    }
+
+    void Field(std::string_view text) { Field(text.data(), text.size()); }
+
+    void Field(uint64_t value) {
+        Separator();
+        out.Append('"');
+        out.AppendUInt(value);
+        out.Append('"');
+    }
+
+    // Ligne d'en-tête ou texte brut déjà conforme
+    void RawRecord(std::string_view line) {
+        out.Append(line);
+        out.Append("\r\n", 2);
+        firstField = true;
+        out.EndRecord();
+    }
+
+    void EndRow() {
+        out.Append("\r\n", 2);
+        firstField = true;
+        out.EndRecord();
+    }
+};
+
+// Écriture JSON compacte (UTF-8, échappement RFC 8259), virgules gérées par niveau
+class JsonWriter {
+    Utf8Writer& out;
+    std::vector<bool> firstStack;
+    bool afterKey = false;
+
+    void Separator() {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        if (!firstStack.empty()) {
+            if (!firstStack.back()) {
+                out.Append(',');
+            }
+            firstStack.back() = false;
+        }
+    }
+
+    static char* EscapeAscii(char* p, uint32_t ch) {
+        static const char hex[] = "0123456789abcdef";
+        switch (ch) {
+        case '"': *p++ = '\\'; *p++ = '"'; break;
+        case '\\': *p++ = '\\'; *p++ = '\\'; break;
+        case '\n': *p++ = '\\'; *p++ = 'n'; break;
+        case '\r': *p++ = '\\'; *p++ = 'r'; break;
+        case '\t': *p++ = '\\'; *p++ = 't'; break;
+        default:
+            if (ch < 0x20) {
+                *p++ = '\\'; *p++ = 'u'; *p++ = '0'; *p++ = '0';
+                *p++ = hex[ch >> 4];
+                *p++ = hex[ch & 0xF];
+            } else {
+                *p++ = static_cast<char>(ch);
+            }
+        }
+        return p;
+    }
+
+    // ASCII échappé, le reste transcodé par plages
+    static char* EscapeWide(char* p, const wchar_t* text, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            uint32_t ch = static_cast<uint32_t>(text[i]);
+            if (ch < 0x80) {
+                p = EscapeAscii(p, ch);
+                continue;
+            }
+            size_t end = i;
+            while (end < length && static_cast<uint32_t>(text[end]) >= 0x80) {
+                end++;
+            }
+            p += EncodeUtf8(text + i, end - i, p);
+            i = end - 1;
+        }
+        return p;
+    }
+
+public:
+    explicit JsonWriter(Utf8Writer& writer) : out(writer) {}
+
+    Utf8Writer& writer() { return out; }
+
+    // Writer réutilisé (document interrompu par une exception) : niveaux oubliés, capacité conservée
+    void Reset() {
+        firstStack.clear();
+        afterKey = false;
+    }
+
+    void BeginObject() {
+        Separator();
+        out.Append('{');
+        firstStack.push_back(true);
+    }
+
+    void EndObject() {
+        firstStack.pop_back();
+        out.Append('}');
+    }
+
+    void BeginArray() {
+        Separator();
+        out.Append('[');
+        firstStack.push_back(true);
+    }
+
+    void EndArray() {
+        firstStack.pop_back();
+        out.Append(']');
+    }
+
+    void Key(std::string_view name) {
+        String(name);
+        out.Append(':');
+        afterKey = true;
+    }
+
+    // Texte wchar_t : ASCII échappé, le reste transcodé par plages
+    void String(const wchar_t* text, size_t length) {
+        Separator();
+        char* start = out.Reserve(length * 6 + 2);
+        char* p = start;
+        *p++ = '"';
+        p = EscapeWide(p, text, length);
+        *p++ = '"';
+        out.Commit(static_cast<size_t>(p - start));
+    }
+
+    void String(std::wstring_view text) { String(text.data(), text.size()); }
+
+    // Chaîne formée de deux morceaux contigus (chemin résolu : dossier + reste), sans concaténation
+    void String(std::wstring_view head, std::wstring_view tail) {
+        Separator();
+        char* start = out.Reserve((head.size() + tail.size()) * 6 + 2);
+        char* p = start;
+        *p++ = '"';
+        p = EscapeWide(p, head.data(), head.size());
+        p = EscapeWide(p, tail.data(), tail.size());
+        *p++ = '"';
+        out.Commit(static_cast<size_t>(p - start));
+    }
+
+    // Texte déjà en UTF-8
+    void String(std::string_view text) {
+        Separator();
+        char* start = out.Reserve(text.size() * 6 + 2);
+        char* p = start;
+        *p++ = '"';
+        for (char c : text) {
+            uint32_t ch = static_cast<unsigned char>(c);
+            p = ch < 0x80 ? EscapeAscii(p, ch) : (*p++ = c, p);
+        }
+        *p++ = '"';
+        out.Commit(static_cast<size_t>(p - start));
+    }
+
+    void Number(uint64_t value) {
+        Separator();
+        out.AppendUInt(value);
+    }
+
+    // Entier au-delà de 2^53 (FILETIME) : chaîne décimale, les parseurs JSON l'arrondiraient en double
+    void NumberString(uint64_t value) {
+        Separator();
+        out.Append('"');
+        out.AppendUInt(value);
+        out.Append('"');
+    }
+
+    void Number(int64_t value) {
+        Separator();
+        if (value < 0) {
+            out.Append('-');
+            out.AppendUInt(0 - static_cast<uint64_t>(value));
+        } else {
+            out.AppendUInt(static_cast<uint64_t>(value));
+        }
+    }
+
+    void Number(double value) {
+        Separator();
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), "%.6g", value);
+        out.Append(text, length > 0 ? static_cast<size_t>(length) : 0);
+    }
+
+    void Bool(bool value) {
+        Separator();
+        out.Append(value ? std::string_view("true") : std::string_view("false"));
+    }
+
+    void Null() {
+        Separator();
+        out.Append(std::string_view("null"));
+    }
+
+    // Horodatage ISO-8601 UTC, null si la date n'est pas exploitable
+    void Time(uint64_t fileTime) {
+        if (fileTime == 0 || fileTime > FILETIME_MAX_VALID) {
+            Null();
+            return;
+        }
+        char text[UA_TIME_TEXT_CHARS];
+        String(std::string_view(text, FormatFileTimeIso8601(fileTime, text)));
+    }
+
+    // Fin d'un document : saut de ligne (NDJSON) et vidage éventuel du buffer
+    void EndDocument() {
+        out.Append('\n');
+        out.EndRecord();
+    }
+};
+
+// Export UserAssist (même colonnes que l'export historique), UTF-8 échappé dans la source
+constexpr std::string_view USERASSIST_CSV_HEADER =
+    "Application,CheminD\xC3\xA9" "cod\xC3\xA9,CompteurEx\xC3\xA9" "c,Derni\xC3\xA8reEx\xC3\xA9" "c,"
+    "CompteurFocus,TempsFocus,GUID,Username,CheminR\xC3\xA9solu";
+
+constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+
+inline void WriteUserAssistCsvHeader(CsvWriter& csv, bool bom) {
+    if (bom) {
+        csv.writer().Append(UTF8_BOM);
+    }
+    csv.RawRecord(USERASSIST_CSV_HEADER);
+}
+
+// Une ligne depuis des vues (flux direct depuis le parseur, sans stockage intermédiaire) ;
+// knownFolder : identifiant FindKnownFolder du chemin décodé
+inline void WriteUserAssistCsvRow(CsvWriter& csv, std::wstring_view encodedName, std::wstring_view decodedPath,
+                                  const UserAssistCounters& counters, std::wstring_view guid,
+                                  std::wstring_view username, uint8_t knownFolder) {
+    char text[UA_TIME_TEXT_CHARS];
+    csv.Field(encodedName);
+    csv.Field(decodedPath);
+    csv.Field(counters.runCount);
+    csv.Field(text, FormatLastExecution(counters.status, counters.lastExecution, text));
+    csv.Field(counters.focusCount);
+    csv.Field(text, FormatDuration(counters.focusTime, text));
+    csv.Field(guid);
+    csv.Field(username);
+    ResolvedPath resolved = ResolveKnownFolder(decodedPath, knownFolder);
+    csv.Field(resolved.folder, resolved.rest);
+    csv.EndRow();
+}
+
+inline void WriteUserAssistCsvRow(CsvWriter& csv, const EntryStore& entries, size_t row, std::wstring& scratch) {
+    WriteUserAssistCsvRow(csv, entries.EncodedName(row, scratch), entries.DecodedPath(row), entries.Counters(row),
+                          entries.Guid(row), entries.Username(row), entries.knownFolder[row]);
+}
+
+// Événement NDJSON d'une entrée : un objet compact par ligne, écrit directement dans le buffer
+// du writer (aucune allocation par entrée). Date ISO-8601 (null si jamais ou illisible) et FILETIME brut.
+inline void WriteUserAssistJsonRow(JsonWriter& json, std::wstring_view encodedName, std::wstring_view decodedPath,
+                                   const UserAssistCounters& counters, std::wstring_view guid,
+                                   std::wstring_view username, uint8_t knownFolder, std::string_view source) {
+    json.BeginObject();
+    json.Key("source");
+    json.String(source);
+    json.Key("utilisateur");
+    json.String(username);
+    json.Key("guid");
+    json.String(guid);
+    json.Key("application");
+    json.String(encodedName);
+    json.Key("chemin");
+    json.String(decodedPath);
+    ResolvedPath resolved = ResolveKnownFolder(decodedPath, knownFolder);
+    json.Key("cheminResolu");
+    json.String(resolved.folder, resolved.rest);
+    json.Key("executions");
+    json.Number(static_cast<uint64_t>(counters.runCount));
+    json.Key("derniereExecution");
+    if (counters.status == UA_TIME_VALID) {
+        json.Time(counters.lastExecution);
+    } else {
+        json.Null();
+    }
+    json.Key("derniereExecutionFiletime");
+    json.NumberString(counters.lastExecution);
+    json.Key("focus");
+    json.Number(static_cast<uint64_t>(counters.focusCount));
+    json.Key("tempsFocusMs");
+    json.Number(static_cast<uint64_t>(counters.focusTime));
+    json.EndObject();
+    json.EndDocument();
+}
+
+inline void WriteUserAssistJsonRow(JsonWriter& json, const EntryStore& entries, size_t row, std::wstring& scratch,
+                                   std::string_view source) {
+    WriteUserAssistJsonRow(json, entries.EncodedName(row, scratch), entries.DecodedPath(row), entries.Counters(row),
+                           entries.Guid(row), entries.Username(row), entries.knownFolder[row], source);
+}
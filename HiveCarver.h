@@ -0,0 +1,396 @@
+/*
+ * HiveCarver - récupération des valeurs UserAssist supprimées par carving d'une image
+ * Cellules libres des hbins, espace après la dernière hbin, fragments de hive dans un vidage mémoire :
+ * tout ce que RegEnumValueW et le parcours de l'arborescence ne voient plus.
+ *
+ * - Recherche de signatures "vk" vectorisée (SSE2 / AVX2 choisis à l'exécution, comme Rot13.h) :
+ *   une comparaison 16 bits par bloc, seules les positions de cellule (4 mod 8) sont retenues
+ * - Validation : taille de cellule, longueur du nom, type REG_BINARY, taille de données XP (16) ou
+ *   Windows 7+ (72), nom imprimable ; hbin englobante retrouvée pour résoudre les données
+ * - Confiance : haute (nom de chemin + données plausibles), moyenne, faible
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+#include "KnownFolders.h"
+#include "PerfCounters.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+constexpr size_t CARVE_CHUNK_SIZE = 1 << 20;        // Signatures validées par tranche (données encore en cache)
+constexpr size_t CARVE_MAX_BIN_PAGES = 256;         // Recherche de la hbin englobante : 1 Mo en arrière
+constexpr uint32_t CARVE_MAX_CELL_SIZE = 0x10000;   // Un vk dépasse rarement quelques centaines d'octets
+constexpr uint16_t CARVE_VK_SIGNATURE = 0x6B76;     // "vk" lu en little-endian
+constexpr uint64_t CARVE_MIN_FILETIME = 125911584000000000ull;   // 2000-01-01
+constexpr uint64_t CARVE_MAX_FILETIME = 157469184000000000ull;   // 2100-01-01
+
+enum CarvedCellState : uint8_t {
+    CARVE_CELL_FREE = 0,        // Cellule libre d'une hbin : valeur supprimée
+    CARVE_CELL_ALLOCATED,       // Cellule allouée (valeur encore présente ou pas encore réutilisée)
+    CARVE_CELL_OUTSIDE          // Hors de toute hbin : fin de fichier, vidage mémoire
+};
+
+enum CarveConfidence : uint8_t {
+    CARVE_LOW = 0,
+    CARVE_MEDIUM,
+    CARVE_HIGH
+};
+
+constexpr const char* CARVE_CELL_NAMES[] = { "libre", "allou\xC3\xA9" "e", "hors hbin" };
+constexpr const char* CARVE_CONFIDENCE_NAMES[] = { "faible", "moyenne", "haute" };
+
+struct CarveOptions {
+    bool allocated = false;                 // Cellules allouées aussi (doublons du parcours normal)
+    CarveConfidence minimum = CARVE_LOW;
+};
+
+// Valeur récupérée ; les vues ne sont valides que pendant le callback
+struct CarvedValue {
+    uint64_t offset = 0;                    // Position de la signature vk dans l'image
+    uint8_t cell = CARVE_CELL_FREE;
+    uint8_t confidence = CARVE_LOW;
+    std::wstring_view encodedName;
+    std::wstring_view decodedPath;
+    UserAssistCounters counters;            // status UA_TIME_INVALID si les données sont perdues ou écrasées
+};
+
+inline uint32_t CarveTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+// Noyaux de recherche : positions p de [begin, end) avec p % 8 == 4 et "vk" en p (begin multiple de 32)
+inline void VkScanScalar(const uint8_t* data, size_t begin, size_t end, std::vector<size_t>& hits) {
+    for (size_t p = begin + 4; p + 1 < end; p += 8) {
+        if (data[p] == 'v' && data[p + 1] == 'k') {
+            hits.push_back(p);
+        }
+    }
+}
+
+#ifdef UA_ROT13_X86
+
+// Octet de poids faible de la voie 16 bits en position 4 mod 8 : bits 4, 12 du masque (et 20, 28 en AVX2)
+UA_TARGET_SSE2 inline void VkScanSse2(const uint8_t* data, size_t begin, size_t end, std::vector<size_t>& hits) {
+    const __m128i signature = _mm_set1_epi16(static_cast<short>(CARVE_VK_SIGNATURE));
+    size_t i = begin;
+    for (; i + 64 <= end; i += 64) {
+        // Quatre blocs par tour : un seul test pour le cas courant (aucune signature)
+        __m128i any = _mm_setzero_si128();
+        __m128i eq[4];
+        for (int b = 0; b < 4; b++) {
+            eq[b] = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + b * 16)), signature);
+            any = _mm_or_si128(any, eq[b]);
+        }
+        if ((_mm_movemask_epi8(any) & 0x1010) == 0) {
+            continue;
+        }
+        for (int b = 0; b < 4; b++) {
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq[b])) & 0x1010u;
+            while (mask) {
+                hits.push_back(i + b * 16 + CarveTrailingZeros(mask));
+                mask &= mask - 1;
+            }
+        }
+    }
+    VkScanScalar(data, i, end, hits);
+}
+
+UA_TARGET_AVX2 inline void VkScanAvx2(const uint8_t* data, size_t begin, size_t end, std::vector<size_t>& hits) {
+    const __m256i signature = _mm256_set1_epi16(static_cast<short>(CARVE_VK_SIGNATURE));
+    size_t i = begin;
+    for (; i + 128 <= end; i += 128) {
+        __m256i any = _mm256_setzero_si256();
+        __m256i eq[4];
+        for (int b = 0; b < 4; b++) {
+            eq[b] = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + b * 32)),
+                                       signature);
+            any = _mm256_or_si256(any, eq[b]);
+        }
+        if ((static_cast<uint32_t>(_mm256_movemask_epi8(any)) & 0x10101010u) == 0) {
+            continue;
+        }
+        for (int b = 0; b < 4; b++) {
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq[b])) & 0x10101010u;
+            while (mask) {
+                hits.push_back(i + b * 32 + CarveTrailingZeros(mask));
+                mask &= mask - 1;
+            }
+        }
+    }
+    VkScanSse2(data, i, end, hits);
+}
+
+#endif  // UA_ROT13_X86
+
+using VkScanKernel = void (*)(const uint8_t*, size_t, size_t, std::vector<size_t>&);
+
+inline VkScanKernel SelectVkScanKernel() {
+#ifdef UA_ROT13_X86
+    return CpuSupportsAvx2() ? &VkScanAvx2 : &VkScanSse2;
+#else
+    return &VkScanScalar;
+#endif
+}
+
+// Nom décodé : 2 = chemin, GUID de dossier connu, UNC, variable d'environnement ou UEME_* ;
+// 1 = identifiant plausible (AppUserModelID, nom de fichier) ; 0 = rejeté
+inline int CarvedNameScore(std::wstring_view name) {
+    if (name.size() >= 3 && name[1] == L':' && name[2] == L'\\' &&
+        ((name[0] >= L'A' && name[0] <= L'Z') || (name[0] >= L'a' && name[0] <= L'z'))) {
+        return 2;
+    }
+    if (name.size() >= 38 && name[0] == L'{' && name[37] == L'}' && name[9] == L'-') {
+        return 2;
+    }
+    if ((name.size() > 2 && name[0] == L'\\' && name[1] == L'\\') || name.rfind(L"UEME_", 0) == 0 ||
+        (name.size() > 2 && name[0] == L'%' && name.find(L'%', 1) != std::wstring_view::npos)) {
+        return 2;
+    }
+    bool letter = false, separator = false;
+    for (wchar_t ch : name) {
+        letter |= (ch >= L'A' && ch <= L'Z') || (ch >= L'a' && ch <= L'z');
+        separator |= ch == L'.' || ch == L'\\' || ch == L'!';
+    }
+    return letter && separator ? 1 : 0;
+}
+
+// Données cohérentes avec une valeur UserAssist (les cellules réutilisées donnent des valeurs aberrantes)
+inline bool CarvedDataPlausible(const uint8_t* data, UserAssistLayout layout, const UserAssistCounters& counters) {
+    if (counters.lastExecution != 0 &&
+        (counters.lastExecution < CARVE_MIN_FILETIME || counters.lastExecution >= CARVE_MAX_FILETIME)) {
+        return false;
+    }
+    if (layout == UA_LAYOUT_XP) {
+        return ReadLE32(data + UserAssistLayoutTraits<UA_LAYOUT_XP>::RUN_COUNT) >=
+               UserAssistLayoutTraits<UA_LAYOUT_XP>::RUN_COUNT_BASE;
+    }
+    UserAssistDetails details;
+    UserAssistLayoutTraits<UA_LAYOUT_WIN7>::DecodeDetails(data, details);
+    if (details.ratioIndex != 0xFFFFFFFF && details.ratioIndex >= UA_FOCUS_RATIO_COUNT) {
+        return false;
+    }
+    for (float ratio : details.focusRatios) {
+        if (!(ratio == -1.0f || (ratio >= 0.0f && ratio <= 1.0f))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class HiveCarver {
+    const uint8_t* image;
+    size_t size;
+    CarveOptions options;
+    bool regfFile;
+
+    // hbin englobante de la dernière cellule validée (les signatures arrivent dans l'ordre)
+    size_t binStart = 0;
+    size_t binEnd = 0;
+    size_t binBase = 0;     // Position de la première hbin : origine des offsets de cellules
+
+    std::wstring encoded;
+    std::wstring decoded;
+
+    // En-tête hbin couvrant cell, en remontant page par page ; false si hors de toute hbin
+    bool FindBin(size_t cell) {
+        if (cell >= binStart && cell < binEnd) {
+            return true;
+        }
+        size_t page = cell & ~size_t(0xFFF);
+        for (size_t i = 0; i < CARVE_MAX_BIN_PAGES; i++) {
+            if (page + 0x20 <= size && std::memcmp(image + page, "hbin", 4) == 0) {
+                uint32_t offset = ReadLE32(image + page + 4);
+                uint32_t length = ReadLE32(image + page + 8);
+                if (length >= 0x1000 && (length & 0xFFF) == 0 && (offset & 0xFFF) == 0 && offset <= page &&
+                    cell >= page + 0x20 && cell < page + length) {
+                    binStart = page;
+                    binEnd = page + length;
+                    binBase = page - offset;
+                    return true;
+                }
+                return false;   // hbin précédente plus courte : la cellule est dans l'espace libre qui suit
+            }
+            if (page == 0) {
+                break;
+            }
+            page -= 0x1000;
+        }
+        return false;
+    }
+
+    bool Validate(size_t p, CarvedValue& value) {
+        size_t cell = p - 4;
+        if (p + 0x14 > size) {
+            return false;
+        }
+        int32_t rawCell = static_cast<int32_t>(ReadLE32(image + cell));
+        uint32_t cellSize = rawCell < 0 ? 0u - static_cast<uint32_t>(rawCell) : static_cast<uint32_t>(rawCell);
+        uint32_t nameBytes = ReadLE16(image + p + 2);
+        uint32_t dataSize = ReadLE32(image + p + 4);
+        uint32_t type = ReadLE32(image + p + 0x0C);
+        bool compressed = (ReadLE16(image + p + 0x10) & HIVE_VALUE_COMP_NAME) != 0;
+
+        // En-tête de cellule et champs fixes
+        if ((cellSize & 7) != 0 || cellSize > CARVE_MAX_CELL_SIZE || nameBytes == 0 ||
+            4 + 0x14 + nameBytes > cellSize || cell + cellSize > size) {
+            return false;
+        }
+        UserAssistLayout layout = UserAssistLayoutFor(dataSize, type);
+        if (layout != UA_LAYOUT_XP && layout != UA_LAYOUT_WIN7) {
+            return false;   // Les données inline (bit 31) ont une taille > 72 : rejetées ici aussi
+        }
+        if (layout == UA_LAYOUT_WIN7 && dataSize != UserAssistLayoutTraits<UA_LAYOUT_WIN7>::SIZE) {
+            return false;
+        }
+        if (!compressed && (nameBytes & 1)) {
+            return false;
+        }
+
+        bool inBin = FindBin(cell);
+        value.cell = !inBin ? CARVE_CELL_OUTSIDE : rawCell < 0 ? CARVE_CELL_ALLOCATED : CARVE_CELL_FREE;
+        if (value.cell == CARVE_CELL_ALLOCATED && !options.allocated) {
+            return false;
+        }
+
+        // Nom : imprimable, puis ROT13
+        const uint8_t* name = image + p + 0x14;
+        encoded.clear();
+        if (compressed) {
+            AppendLatin1(encoded, name, nameBytes);
+        } else {
+            AppendUtf16LE(encoded, name, nameBytes);
+        }
+        for (wchar_t ch : encoded) {
+            uint32_t c = static_cast<uint32_t>(ch);
+            if (c < 0x20 || c == 0x7F || (c >= 0xD800 && c <= 0xDFFF) || c == 0xFFFE || c == 0xFFFF) {
+                return false;
+            }
+        }
+        decoded.resize(encoded.size());
+        DecodeROT13Buffer(encoded.data(), &decoded[0], encoded.size());
+        int nameScore = CarvedNameScore(decoded);
+        if (nameScore == 0) {
+            return false;
+        }
+
+        // Données : cellule résolue depuis la hbin englobante (ou la première hbin d'un fichier regf)
+        bool plausible = false;
+        value.counters = UserAssistCounters();
+        value.counters.layout = layout;
+        uint32_t dataOffset = ReadLE32(image + p + 8);
+        bool baseKnown = inBin || regfFile;
+        size_t base = inBin ? binBase : HIVE_BASE_BLOCK_SIZE;
+        if (baseKnown && (dataOffset & 7) == 0 && base + static_cast<uint64_t>(dataOffset) + 4 + dataSize <= size) {
+            const uint8_t* dataCell = image + base + dataOffset;
+            int32_t rawData = static_cast<int32_t>(ReadLE32(dataCell));
+            uint32_t dataCellSize = rawData < 0 ? 0u - static_cast<uint32_t>(rawData) : static_cast<uint32_t>(rawData);
+            if (dataCellSize >= dataSize + 4 && dataCellSize <= CARVE_MAX_CELL_SIZE) {
+                UserAssistCounters counters;
+                UA_LAYOUT_DECODERS[layout](dataCell + 4, counters);
+                plausible = CarvedDataPlausible(dataCell + 4, layout, counters);
+                if (plausible) {
+                    value.counters = counters;
+                }
+            }
+        }
+
+        value.confidence = nameScore == 2 ? (plausible ? CARVE_HIGH : CARVE_MEDIUM)
+                                          : (plausible ? CARVE_MEDIUM : CARVE_LOW);
+        if (value.confidence < options.minimum) {
+            return false;
+        }
+        value.offset = p;
+        value.encodedName = encoded;
+        value.decodedPath = decoded;
+        return true;
+    }
+
+public:
+    HiveCarver(const uint8_t* data, size_t dataSize, const CarveOptions& opts = CarveOptions())
+        : image(data), size(dataSize), options(opts),
+          regfFile(dataSize >= HIVE_BASE_BLOCK_SIZE && std::memcmp(data, "regf", 4) == 0) {}
+
+    // callback(const CarvedValue&) → false pour arrêter ; renvoie le nombre de valeurs récupérées
+    template <typename F>
+    size_t Carve(F&& callback, PerfTally& perf) {
+        static const VkScanKernel kernel = SelectVkScanKernel();
+        std::vector<size_t> hits;
+        CarvedValue value;
+        size_t recovered = 0;
+        perf.Count(PERF_BYTES_READ, size);
+        for (size_t chunk = 0; chunk < size; chunk += CARVE_CHUNK_SIZE) {
+            size_t end = size - chunk > CARVE_CHUNK_SIZE ? chunk + CARVE_CHUNK_SIZE : size;
+            hits.clear();
+            kernel(image, chunk, end, hits);
+            perf.Lap(PERF_ENUMERATE);
+            for (size_t p : hits) {
+                if (!Validate(p, value)) {
+                    continue;
+                }
+                perf.Count(PERF_VALUES);
+                recovered++;
+                if (!callback(static_cast<const CarvedValue&>(value))) {
+                    perf.Lap(PERF_DECODE);
+                    return recovered;
+                }
+            }
+            perf.Lap(PERF_DECODE);
+        }
+        return recovered;
+    }
+
+    template <typename F>
+    size_t Carve(F&& callback) {
+        PerfTally off(false);
+        return Carve(std::forward<F>(callback), off);
+    }
+};
+
+// Export CSV des valeurs récupérées : position et confiance en tête, colonnes UserAssist ensuite
+constexpr std::string_view CARVED_CSV_HEADER =
+    "Source,Position,Cellule,Confiance,Format,Application,CheminD\xC3\xA9" "cod\xC3\xA9,"
+    "CompteurEx\xC3\xA9" "c,Derni\xC3\xA8reEx\xC3\xA9" "c,CompteurFocus,TempsFocus,Session,CheminR\xC3\xA9solu";
+
+inline void WriteCarvedCsvHeader(CsvWriter& csv, bool bom) {
+    if (bom) {
+        csv.writer().Append(UTF8_BOM);
+    }
+    csv.RawRecord(CARVED_CSV_HEADER);
+}
+
+inline void WriteCarvedCsvRow(CsvWriter& csv, std::wstring_view source, const CarvedValue& value) {
+    char text[UA_TIME_TEXT_CHARS];
+    const UserAssistCounters& counters = value.counters;
+    csv.Field(source);
+    int length = std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(value.offset));
+    csv.Field(text, length > 0 ? static_cast<size_t>(length) : 0);
+    csv.Field(std::string_view(CARVE_CELL_NAMES[value.cell]));
+    csv.Field(std::string_view(CARVE_CONFIDENCE_NAMES[value.confidence]));
+    csv.Field(std::string_view(UA_LAYOUT_NAMES[counters.layout]));
+    csv.Field(value.encodedName);
+    csv.Field(value.decodedPath);
+    csv.Field(counters.runCount);
+    csv.Field(text, FormatLastExecution(counters.status, counters.lastExecution, text));
+    csv.Field(counters.focusCount);
+    csv.Field(text, FormatDuration(counters.focusTime, text));
+    csv.Field(counters.session);
+    ResolvedPath resolved = ResolveKnownFolder(value.decodedPath, FindKnownFolder(value.decodedPath));
+    csv.Field(resolved.folder, resolved.rest);
+    csv.EndRow();
+}
@@ -0,0 +1,404 @@
+/*
+ * HiveGenerator - générateur déterministe de hives NTUSER.DAT et de valeurs UserAssist synthétiques
+ * Pour les benchmarks et les essais de volume : même graine = mêmes octets, sur toute plateforme
+ * (générateur splitmix64 maison, pas de distributions de la bibliothèque standard).
+ *
+ * - Données au format réel : Windows 7+ (72 octets : compteur @4, focus @8, temps de focus
+ *   @0xC, FILETIME @0x3C) et XP/Vista (16 octets : session @0, compteur + 5 @4, FILETIME @8)
+ * - Noms : chemins ROT13 courts ou longs (> MAX_PATH), Unicode (noms UTF-16 non compressés)
+ * - Corruption : données tronquées, type inattendu, taille déclarée hors de la cellule
+ * - Suppressions : valeurs retirées de la liste, vk et données laissés en cellules libres (carving)
+ * - Hive : base block "regf" + hbins de 4 Ko (cellules jamais à cheval), listes lf
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Générateur pseudo-aléatoire portable (splitmix64)
+class SyntheticRng {
+    uint64_t state;
+
+public:
+    explicit SyntheticRng(uint64_t seed) : state(seed) {}
+
+    uint64_t Next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Entier dans [0, bound)
+    uint32_t Below(uint32_t bound) {
+        return bound ? static_cast<uint32_t>(((Next() >> 32) * bound) >> 32) : 0;
+    }
+
+    bool Percent(uint32_t percent) { return Below(100) < percent; }
+};
+
+struct SyntheticHiveOptions {
+    uint64_t seed = 1;
+    size_t valuesPerGuid = 1000;
+    bool legacyGuids = true;        // Ajoute un GUID XP/Vista (données 16 octets)
+    uint32_t unicodePercent = 10;   // Noms avec caractères hors Latin-1
+    uint32_t longPathPercent = 5;   // Chemins > 260 caractères
+    uint32_t corruptPercent = 2;    // Valeurs corrompues (ignorées ou "Données invalides")
+    uint32_t deletedPercent = 0;    // Valeurs supprimées (cellules libérées, hors de la liste de valeurs)
+};
+
+struct SyntheticValue {
+    std::wstring path;              // Chemin décodé (le nom de valeur est son ROT13)
+    std::vector<uint8_t> data;
+    uint32_t type = UA_REG_BINARY;
+    bool corrupt = false;
+};
+
+struct SyntheticHiveStats {
+    size_t values = 0;
+    size_t corrupt = 0;
+    size_t legacy = 0;
+    size_t deleted = 0;
+    size_t bytes = 0;
+};
+
+constexpr const wchar_t* GUID_LEGACY_XP = L"{75048700-EF1F-11D0-9888-006097DEACF9}";
+
+inline void PutSyntheticLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void PutSyntheticLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+// Windows 7+ : 72 octets, ratios r0..r9 à -1.0f comme sur un profil réel
+inline std::vector<uint8_t> MakeWin7UserAssistData(uint32_t runCount, uint32_t focusCount, uint32_t focusTime,
+                                                   uint64_t lastExecution) {
+    std::vector<uint8_t> data(72, 0);
+    PutSyntheticLE32(&data[0x04], runCount);
+    PutSyntheticLE32(&data[0x08], focusCount);
+    PutSyntheticLE32(&data[0x0C], focusTime);
+    for (size_t offset = 0x10; offset < 0x38; offset += 4) {
+        PutSyntheticLE32(&data[offset], 0xBF800000);
+    }
+    PutSyntheticLE32(&data[0x38], 0xFFFFFFFF);
+    PutSyntheticLE64(&data[0x3C], lastExecution);
+    return data;
+}
+
+// XP/Vista : 16 octets, le compteur stocké commence à 5
+inline std::vector<uint8_t> MakeXpUserAssistData(uint32_t session, uint32_t runCount, uint64_t lastExecution) {
+    std::vector<uint8_t> data(16, 0);
+    PutSyntheticLE32(&data[0], session);
+    PutSyntheticLE32(&data[4], runCount + 5);
+    PutSyntheticLE64(&data[8], lastExecution);
+    return data;
+}
+
+// Chemin plausible : dossier connu, sous-dossiers, exécutable ; Unicode et longueur à la demande
+inline std::wstring MakeSyntheticPath(SyntheticRng& rng, bool unicode, bool longPath) {
+    static const wchar_t* const roots[] = {
+        L"C:\\Program Files\\", L"C:\\Program Files (x86)\\", L"C:\\Windows\\System32\\",
+        L"C:\\Users\\Public\\Downloads\\", L"{6D809377-6AF0-444B-8957-A3773F02200E}\\",
+        L"{7C5A40EF-A0FB-4BFC-874A-C0F2E0B9FA8E}\\", L"Microsoft.Windows.Explorer", L"UEME_CTLSESSION",
+    };
+    static const wchar_t* const words[] = {
+        L"Microsoft", L"Office", L"Outils", L"Sysinternals", L"Adobe", L"Mozilla", L"Réseau",
+        L"Données", L"Client", L"Agent", L"Update", L"Temp", L"Scripts", L"Installateur",
+    };
+    static const wchar_t* const unicodeWords[] = {
+        L"Программы", L"工具", L"データ", L"Ελληνικά", L"مجلد", L"\U0001F4C1dossier",
+    };
+    static const wchar_t* const extensions[] = { L".exe", L".lnk", L".bat", L".msc", L".cpl" };
+
+    std::wstring path = roots[rng.Below(sizeof(roots) / sizeof(roots[0]))];
+    if (path.back() != L'\\') {
+        return path;    // Entrées spéciales (AppID, UEME_*)
+    }
+    size_t depth = 1 + rng.Below(3);
+    size_t target = longPath ? 300 + rng.Below(200) : 0;
+    for (size_t i = 0; i < depth || path.size() < target; i++) {
+        if (unicode && rng.Percent(50)) {
+            path += unicodeWords[rng.Below(sizeof(unicodeWords) / sizeof(unicodeWords[0]))];
+        } else {
+            path += words[rng.Below(sizeof(words) / sizeof(words[0]))];
+        }
+        path += std::to_wstring(rng.Below(100));
+        path += L'\\';
+    }
+    path += words[rng.Below(sizeof(words) / sizeof(words[0]))];
+    path += extensions[rng.Below(sizeof(extensions) / sizeof(extensions[0]))];
+    return path;
+}
+
+// Valeurs UserAssist brutes d'un GUID (legacy : format XP/Vista)
+inline std::vector<SyntheticValue> GenerateUserAssistValues(SyntheticRng& rng, const SyntheticHiveOptions& options,
+                                                            bool legacy) {
+    std::vector<SyntheticValue> values(options.valuesPerGuid);
+    std::unordered_set<std::wstring> seen;          // Noms de valeur uniques dans une clé
+    uint64_t baseTime = 132000000000000000ull;      // 2019
+    for (auto& value : values) {
+        value.path = MakeSyntheticPath(rng, rng.Percent(options.unicodePercent),
+                                       rng.Percent(options.longPathPercent));
+        if (!seen.insert(value.path).second) {
+            value.path += L'~' + std::to_wstring(seen.size());
+            seen.insert(value.path);
+        }
+        uint64_t ft = rng.Percent(5) ? 0 : baseTime + (rng.Next() % (5ull * 365 * 86400)) * FILETIME_TICKS_PER_SECOND;
+        if (legacy) {
+            value.data = MakeXpUserAssistData(1 + rng.Below(50), rng.Below(500), ft);
+        } else {
+            value.data = MakeWin7UserAssistData(rng.Below(2000), rng.Below(500), rng.Below(36000000), ft);
+        }
+
+        if (rng.Percent(options.corruptPercent)) {
+            value.corrupt = true;
+            switch (rng.Below(3)) {
+            case 0: value.data.resize(rng.Below(8)); break;     // Tronquée
+            case 1: value.type = 1; break;                      // REG_SZ au lieu de REG_BINARY
+            default: break;                                     // Taille hors cellule (voir RegfBuilder)
+            }
+        }
+    }
+    return values;
+}
+
+// Construction d'une hive regf en mémoire (offsets de cellules relatifs à la première hbin)
+class RegfBuilder {
+    static constexpr uint32_t HBIN_SIZE = 0x1000;
+    static constexpr uint32_t HBIN_HEADER = 0x20;
+
+    std::vector<uint8_t> bins;
+    uint32_t binStart = 0;      // Offset de la hbin courante
+    uint32_t binEnd = 0;
+
+    void CloseBin() {
+        if (binEnd == 0) {
+            return;
+        }
+        uint32_t used = static_cast<uint32_t>(bins.size());
+        if (used < binEnd) {
+            // Reste de la hbin : cellule libre (taille positive)
+            PutSyntheticLE32(&bins[used], binEnd - used);
+            bins.resize(binEnd, 0);
+        }
+    }
+
+    void OpenBin(uint32_t minimum) {
+        CloseBin();
+        uint32_t size = (minimum + HBIN_HEADER + HBIN_SIZE - 1) / HBIN_SIZE * HBIN_SIZE;
+        binStart = static_cast<uint32_t>(bins.size());
+        binEnd = binStart + size;
+        bins.resize(binStart + HBIN_HEADER, 0);
+        std::memcpy(&bins[binStart], "hbin", 4);
+        PutSyntheticLE32(&bins[binStart + 4], binStart);
+        PutSyntheticLE32(&bins[binStart + 8], size);
+    }
+
+public:
+    // Cellule allouée (taille négative, alignée sur 8) ; renvoie son offset
+    uint32_t Alloc(const uint8_t* payload, size_t length) {
+        uint32_t size = static_cast<uint32_t>((length + 4 + 7) & ~size_t(7));
+        if (binEnd == 0 || bins.size() + size > binEnd) {
+            OpenBin(size);
+        }
+        uint32_t offset = static_cast<uint32_t>(bins.size());
+        bins.resize(offset + size, 0);
+        PutSyntheticLE32(&bins[offset], static_cast<uint32_t>(-static_cast<int32_t>(size)));
+        if (length) {
+            std::memcpy(&bins[offset + 4], payload, length);
+        }
+        return offset;
+    }
+
+    uint32_t Alloc(const std::vector<uint8_t>& payload) { return Alloc(payload.data(), payload.size()); }
+
+    // Libération : taille redevenue positive, contenu laissé en place comme le fait le gestionnaire de configuration
+    void Free(uint32_t offset) {
+        uint32_t size = 0u - ReadLE32(&bins[offset]);
+        PutSyntheticLE32(&bins[offset], size);
+    }
+
+    // Suppression d'une valeur : vk et cellule de données libérées
+    void FreeValue(uint32_t vkOffset) {
+        if (!(ReadLE32(&bins[vkOffset + 4 + 0x04]) & 0x80000000u)) {
+            Free(ReadLE32(&bins[vkOffset + 4 + 0x08]));
+        }
+        Free(vkOffset);
+    }
+
+    // Nom compressé (Latin-1) si possible, sinon UTF-16LE
+    static std::vector<uint8_t> EncodeName(const std::wstring& name, bool& compressed) {
+        compressed = true;
+        for (wchar_t ch : name) {
+            if (static_cast<uint32_t>(ch) > 0xFF) {
+                compressed = false;
+            }
+        }
+        std::vector<uint8_t> bytes;
+        for (wchar_t ch : name) {
+            uint32_t c = static_cast<uint32_t>(ch);
+            if (compressed) {
+                bytes.push_back(static_cast<uint8_t>(c));
+                continue;
+            }
+            if (c > 0xFFFF) {
+                // wchar_t 32 bits (Linux) : paire de substitution
+                c -= 0x10000;
+                uint32_t high = 0xD800 + (c >> 10), low = 0xDC00 + (c & 0x3FF);
+                bytes.push_back(static_cast<uint8_t>(high)); bytes.push_back(static_cast<uint8_t>(high >> 8));
+                bytes.push_back(static_cast<uint8_t>(low)); bytes.push_back(static_cast<uint8_t>(low >> 8));
+            } else {
+                bytes.push_back(static_cast<uint8_t>(c)); bytes.push_back(static_cast<uint8_t>(c >> 8));
+            }
+        }
+        return bytes;
+    }
+
+    // declaredSize = 0 : taille réelle ; sinon taille mentée (corruption)
+    uint32_t AddValue(const std::wstring& name, const std::vector<uint8_t>& data, uint32_t type,
+                      uint32_t declaredSize = 0) {
+        bool compressed;
+        std::vector<uint8_t> nameBytes = EncodeName(name, compressed);
+        std::vector<uint8_t> vk(0x14 + nameBytes.size(), 0);
+        vk[0] = 'v';
+        vk[1] = 'k';
+        vk[2] = static_cast<uint8_t>(nameBytes.size());
+        vk[3] = static_cast<uint8_t>(nameBytes.size() >> 8);
+        uint32_t size = declaredSize ? declaredSize : static_cast<uint32_t>(data.size());
+        if (data.size() <= 4 && !declaredSize) {
+            PutSyntheticLE32(&vk[0x04], size | 0x80000000u);
+            std::memcpy(&vk[0x08], data.data(), data.size());
+        } else {
+            PutSyntheticLE32(&vk[0x04], size);
+            PutSyntheticLE32(&vk[0x08], Alloc(data));
+        }
+        PutSyntheticLE32(&vk[0x0C], type);
+        vk[0x10] = compressed ? 1 : 0;
+        std::memcpy(&vk[0x14], nameBytes.data(), nameBytes.size());
+        return Alloc(vk);
+    }
+
+    uint32_t AddKey(const std::wstring& name, const std::vector<uint32_t>& subkeys,
+                    const std::vector<uint32_t>& values) {
+        uint32_t subkeyList = 0xFFFFFFFF;
+        if (!subkeys.empty()) {
+            std::vector<uint8_t> lf(4 + subkeys.size() * 8, 0);
+            lf[0] = 'l';
+            lf[1] = 'f';
+            lf[2] = static_cast<uint8_t>(subkeys.size());
+            lf[3] = static_cast<uint8_t>(subkeys.size() >> 8);
+            for (size_t i = 0; i < subkeys.size(); i++) {
+                PutSyntheticLE32(&lf[4 + i * 8], subkeys[i]);
+            }
+            subkeyList = Alloc(lf);
+        }
+        uint32_t valueList = 0xFFFFFFFF;
+        if (!values.empty()) {
+            std::vector<uint8_t> list(values.size() * 4);
+            for (size_t i = 0; i < values.size(); i++) {
+                PutSyntheticLE32(&list[i * 4], values[i]);
+            }
+            valueList = Alloc(list);
+        }
+
+        bool compressed;
+        std::vector<uint8_t> nameBytes = EncodeName(name, compressed);
+        std::vector<uint8_t> nk(0x4C + nameBytes.size(), 0);
+        nk[0] = 'n';
+        nk[1] = 'k';
+        nk[2] = compressed ? 0x20 : 0;
+        PutSyntheticLE32(&nk[0x14], static_cast<uint32_t>(subkeys.size()));
+        PutSyntheticLE32(&nk[0x1C], subkeyList);
+        PutSyntheticLE32(&nk[0x20], 0xFFFFFFFF);
+        PutSyntheticLE32(&nk[0x24], static_cast<uint32_t>(values.size()));
+        PutSyntheticLE32(&nk[0x28], valueList);
+        PutSyntheticLE32(&nk[0x2C], 0xFFFFFFFF);
+        PutSyntheticLE32(&nk[0x30], 0xFFFFFFFF);
+        nk[0x48] = static_cast<uint8_t>(nameBytes.size());
+        nk[0x49] = static_cast<uint8_t>(nameBytes.size() >> 8);
+        std::memcpy(&nk[0x4C], nameBytes.data(), nameBytes.size());
+        return Alloc(nk);
+    }
+
+    // Base block + hbins ; root = offset de la clé racine
+    std::vector<uint8_t> Finish(uint32_t root) {
+        CloseBin();
+        std::vector<uint8_t> hive(0x1000 + bins.size(), 0);
+        std::memcpy(&hive[0], "regf", 4);
+        PutSyntheticLE32(&hive[0x04], 1);       // Séquences primaire/secondaire identiques
+        PutSyntheticLE32(&hive[0x08], 1);
+        PutSyntheticLE32(&hive[0x14], 1);       // Version 1.5
+        PutSyntheticLE32(&hive[0x18], 5);
+        PutSyntheticLE32(&hive[0x20], 1);
+        PutSyntheticLE32(&hive[0x24], root);
+        PutSyntheticLE32(&hive[0x28], static_cast<uint32_t>(bins.size()));
+        PutSyntheticLE32(&hive[0x2C], 1);
+        uint32_t checksum = 0;
+        for (size_t offset = 0; offset < 0x1FC; offset += 4) {
+            checksum ^= ReadLE32(&hive[offset]);
+        }
+        PutSyntheticLE32(&hive[0x1FC], checksum);
+        std::memcpy(&hive[0x1000], bins.data(), bins.size());
+        return hive;
+    }
+};
+
+// Hive NTUSER.DAT complète : Software\...\UserAssist\{GUID}\Count pour chaque GUID
+inline std::vector<uint8_t> GenerateSyntheticHive(const SyntheticHiveOptions& options,
+                                                  SyntheticHiveStats* stats = nullptr) {
+    SyntheticRng rng(options.seed);
+    RegfBuilder builder;
+    SyntheticHiveStats local;
+
+    std::vector<const wchar_t*> guids = { GUID_EXECUTABLE, GUID_SHORTCUT };
+    if (options.legacyGuids) {
+        guids.push_back(GUID_LEGACY_XP);
+    }
+
+    std::vector<uint32_t> guidKeys;
+    for (const wchar_t* guid : guids) {
+        bool legacy = guid == GUID_LEGACY_XP;
+        std::vector<uint32_t> valueCells;
+        for (const SyntheticValue& value : GenerateUserAssistValues(rng, options, legacy)) {
+            std::wstring name = value.path;
+            DecodeROT13InPlace(&name[0], name.size());
+            uint32_t declared = value.corrupt && value.type == UA_REG_BINARY && value.data.size() >= 16
+                                    ? static_cast<uint32_t>(value.data.size()) + 4096 : 0;
+            uint32_t cell = builder.AddValue(name, value.data, value.type, declared);
+            // Tirage seulement si demandé : les hives générées sans suppression restent identiques
+            if (options.deletedPercent && !value.corrupt && rng.Percent(options.deletedPercent)) {
+                builder.FreeValue(cell);
+                local.deleted++;
+                continue;
+            }
+            valueCells.push_back(cell);
+            local.values++;
+            local.corrupt += value.corrupt;
+            local.legacy += legacy;
+        }
+        uint32_t count = builder.AddKey(L"Count", {}, valueCells);
+        guidKeys.push_back(builder.AddKey(guid, { count }, {}));
+    }
+
+    uint32_t key = builder.AddKey(L"UserAssist", guidKeys, {});
+    for (const wchar_t* name : { L"Explorer", L"CurrentVersion", L"Windows", L"Microsoft", L"Software" }) {
+        key = builder.AddKey(name, { key }, {});
+    }
+    uint32_t root = builder.AddKey(L"ROOT", { key }, {});
+
+    std::vector<uint8_t> hive = builder.Finish(root);
+    local.bytes = hive.size();
+    if (stats) {
+        *stats = local;
+    }
+    return hive;
+}
@@ -0,0 +1,362 @@
+/*
+ * HiveIncremental - relecture incrémentale d'une hive NTUSER.DAT en surveillance continue
+ * L'état de la passe précédente (numéros de séquence du base block, hbins lues par chaque clé Count
+ * et leur hachage) évite de reparcourir une hive qui n'a pas changé :
+ * - séquences, date d'écriture et taille identiques : hive ignorée, seul le base block est lu
+ * - sinon le chemin UserAssist est relu (quelques cellules), puis seules les clés Count dont une hbin
+ *   a changé (nk, liste de valeurs, vk, données) ou dont la cellule a été déplacée sont relues
+ * Coût en régime établi proportionnel aux changements, pas à la taille de la hive.
+ *
+ * Disposition de l'état (little-endian) :
+ *   "UAIN" | version u16 | réservé u16 | séquence primaire u32 | secondaire u32 | date d'écriture u64 |
+ *   taille du fichier u64 | racine u32 | nb hbins u32 | nb GUID u32 | réservé u32
+ *   hbins : offset u32, taille u32, hachage u64
+ *   GUID : clé Count u32 | unités UTF-16 du nom u32 | nb hbins u32 | nb clés u32 |
+ *          nom UTF-16LE | indices de hbins u32[] | clés d'instantané u64[] (triées)
+ *   FNV-1a u32 de tout ce qui précède
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+#include "PerfCounters.h"
+#include "ResultCache.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+constexpr uint32_t INCREMENTAL_MAGIC = 0x4E494155;     // "UAIN"
+constexpr uint16_t INCREMENTAL_VERSION = 1;
+constexpr size_t INCREMENTAL_HEADER_SIZE = 48;
+
+struct HiveBinHash {
+    uint32_t offset = 0;        // Relatif à la première hbin
+    uint32_t size = 0;
+    uint64_t hash = 0;
+};
+
+struct IncrementalGuid {
+    std::wstring name;
+    uint32_t count = HIVE_NO_CELL;      // Cellule nk de la clé Count
+    std::vector<uint32_t> bins;         // Indices dans HiveIncrementalState::bins
+    std::vector<uint64_t> keys;         // Clés d'instantané de ses entrées (triées)
+    bool reparsed = false;              // Relue pendant cette passe (non persistant)
+};
+
+class HiveIncrementalState {
+public:
+    uint32_t sequence1 = 0;
+    uint32_t sequence2 = 0;
+    uint64_t lastWritten = 0;
+    uint64_t fileSize = 0;
+    uint32_t root = HIVE_NO_CELL;
+    std::vector<HiveBinHash> bins;
+    std::vector<IncrementalGuid> guids;
+
+    void ReadHeader(const HiveReader& hive, uint64_t size) {
+        const uint8_t* base = hive.BaseBlock();
+        sequence1 = ReadLE32(base + 0x04);
+        sequence2 = ReadLE32(base + 0x08);
+        lastWritten = ReadLE64(base + 0x0C);
+        root = ReadLE32(base + 0x24);
+        fileSize = size;
+    }
+
+    // Séquences égales entre elles (hive propre) et identiques à la passe précédente
+    bool SameHeader(const HiveIncrementalState& other) const {
+        return sequence1 == sequence2 && sequence1 == other.sequence1 && sequence2 == other.sequence2 &&
+               lastWritten == other.lastWritten && fileSize == other.fileSize && root == other.root;
+    }
+
+    const IncrementalGuid* Find(std::wstring_view name) const {
+        for (const auto& guid : guids) {
+            if (guid.name == name) {
+                return &guid;
+            }
+        }
+        return nullptr;
+    }
+
+    // Indice de la hbin (ajoutée si absente)
+    uint32_t AddBin(const HiveBinHash& bin) {
+        for (size_t i = 0; i < bins.size(); i++) {
+            if (bins[i].offset == bin.offset) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        bins.push_back(bin);
+        return static_cast<uint32_t>(bins.size() - 1);
+    }
+
+    bool Load(const std::filesystem::path& path, std::string& error) {
+        *this = HiveIncrementalState();
+        MappedFile file;
+        if (!file.Open(path.c_str())) {
+            error = "ouverture impossible";
+            return false;
+        }
+        const uint8_t* data = file.data();
+        size_t size = file.size();
+        if (size < INCREMENTAL_HEADER_SIZE + 4 || ReadLE32(data) != INCREMENTAL_MAGIC ||
+            ReadLE16(data + 4) != INCREMENTAL_VERSION) {
+            error = "format d'état incrémental invalide";
+            return false;
+        }
+        if (Fnv1a32(data, size - 4) != ReadLE32(data + size - 4)) {
+            error = "somme de contrôle invalide";
+            return false;
+        }
+        size_t end = size - 4;
+        sequence1 = ReadLE32(data + 8);
+        sequence2 = ReadLE32(data + 12);
+        lastWritten = ReadLE64(data + 16);
+        fileSize = ReadLE64(data + 24);
+        root = ReadLE32(data + 32);
+        uint64_t binCount = ReadLE32(data + 36);
+        uint64_t guidCount = ReadLE32(data + 40);
+
+        size_t pos = INCREMENTAL_HEADER_SIZE;
+        if (binCount > (end - pos) / 16) {
+            error = "état tronqué";
+            return false;
+        }
+        bins.resize(static_cast<size_t>(binCount));
+        for (auto& bin : bins) {
+            bin.offset = ReadLE32(data + pos);
+            bin.size = ReadLE32(data + pos + 4);
+            bin.hash = ReadLE64(data + pos + 8);
+            pos += 16;
+        }
+        for (uint64_t g = 0; g < guidCount; g++) {
+            if (end - pos < 16) {
+                error = "état tronqué";
+                return false;
+            }
+            IncrementalGuid guid;
+            guid.count = ReadLE32(data + pos);
+            uint64_t units = ReadLE32(data + pos + 4);
+            uint64_t binRefs = ReadLE32(data + pos + 8);
+            uint64_t keys = ReadLE32(data + pos + 12);
+            pos += 16;
+            if (units * 2 + binRefs * 4 + keys * 8 > end - pos) {
+                error = "état tronqué";
+                return false;
+            }
+            AppendUtf16LE(guid.name, data + pos, static_cast<size_t>(units * 2));
+            pos += static_cast<size_t>(units * 2);
+            for (uint64_t i = 0; i < binRefs; i++, pos += 4) {
+                uint32_t index = ReadLE32(data + pos);
+                if (index >= bins.size()) {
+                    error = "indice de hbin invalide";
+                    return false;
+                }
+                guid.bins.push_back(index);
+            }
+            for (uint64_t i = 0; i < keys; i++, pos += 8) {
+                guid.keys.push_back(ReadLE64(data + pos));
+            }
+            guids.push_back(std::move(guid));
+        }
+        return true;
+    }
+
+    // Fichier temporaire puis renommage, comme les instantanés
+    bool Save(const std::filesystem::path& path) const {
+        std::string bytes;
+        auto put = [&bytes](uint64_t v, int width) {
+            for (int i = 0; i < width; i++) bytes.push_back(static_cast<char>(v >> (8 * i)));
+        };
+        put(INCREMENTAL_MAGIC, 4);
+        put(INCREMENTAL_VERSION, 2);
+        put(0, 2);
+        put(sequence1, 4);
+        put(sequence2, 4);
+        put(lastWritten, 8);
+        put(fileSize, 8);
+        put(root, 4);
+        put(bins.size(), 4);
+        put(guids.size(), 4);
+        put(0, 4);
+        for (const auto& bin : bins) {
+            put(bin.offset, 4);
+            put(bin.size, 4);
+            put(bin.hash, 8);
+        }
+        for (const auto& guid : guids) {
+            put(guid.count, 4);
+            put(guid.name.size(), 4);
+            put(guid.bins.size(), 4);
+            put(guid.keys.size(), 4);
+            for (wchar_t ch : guid.name) {
+                put(static_cast<uint16_t>(ch), 2);
+            }
+            for (uint32_t index : guid.bins) {
+                put(index, 4);
+            }
+            for (uint64_t key : guid.keys) {
+                put(key, 8);
+            }
+        }
+        put(Fnv1a32(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()), 4);
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            FileSink file;
+            if (!file.Open(temp.c_str()) || !file.Write(bytes.data(), bytes.size())) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+};
+
+struct IncrementalPass {
+    bool skipped = false;               // Base block inchangé : hive non relue
+    size_t guids = 0;                   // Clés Count présentes
+    size_t reparsed = 0;                // Clés Count relues
+    uint64_t bytesRead = 0;             // Base block, hbins hachées
+    std::vector<uint64_t> staleKeys;    // Clés d'instantané des GUID relus ou disparus (triées)
+};
+
+// Compare la hive à previous (nullptr : première passe, tout est relu) et construit next.
+// store ne reçoit que les entrées des clés Count relues ; AssignIncrementalKeys complète next ensuite.
+inline IncrementalPass ParseUserAssistIncremental(const HiveReader& hive, uint64_t fileSize,
+                                                  const HiveIncrementalState* previous, HiveIncrementalState& next,
+                                                  const wchar_t* username, EntryStore& store, PerfTally& perf) {
+    IncrementalPass pass;
+    next = HiveIncrementalState();
+    next.ReadHeader(hive, fileSize);
+    pass.bytesRead = HIVE_BASE_BLOCK_SIZE;
+    if (previous && next.SameHeader(*previous)) {
+        pass.skipped = true;
+        pass.guids = previous->guids.size();
+        next = *previous;
+        perf.Lap(PERF_ENUMERATE);
+        return pass;
+    }
+
+    // Hachage d'une hbin, une seule fois par passe ; false si l'en-tête ne correspond plus
+    std::vector<HiveBinHash> hashed;
+    auto hashBin = [&](uint32_t offset, uint32_t size, HiveBinHash& out) {
+        for (const auto& bin : hashed) {
+            if (bin.offset == offset) {
+                out = bin;
+                return bin.size == size;
+            }
+        }
+        const uint8_t* data = hive.Bin(offset, size);
+        if (!data) {
+            return false;
+        }
+        out.offset = offset;
+        out.size = size;
+        out.hash = HashContent(data, size);
+        hashed.push_back(out);
+        pass.bytesRead += size;
+        return true;
+    };
+
+    std::vector<UserAssistCountKey> current = ListUserAssistCountKeys(hive);
+    perf.Lap(PERF_ENUMERATE);
+    pass.guids = current.size();
+    std::vector<uint32_t> cells;
+
+    for (const auto& key : current) {
+        IncrementalGuid guid;
+        guid.name = key.guid;
+        guid.count = key.count;
+
+        const IncrementalGuid* old = previous ? previous->Find(key.guid) : nullptr;
+        bool unchanged = old && old->count == key.count;
+        std::vector<HiveBinHash> kept;
+        for (size_t i = 0; unchanged && i < old->bins.size(); i++) {
+            const HiveBinHash& bin = previous->bins[old->bins[i]];
+            HiveBinHash now;
+            unchanged = hashBin(bin.offset, bin.size, now) && now.hash == bin.hash;
+            kept.push_back(now);
+        }
+        perf.Lap(PERF_ENUMERATE);
+
+        if (unchanged) {
+            for (const auto& bin : kept) {
+                guid.bins.push_back(next.AddBin(bin));
+            }
+            guid.keys = old->keys;
+        } else {
+            if (old) {
+                pass.staleKeys.insert(pass.staleKeys.end(), old->keys.begin(), old->keys.end());
+            }
+            // Cellules lues par le parcours de la clé Count : leurs hbins forment l'empreinte de la clé
+            cells.clear();
+            hive.TraceCells(&cells);
+            ParseUserAssistCount(hive, key.count, key.guid.c_str(), username, store, perf);
+            hive.TraceCells(nullptr);
+            for (uint32_t cell : cells) {
+                uint32_t offset, size;
+                HiveBinHash bin;
+                if (hive.FindBin(cell, offset, size) && hashBin(offset, size, bin)) {
+                    uint32_t index = next.AddBin(bin);
+                    if (std::find(guid.bins.begin(), guid.bins.end(), index) == guid.bins.end()) {
+                        guid.bins.push_back(index);
+                    }
+                }
+            }
+            guid.reparsed = true;
+            pass.reparsed++;
+            perf.Lap(PERF_ENUMERATE);
+        }
+        next.guids.push_back(std::move(guid));
+    }
+
+    // GUID disparus depuis la passe précédente
+    if (previous) {
+        for (const auto& old : previous->guids) {
+            if (!next.Find(old.name)) {
+                pass.staleKeys.insert(pass.staleKeys.end(), old.keys.begin(), old.keys.end());
+            }
+        }
+    }
+    std::sort(pass.staleKeys.begin(), pass.staleKeys.end());
+    return pass;
+}
+
+// Clés d'instantané des GUID relus, d'après les entrées retenues (après filtre éventuel)
+inline void AssignIncrementalKeys(HiveIncrementalState& state, const EntryStore& entries) {
+    for (auto& guid : state.guids) {
+        if (guid.reparsed) {
+            guid.keys.clear();
+        }
+    }
+    for (size_t row = 0; row < entries.size(); row++) {
+        std::wstring_view name = entries.Guid(row);
+        for (auto& guid : state.guids) {
+            if (guid.reparsed && guid.name == name) {
+                guid.keys.push_back(SnapshotKey(entries.Username(row), name, entries.DecodedPath(row)));
+                break;
+            }
+        }
+    }
+    for (auto& guid : state.guids) {
+        if (guid.reparsed) {
+            std::sort(guid.keys.begin(), guid.keys.end());
+            guid.keys.erase(std::unique(guid.keys.begin(), guid.keys.end()), guid.keys.end());
+        }
+    }
+}
@@ -0,0 +1,619 @@
+/*
+ * HiveReader - lecteur de hives registre offline (format regf)
+ * Mappe NTUSER.DAT en mémoire et parcourt base block, hbins et cellules nk/vk/lf/lh/li/ri
+ * sans copie : noms et données sont renvoyés comme vues dans le mapping.
+ *
+ * Portable : Windows (CreateFileMapping) et POSIX (mmap).
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constantes du format regf
+constexpr uint32_t HIVE_BASE_BLOCK_SIZE = 0x1000;
+constexpr uint32_t HIVE_NO_CELL = 0xFFFFFFFF;
+constexpr uint16_t HIVE_KEY_COMP_NAME = 0x0020;
+constexpr uint16_t HIVE_VALUE_COMP_NAME = 0x0001;
+constexpr uint32_t HIVE_DATA_INLINE = 0x80000000;
+constexpr uint32_t HIVE_MAX_LIST_DEPTH = 4;
+
+// RAII pour fichier mappé en lecture seule
+class MappedFile {
+    const uint8_t* view;
+    size_t length;
+#ifdef _WIN32
+    HANDLE hFile;
+    HANDLE hMapping;
+#endif
+
+public:
+    MappedFile() : view(nullptr), length(0)
+#ifdef _WIN32
+        , hFile(INVALID_HANDLE_VALUE), hMapping(nullptr)
+#endif
+    {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { Close(); }
+
+#ifdef _WIN32
+    bool Open(const wchar_t* path) {
+        Close();
+        hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+            Close();
+            return false;
+        }
+
+        hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!hMapping) {
+            Close();
+            return false;
+        }
+
+        view = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        if (!view) {
+            Close();
+            return false;
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        return true;
+    }
+
+    void Close() {
+        if (view) UnmapViewOfFile(view);
+        if (hMapping) CloseHandle(hMapping);
+        if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+        view = nullptr;
+        length = 0;
+        hMapping = nullptr;
+        hFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    bool Open(const char* path) {
+        Close();
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        view = static_cast<const uint8_t*>(p);
+        length = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    void Close() {
+        if (view) munmap(const_cast<uint8_t*>(view), length);
+        view = nullptr;
+        length = 0;
+    }
+#endif
+
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+    bool valid() const { return view != nullptr; }
+};
+
+// Nom de clé ou de valeur : vue sur les octets de la hive (Latin-1 si compressé, sinon UTF-16LE)
+struct HiveName {
+    const uint8_t* data = nullptr;
+    uint32_t bytes = 0;
+    bool compressed = false;
+
+    size_t length() const { return compressed ? bytes : bytes / 2; }
+
+    // Copie dans un buffer réutilisable (pas d'allocation une fois la capacité atteinte)
+    void AssignTo(std::wstring& out) const {
+        out.clear();
+        if (compressed) {
+            AppendLatin1(out, data, bytes);
+        } else {
+            AppendUtf16LE(out, data, bytes);
+        }
+    }
+
+    // Comparaison insensible à la casse (ASCII), comme le gestionnaire de configuration
+    bool EqualsNoCase(const wchar_t* name, size_t nameLength) const {
+        if (length() != nameLength) {
+            return false;
+        }
+        for (size_t i = 0; i < nameLength; i++) {
+            uint32_t a = compressed ? data[i] : ReadLE16(data + i * 2);
+            uint32_t b = static_cast<uint32_t>(name[i]);
+            if (a >= 'a' && a <= 'z') a -= 32;
+            if (b >= 'a' && b <= 'z') b -= 32;
+            if (a != b) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Valeur registre : vue zero-copy sur le vk et ses données
+struct HiveValue {
+    HiveName name;
+    uint32_t type = 0;
+    const uint8_t* data = nullptr;
+    uint32_t dataSize = 0;
+};
+
+// Lecteur de hive regf sur un buffer (mappé ou décompressé en mémoire)
+class HiveReader {
+    const uint8_t* base;
+    size_t size;
+    uint32_t rootCell;
+    mutable std::vector<uint32_t>* trace;   // Cellules lues (mode incrémental), nullptr sinon
+
+    // Pointeur vers le contenu d'une cellule (après le champ taille), nullptr si hors bornes
+    const uint8_t* Cell(uint32_t offset, uint32_t* cellSize = nullptr) const {
+        if (offset == HIVE_NO_CELL || (offset & 7) != 0) {
+            return nullptr;
+        }
+        if (trace) {
+            trace->push_back(offset);
+        }
+        uint64_t pos = static_cast<uint64_t>(HIVE_BASE_BLOCK_SIZE) + offset;
+        if (pos + 4 > size) {
+            return nullptr;
+        }
+        int32_t raw = static_cast<int32_t>(ReadLE32(base + pos));
+        // Cellule allouée = taille négative
+        if (raw >= 0) {
+            return nullptr;
+        }
+        uint32_t total = static_cast<uint32_t>(-static_cast<int64_t>(raw));
+        if (total < 8 || pos + total > size) {
+            return nullptr;
+        }
+        if (cellSize) {
+            *cellSize = total - 4;
+        }
+        return base + pos + 4;
+    }
+
+    const uint8_t* KeyCell(uint32_t offset) const {
+        uint32_t len;
+        const uint8_t* nk = Cell(offset, &len);
+        if (!nk || len < 0x4C || nk[0] != 'n' || nk[1] != 'k') {
+            return nullptr;
+        }
+        if (0x4C + static_cast<uint32_t>(ReadLE16(nk + 0x48)) > len) {
+            return nullptr;
+        }
+        return nk;
+    }
+
+    // Parcours récursif des listes de sous-clés (ri → li/lf/lh)
+    template <typename F>
+    bool WalkSubkeyList(uint32_t listOffset, F& callback, uint32_t depth) const {
+        uint32_t len;
+        const uint8_t* list = Cell(listOffset, &len);
+        if (!list || len < 4 || depth > HIVE_MAX_LIST_DEPTH) {
+            return true;
+        }
+
+        uint16_t count = ReadLE16(list + 2);
+        bool isIndexRoot = list[0] == 'r' && list[1] == 'i';
+        bool isLeaf = list[0] == 'l' && list[1] == 'i';
+        bool isHashLeaf = list[0] == 'l' && (list[1] == 'f' || list[1] == 'h');
+        uint32_t stride = isHashLeaf ? 8 : 4;
+
+        if (!isIndexRoot && !isLeaf && !isHashLeaf) {
+            return true;
+        }
+        if (4 + static_cast<uint64_t>(count) * stride > len) {
+            return true;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t child = ReadLE32(list + 4 + i * stride);
+            if (isIndexRoot) {
+                if (!WalkSubkeyList(child, callback, depth + 1)) {
+                    return false;
+                }
+            } else if (KeyCell(child)) {
+                if (!callback(child)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    HiveReader() : base(nullptr), size(0), rootCell(HIVE_NO_CELL), trace(nullptr) {}
+
+    // Validation du base block ("regf") et de la première hbin
+    bool Open(const uint8_t* data, size_t dataSize) {
+        base = nullptr;
+        size = 0;
+        rootCell = HIVE_NO_CELL;
+
+        if (!data || dataSize < HIVE_BASE_BLOCK_SIZE + 0x20) {
+            return false;
+        }
+        if (std::memcmp(data, "regf", 4) != 0 || std::memcmp(data + HIVE_BASE_BLOCK_SIZE, "hbin", 4) != 0) {
+            return false;
+        }
+
+        base = data;
+        size = dataSize;
+
+        // Taille des hbins déclarée dans le base block (tronquée au fichier réel)
+        uint64_t binsSize = ReadLE32(data + 0x28);
+        if (binsSize != 0 && HIVE_BASE_BLOCK_SIZE + binsSize < size) {
+            size = static_cast<size_t>(HIVE_BASE_BLOCK_SIZE + binsSize);
+        }
+
+        rootCell = ReadLE32(data + 0x24);
+        if (!KeyCell(rootCell)) {
+            base = nullptr;
+            size = 0;
+            rootCell = HIVE_NO_CELL;
+            return false;
+        }
+        return true;
+    }
+
+    bool valid() const { return base != nullptr; }
+    uint32_t RootKey() const { return rootCell; }
+    const uint8_t* BaseBlock() const { return base; }
+
+    // Enregistre l'offset de chaque cellule lue dans cells (nullptr : arrêt)
+    void TraceCells(std::vector<uint32_t>* cells) const { trace = cells; }
+
+    // hbin d'offset et de taille connus (relevés lors d'une passe précédente), nullptr si l'en-tête diffère
+    const uint8_t* Bin(uint32_t offset, uint32_t binSize) const {
+        uint64_t pos = static_cast<uint64_t>(HIVE_BASE_BLOCK_SIZE) + offset;
+        if ((offset & 0xFFF) != 0 || binSize < 0x20 || pos + binSize > size) {
+            return nullptr;
+        }
+        const uint8_t* bin = base + pos;
+        if (std::memcmp(bin, "hbin", 4) != 0 || ReadLE32(bin + 4) != offset || ReadLE32(bin + 8) != binSize) {
+            return nullptr;
+        }
+        return bin;
+    }
+
+    // hbin contenant une cellule : en-tête cherché en arrière page par page, sans parcourir les hbins précédentes
+    bool FindBin(uint32_t cellOffset, uint32_t& binOffset, uint32_t& binSize) const {
+        uint32_t page = cellOffset & ~0xFFFu;
+        for (uint32_t step = 0; step < 4096; step++, page -= 0x1000) {
+            uint64_t pos = static_cast<uint64_t>(HIVE_BASE_BLOCK_SIZE) + page;
+            if (pos + 0x20 <= size && std::memcmp(base + pos, "hbin", 4) == 0 && ReadLE32(base + pos + 4) == page) {
+                uint32_t length = ReadLE32(base + pos + 8);
+                if (static_cast<uint64_t>(page) + length <= cellOffset || !Bin(page, length)) {
+                    return false;
+                }
+                binOffset = page;
+                binSize = length;
+                return true;
+            }
+            if (page == 0) {
+                break;
+            }
+        }
+        return false;
+    }
+
+    HiveName KeyName(uint32_t nkOffset) const {
+        HiveName name;
+        const uint8_t* nk = KeyCell(nkOffset);
+        if (nk) {
+            name.data = nk + 0x4C;
+            name.bytes = ReadLE16(nk + 0x48);
+            name.compressed = (ReadLE16(nk + 0x02) & HIVE_KEY_COMP_NAME) != 0;
+        }
+        return name;
+    }
+
+    // callback(uint32_t nkOffset) → false pour arrêter
+    template <typename F>
+    void ForEachSubkey(uint32_t nkOffset, F&& callback) const {
+        const uint8_t* nk = KeyCell(nkOffset);
+        if (!nk || ReadLE32(nk + 0x14) == 0) {
+            return;
+        }
+        WalkSubkeyList(ReadLE32(nk + 0x1C), callback, 0);
+    }
+
+    uint32_t FindSubkey(uint32_t nkOffset, const wchar_t* name, size_t nameLength) const {
+        uint32_t found = HIVE_NO_CELL;
+        ForEachSubkey(nkOffset, [&](uint32_t child) {
+            if (KeyName(child).EqualsNoCase(name, nameLength)) {
+                found = child;
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    // Résolution d'un chemin "A\\B\\C" relatif à une clé
+    uint32_t FindKeyPath(uint32_t nkOffset, const wchar_t* path) const {
+        uint32_t current = nkOffset;
+        const wchar_t* part = path;
+        while (current != HIVE_NO_CELL && *part) {
+            const wchar_t* end = part;
+            while (*end && *end != L'\\') end++;
+            if (end != part) {
+                current = FindSubkey(current, part, static_cast<size_t>(end - part));
+            }
+            part = *end ? end + 1 : end;
+        }
+        return current;
+    }
+
+    // callback(const HiveValue&) → false pour arrêter ; les valeurs invalides sont ignorées
+    template <typename F>
+    void ForEachValue(uint32_t nkOffset, F&& callback) const {
+        const uint8_t* nk = KeyCell(nkOffset);
+        if (!nk) {
+            return;
+        }
+
+        uint32_t valueCount = ReadLE32(nk + 0x24);
+        uint32_t listLen;
+        const uint8_t* list = Cell(ReadLE32(nk + 0x28), &listLen);
+        if (!list || valueCount == 0) {
+            return;
+        }
+        if (valueCount > listLen / 4) {
+            valueCount = listLen / 4;
+        }
+
+        for (uint32_t i = 0; i < valueCount; i++) {
+            uint32_t vkLen;
+            const uint8_t* vk = Cell(ReadLE32(list + i * 4), &vkLen);
+            if (!vk || vkLen < 0x14 || vk[0] != 'v' || vk[1] != 'k') {
+                continue;
+            }
+
+            HiveValue value;
+            value.name.data = vk + 0x14;
+            value.name.bytes = ReadLE16(vk + 0x02);
+            value.name.compressed = (ReadLE16(vk + 0x10) & HIVE_VALUE_COMP_NAME) != 0;
+            if (0x14 + value.name.bytes > vkLen) {
+                continue;
+            }
+
+            value.type = ReadLE32(vk + 0x0C);
+            uint32_t rawSize = ReadLE32(vk + 0x04);
+            if (rawSize & HIVE_DATA_INLINE) {
+                // Données ≤ 4 octets stockées dans le champ offset
+                value.dataSize = rawSize & ~HIVE_DATA_INLINE;
+                if (value.dataSize > 4) {
+                    continue;
+                }
+                value.data = vk + 0x08;
+            } else if (rawSize != 0) {
+                uint32_t dataLen;
+                const uint8_t* cellData = Cell(ReadLE32(vk + 0x08), &dataLen);
+                // Les données > 16344 octets (big data "db") n'apparaissent pas dans UserAssist
+                if (!cellData || rawSize > dataLen) {
+                    continue;
+                }
+                value.data = cellData;
+                value.dataSize = rawSize;
+            }
+
+            if (!callback(static_cast<const HiveValue&>(value))) {
+                return;
+            }
+        }
+    }
+};
+
+// Clé UserAssist\{GUID}\Count d'une hive NTUSER.DAT, HIVE_NO_CELL si absente
+inline uint32_t FindUserAssistCount(const HiveReader& hive, const wchar_t* guid) {
+    uint32_t userAssist = hive.FindKeyPath(hive.RootKey(), USERASSIST_KEY_PATH);
+    if (userAssist == HIVE_NO_CELL) {
+        return HIVE_NO_CELL;
+    }
+    uint32_t guidKey = hive.FindSubkey(userAssist, guid, std::wcslen(guid));
+    return hive.FindSubkey(guidKey, L"Count", 5);
+}
+
+// Parcours des valeurs d'une clé Count déjà localisée
+template <typename F>
+bool ForEachUserAssistValue(const HiveReader& hive, uint32_t count, F&& callback) {
+    if (count == HIVE_NO_CELL) {
+        return false;
+    }
+    bool any = false;
+    hive.ForEachValue(count, [&](const HiveValue& value) {
+        any = true;
+        return callback(value);
+    });
+    return any;
+}
+
+// Parcours des valeurs UserAssist\{GUID}\Count d'une hive NTUSER.DAT.
+// callback(const HiveValue&) reçoit des vues dans la hive, sans allocation.
+template <typename F>
+bool ForEachUserAssistValue(const HiveReader& hive, const wchar_t* guid, F&& callback) {
+    uint32_t count = FindUserAssistCount(hive, guid);
+    if (count == HIVE_NO_CELL) {
+        return false;
+    }
+
+    bool any = false;
+    hive.ForEachValue(count, [&](const HiveValue& value) {
+        any = true;
+        return callback(value);
+    });
+    return any;
+}
+
+struct UserAssistCountKey {
+    std::wstring guid;
+    uint32_t count = HIVE_NO_CELL;      // Offset de la cellule nk de Count
+
+    bool operator<(const UserAssistCountKey& other) const { return guid < other.guid; }
+};
+
+// Sous-clés {GUID} de UserAssist et leur clé Count, triées par GUID
+inline std::vector<UserAssistCountKey> ListUserAssistCountKeys(const HiveReader& hive) {
+    std::vector<UserAssistCountKey> keys;
+    uint32_t userAssist = hive.FindKeyPath(hive.RootKey(), USERASSIST_KEY_PATH);
+    if (userAssist == HIVE_NO_CELL) {
+        return keys;
+    }
+    hive.ForEachSubkey(userAssist, [&](uint32_t child) {
+        uint32_t count = hive.FindSubkey(child, L"Count", 5);
+        if (count != HIVE_NO_CELL) {
+            UserAssistCountKey key;
+            hive.KeyName(child).AssignTo(key.guid);
+            key.count = count;
+            keys.push_back(std::move(key));
+        }
+        return true;
+    });
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+// Sous-clés {GUID} de UserAssist possédant une clé Count (GUID récents, XP/Vista, propres à l'hôte)
+inline std::vector<std::wstring> ListUserAssistGuids(const HiveReader& hive) {
+    std::vector<std::wstring> guids;
+    for (auto& key : ListUserAssistCountKeys(hive)) {
+        guids.push_back(std::move(key.guid));
+    }
+    return guids;
+}
+
+// Même pipeline que ParseUserAssistKey : construit les UserAssistEntry depuis la hive
+inline bool ParseUserAssistHive(const HiveReader& hive, const wchar_t* guid, const wchar_t* username,
+                                std::vector<UserAssistEntry>& entries) {
+    std::wstring valueName;
+    return ForEachUserAssistValue(hive, guid, [&](const HiveValue& value) {
+        value.name.AssignTo(valueName);
+
+        UserAssistEntry entry;
+        entry.application = valueName;
+        entry.decodedPath = DecodeROT13(valueName);
+        entry.guid = guid;
+        entry.username = username;
+        DecodeUserAssistData(value.data, value.dataSize, value.type, entry);
+
+        entries.push_back(std::move(entry));
+        return true;
+    });
+}
+
+// Variante en flux : callback(nomEncodé, cheminDécodé, compteurs) par valeur, buffers réutilisés.
+// Les vues ne sont valides que pendant l'appel. perf : le temps du callback reste à attribuer
+// par l'appelant (Lap), sinon il est compté dans le parcours de la valeur suivante.
+template <typename F>
+bool StreamUserAssistHive(const HiveReader& hive, const wchar_t* guid, F&& row, PerfTally& perf) {
+    std::wstring encoded, decoded;
+    bool any = ForEachUserAssistValue(hive, guid, [&](const HiveValue& value) {
+        value.name.AssignTo(encoded);
+        perf.Lap(PERF_ENUMERATE);
+        decoded.resize(encoded.size());
+        DecodeROT13Buffer(encoded.data(), &decoded[0], encoded.size());
+        perf.Lap(PERF_ROT13);
+        UserAssistCounters counters = DecodeUserAssistCounters(value.data, value.dataSize, value.type);
+        perf.CountValue(value.type, counters);
+        perf.Lap(PERF_DECODE);
+        row(std::wstring_view(encoded), std::wstring_view(decoded), counters);
+        return true;
+    });
+    perf.Lap(PERF_ENUMERATE);
+    return any;
+}
+
+template <typename F>
+bool StreamUserAssistHive(const HiveReader& hive, const wchar_t* guid, F&& row) {
+    PerfTally off(false);
+    return StreamUserAssistHive(hive, guid, std::forward<F>(row), off);
+}
+
+// Données Count d'une clé (pointeurs dans la hive mappée) décodées par lot dans les colonnes du store
+inline void AppendUserAssistBlobs(EntryStore& store, const std::vector<uint32_t>& paths, uint32_t guidId,
+                                  uint32_t userId, const std::vector<UserAssistBlob>& blobs, PerfTally& perf) {
+    size_t start = store.size();
+    store.Append(paths, guidId, userId, blobs);
+    perf.Lap(PERF_DECODE);
+    for (size_t i = 0; i < blobs.size(); i++) {
+        perf.CountValue(blobs[i].type, store.timeStatus[start + i]);
+    }
+}
+
+// Variante colonnaire sur une clé Count localisée (count = HIVE_NO_CELL : aucune entrée)
+inline bool ParseUserAssistCount(const HiveReader& hive, uint32_t count, const wchar_t* guid, const wchar_t* username,
+                                 EntryStore& store, PerfTally& perf) {
+    uint32_t guidId = store.strings.Intern(guid, std::wcslen(guid));
+    uint32_t userId = store.strings.Intern(username, std::wcslen(username));
+    std::wstring path;
+    std::vector<uint32_t> paths;
+    std::vector<UserAssistBlob> blobs;
+    bool any = ForEachUserAssistValue(hive, count, [&](const HiveValue& value) {
+        value.name.AssignTo(path);
+        perf.Lap(PERF_ENUMERATE);
+        DecodeROT13InPlace(&path[0], path.size());
+        perf.Lap(PERF_ROT13);
+        paths.push_back(store.strings.Intern(path));
+        blobs.push_back({ value.data, value.dataSize, value.type });
+        perf.Lap(PERF_STORE);
+        return true;
+    });
+    perf.Lap(PERF_ENUMERATE);
+    AppendUserAssistBlobs(store, paths, guidId, userId, blobs, perf);
+    return any;
+}
+
+// Variante colonnaire : noms décodés dans un buffer réutilisé puis internés, sans UserAssistEntry
+inline bool ParseUserAssistHive(const HiveReader& hive, const wchar_t* guid, const wchar_t* username,
+                                EntryStore& store, PerfTally& perf) {
+    return ParseUserAssistCount(hive, FindUserAssistCount(hive, guid), guid, username, store, perf);
+}
+
+inline bool ParseUserAssistHive(const HiveReader& hive, const wchar_t* guid, const wchar_t* username,
+                                EntryStore& store) {
+    PerfTally off(false);
+    return ParseUserAssistHive(hive, guid, username, store, off);
+}
@@ -0,0 +1,431 @@
+/*
+ * Inflate - décompression DEFLATE (RFC 1951) en flux et CRC-32, sans dépendance externe
+ * Utilisé par TriageArchive.h (zip, gzip) : l'entrée est une vue en mémoire (archive mappée),
+ * la sortie est livrée par tranches à un callback, avec 32 Ko d'historique conservés pour les références.
+ *
+ * - Huffman : table directe sur 10 bits, décodage canonique bit à bit au-delà (codes longs, rares)
+ * - Lecture des bits par mots de 64 bits ; flux tronqué ou incohérent signalé, jamais lu hors de l'entrée
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+constexpr size_t INFLATE_WINDOW = 32768;            // Distance maximale d'une référence
+constexpr size_t INFLATE_CHUNK = 256 * 1024;        // Sortie livrée par tranches de cette taille
+constexpr size_t INFLATE_MAX_MATCH = 258;
+
+enum InflateStatus : uint8_t {
+    INFLATE_DONE = 0,       // Dernier bloc décodé
+    INFLATE_STOPPED,        // Arrêt demandé par le callback
+    INFLATE_TRUNCATED,      // Entrée épuisée avant le dernier bloc
+    INFLATE_CORRUPT         // Code, longueur ou distance invalide
+};
+
+constexpr const char* INFLATE_STATUS_NAMES[] = {
+    "termin\xC3\xA9", "interrompu", "flux deflate tronqu\xC3\xA9", "flux deflate corrompu"
+};
+
+// CRC-32 (polynôme 0xEDB88320, zip/gzip), tranches de 8 octets
+inline const uint32_t* Crc32Tables() {
+    static const std::vector<uint32_t> tables = [] {
+        std::vector<uint32_t> t(8 * 256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (size_t s = 1; s < 8; s++) {
+                t[s * 256 + i] = (t[(s - 1) * 256 + i] >> 8) ^ t[t[(s - 1) * 256 + i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+    return tables.data();
+}
+
+// crc : valeur précédente (0 au départ)
+inline uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    const uint32_t* t = Crc32Tables();
+    crc = ~crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint32_t lo = ReadLE32(data) ^ crc;
+        uint32_t hi = ReadLE32(data + 4);
+        crc = t[7 * 256 + (lo & 0xFF)] ^ t[6 * 256 + ((lo >> 8) & 0xFF)] ^ t[5 * 256 + ((lo >> 16) & 0xFF)] ^
+              t[4 * 256 + (lo >> 24)] ^ t[3 * 256 + (hi & 0xFF)] ^ t[2 * 256 + ((hi >> 8) & 0xFF)] ^
+              t[1 * 256 + ((hi >> 16) & 0xFF)] ^ t[hi >> 24];
+    }
+    while (size--) {
+        crc = t[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Code de Huffman canonique (longueurs → table directe + tables du décodage lent)
+class InflateHuffman {
+public:
+    static constexpr unsigned FAST_BITS = 10;
+    static constexpr unsigned MAX_BITS = 15;
+
+    uint16_t fast[1u << FAST_BITS];     // symbole | longueur << 9 ; 0 = code de plus de FAST_BITS bits
+    uint16_t counts[MAX_BITS + 1];
+    uint16_t symbols[288];
+
+    // false si le code est sur-souscrit (un code incomplet est accepté : erreur au décodage seulement)
+    bool Build(const uint8_t* lengths, size_t n) {
+        std::memset(counts, 0, sizeof(counts));
+        std::memset(fast, 0, sizeof(fast));
+        for (size_t i = 0; i < n; i++) {
+            counts[lengths[i]]++;
+        }
+        counts[0] = 0;
+        int left = 1;
+        for (unsigned len = 1; len <= MAX_BITS; len++) {
+            left = (left << 1) - counts[len];
+            if (left < 0) {
+                return false;
+            }
+        }
+
+        uint16_t offsets[MAX_BITS + 2] = {};
+        for (unsigned len = 1; len <= MAX_BITS; len++) {
+            offsets[len + 1] = static_cast<uint16_t>(offsets[len] + counts[len]);
+        }
+        uint32_t next[MAX_BITS + 1] = {};
+        uint32_t code = 0;
+        for (unsigned len = 1; len <= MAX_BITS; len++) {
+            next[len] = code;
+            code = (code + counts[len]) << 1;
+        }
+
+        for (size_t sym = 0; sym < n; sym++) {
+            unsigned len = lengths[sym];
+            if (len == 0) {
+                continue;
+            }
+            symbols[offsets[len]++] = static_cast<uint16_t>(sym);
+            if (len <= FAST_BITS) {
+                // Bits lus de poids faible en premier : code inversé, répété sur les bits libres
+                uint32_t c = next[len];
+                uint32_t reversed = 0;
+                for (unsigned b = 0; b < len; b++) {
+                    reversed |= ((c >> b) & 1u) << (len - 1 - b);
+                }
+                uint16_t entry = static_cast<uint16_t>(sym | (len << 9));
+                for (uint32_t k = reversed; k < (1u << FAST_BITS); k += 1u << len) {
+                    fast[k] = entry;
+                }
+            }
+            next[len]++;
+        }
+        return true;
+    }
+};
+
+class Inflater {
+    // Entrée
+    const uint8_t* in = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t bits = 0;
+    unsigned count = 0;
+    size_t padded = 0;          // Octets nuls ajoutés après la fin de l'entrée
+
+    // Sortie : historique de INFLATE_WINDOW octets + tranche en cours
+    std::vector<uint8_t> out;
+    size_t pos = 0;
+    size_t flushed = 0;
+    uint64_t total = 0;
+
+    InflateHuffman litlen;
+    InflateHuffman dist;
+
+    void Refill() {
+        if (end - in >= 8) {
+            bits |= ReadLE64(in) << count;
+            in += (63 - count) >> 3;
+            count |= 56;
+            return;
+        }
+        while (count <= 56) {
+            if (in < end) {
+                bits |= static_cast<uint64_t>(*in++) << count;
+            } else {
+                padded++;
+            }
+            count += 8;
+        }
+    }
+
+    // Bits de bourrage consommés : l'entrée était tronquée
+    bool Overrun() const { return padded * 8 > count; }
+
+    uint32_t Bits(unsigned n) {
+        if (count < n) {
+            Refill();
+        }
+        uint32_t v = static_cast<uint32_t>(bits & ((1ull << n) - 1));
+        bits >>= n;
+        count -= n;
+        return v;
+    }
+
+    int Decode(const InflateHuffman& h) {
+        if (count < InflateHuffman::MAX_BITS) {
+            Refill();
+        }
+        uint16_t entry = h.fast[bits & ((1u << InflateHuffman::FAST_BITS) - 1)];
+        if (entry) {
+            unsigned len = entry >> 9;
+            bits >>= len;
+            count -= len;
+            return entry & 0x1FF;
+        }
+        int code = 0, first = 0, index = 0;
+        for (unsigned len = 1; len <= InflateHuffman::MAX_BITS; len++) {
+            code |= static_cast<int>(bits & 1);
+            bits >>= 1;
+            count--;
+            int n = h.counts[len];
+            if (code - n < first) {
+                return h.symbols[index + (code - first)];
+            }
+            index += n;
+            first += n;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    template <typename Sink>
+    bool Flush(Sink& sink) {
+        bool keep = pos == flushed || sink(static_cast<const uint8_t*>(out.data() + flushed), pos - flushed);
+        if (pos > INFLATE_WINDOW) {
+            std::memmove(out.data(), out.data() + pos - INFLATE_WINDOW, INFLATE_WINDOW);
+            pos = INFLATE_WINDOW;
+        }
+        flushed = pos;
+        return keep;
+    }
+
+    template <typename Sink>
+    InflateStatus Stored(Sink& sink) {
+        // Alignement sur l'octet, puis octets restitués du tampon de bits à l'entrée
+        Bits(count & 7);
+        uint32_t length = Bits(16);
+        uint32_t complement = Bits(16);
+        if (Overrun()) {
+            return INFLATE_TRUNCATED;
+        }
+        if ((length ^ 0xFFFF) != complement) {
+            return INFLATE_CORRUPT;
+        }
+        in -= (count >> 3) - padded;
+        bits = 0;
+        count = 0;
+        padded = 0;
+        if (static_cast<size_t>(end - in) < length) {
+            return INFLATE_TRUNCATED;
+        }
+        while (length) {
+            size_t room = INFLATE_WINDOW + INFLATE_CHUNK - pos;
+            size_t n = length < room ? length : room;
+            std::memcpy(out.data() + pos, in, n);
+            in += n;
+            pos += n;
+            total += n;
+            length -= static_cast<uint32_t>(n);
+            if (pos >= INFLATE_WINDOW + INFLATE_CHUNK && !Flush(sink)) {
+                return INFLATE_STOPPED;
+            }
+        }
+        return INFLATE_DONE;
+    }
+
+    bool FixedTables() {
+        static const struct Fixed {
+            InflateHuffman litlen, dist;
+            Fixed() {
+                uint8_t lengths[288];
+                std::memset(lengths, 8, 144);
+                std::memset(lengths + 144, 9, 112);
+                std::memset(lengths + 256, 7, 24);
+                std::memset(lengths + 280, 8, 8);
+                litlen.Build(lengths, 288);
+                std::memset(lengths, 5, 30);
+                dist.Build(lengths, 30);
+            }
+        } fixed;
+        litlen = fixed.litlen;
+        dist = fixed.dist;
+        return true;
+    }
+
+    bool DynamicTables() {
+        static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        uint32_t nlen = Bits(5) + 257;
+        uint32_t ndist = Bits(5) + 1;
+        uint32_t ncode = Bits(4) + 4;
+        if (nlen > 286 || ndist > 30) {
+            return false;
+        }
+        uint8_t lengths[320] = {};
+        for (uint32_t i = 0; i < ncode; i++) {
+            lengths[order[i]] = static_cast<uint8_t>(Bits(3));
+        }
+        InflateHuffman codes;
+        if (!codes.Build(lengths, 19)) {
+            return false;
+        }
+
+        std::memset(lengths, 0, sizeof(lengths));
+        uint32_t index = 0;
+        while (index < nlen + ndist) {
+            int sym = Decode(codes);
+            if (sym < 0 || Overrun()) {
+                return false;
+            }
+            if (sym < 16) {
+                lengths[index++] = static_cast<uint8_t>(sym);
+                continue;
+            }
+            uint8_t value = 0;
+            uint32_t repeat;
+            if (sym == 16) {
+                if (index == 0) {
+                    return false;
+                }
+                value = lengths[index - 1];
+                repeat = 3 + Bits(2);
+            } else if (sym == 17) {
+                repeat = 3 + Bits(3);
+            } else {
+                repeat = 11 + Bits(7);
+            }
+            if (index + repeat > nlen + ndist) {
+                return false;
+            }
+            std::memset(lengths + index, value, repeat);
+            index += repeat;
+        }
+        if (lengths[256] == 0) {
+            return false;   // Pas de fin de bloc
+        }
+        return litlen.Build(lengths, nlen) && dist.Build(lengths + nlen, ndist);
+    }
+
+    template <typename Sink>
+    InflateStatus Codes(Sink& sink) {
+        static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                               257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                               8193, 12289, 16385, 24577 };
+        static const uint8_t distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                               7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        for (;;) {
+            if (pos >= INFLATE_WINDOW + INFLATE_CHUNK && !Flush(sink)) {
+                return INFLATE_STOPPED;
+            }
+            int sym = Decode(litlen);
+            if (Overrun()) {
+                return INFLATE_TRUNCATED;
+            }
+            if (sym < 0) {
+                return INFLATE_CORRUPT;
+            }
+            if (sym < 256) {
+                out[pos++] = static_cast<uint8_t>(sym);
+                total++;
+                continue;
+            }
+            if (sym == 256) {
+                return INFLATE_DONE;
+            }
+            sym -= 257;
+            if (sym >= 29) {
+                return INFLATE_CORRUPT;
+            }
+            uint32_t length = lengthBase[sym] + Bits(lengthExtra[sym]);
+            int dsym = Decode(dist);
+            if (dsym < 0 || dsym >= 30) {
+                return Overrun() ? INFLATE_TRUNCATED : INFLATE_CORRUPT;
+            }
+            uint32_t distance = distBase[dsym] + Bits(distExtra[dsym]);
+            if (Overrun()) {
+                return INFLATE_TRUNCATED;
+            }
+            if (distance > total || distance > pos) {
+                return INFLATE_CORRUPT;
+            }
+            uint8_t* dst = out.data() + pos;
+            const uint8_t* src = dst - distance;
+            if (distance >= length) {
+                std::memcpy(dst, src, length);
+            } else {
+                for (uint32_t i = 0; i < length; i++) {
+                    dst[i] = src[i];    // Recouvrement : répétition du motif
+                }
+            }
+            pos += length;
+            total += length;
+        }
+    }
+
+public:
+    Inflater() : out(INFLATE_WINDOW + INFLATE_CHUNK + INFLATE_MAX_MATCH) {}
+
+    // Flux deflate brut ; sink(const uint8_t* data, size_t size) → false pour arrêter.
+    // consumed : octets de l'entrée utilisés (suite du conteneur : CRC gzip, membre suivant)
+    template <typename Sink>
+    InflateStatus Run(const uint8_t* data, size_t size, Sink&& sink, size_t* consumed = nullptr) {
+        in = data;
+        end = data + size;
+        bits = 0;
+        count = 0;
+        padded = 0;
+        pos = 0;
+        flushed = 0;
+        total = 0;
+
+        InflateStatus status = INFLATE_DONE;
+        bool last = false;
+        while (!last && status == INFLATE_DONE) {
+            last = Bits(1) != 0;
+            uint32_t type = Bits(2);
+            if (Overrun()) {
+                status = INFLATE_TRUNCATED;
+            } else if (type == 0) {
+                status = Stored(sink);
+            } else if (type == 1) {
+                FixedTables();
+                status = Codes(sink);
+            } else if (type == 2) {
+                status = DynamicTables() ? Codes(sink) : (Overrun() ? INFLATE_TRUNCATED : INFLATE_CORRUPT);
+            } else {
+                status = INFLATE_CORRUPT;
+            }
+        }
+        if (status == INFLATE_DONE && !Flush(sink)) {
+            status = INFLATE_STOPPED;
+        }
+        if (consumed) {
+            size_t buffered = count >> 3;
+            size_t real = buffered > padded ? buffered - padded : 0;
+            *consumed = static_cast<size_t>(in - data) - real;
+        }
+        return status;
+    }
+
+    uint64_t TotalOut() const { return total; }
+};
@@ -0,0 +1,214 @@
+/*
+ * KnownFolders - résolution des GUID de dossiers connus en tête des chemins UserAssist
+ * "{6D809377-6AF0-444B-8957-A3773F02200E}\App\outil.exe" -> "%ProgramFiles%\App\outil.exe"
+ *
+ * - Table constexpr (FOLDERID_* de KnownFolders.h du SDK) et hachage parfait calculé à la
+ *   compilation : une lecture de table et une comparaison 128 bits par chemin candidat
+ * - Chemin sans '{' initial : rejeté au premier caractère, sans allocation
+ * - Identifiant sur un octet (0 = aucun) stocké comme colonne par EntryStore
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct KnownFolder {
+    const wchar_t* guid;
+    const wchar_t* name;    // Nom symbolique (FOLDERID_ sans préfixe)
+    const wchar_t* path;    // Emplacement par défaut, variables d'environnement non développées
+};
+
+constexpr KnownFolder KNOWN_FOLDERS[] = {
+    { L"{1AC14E77-02E7-4E5D-B744-2EB1AE5198B7}", L"System", L"%windir%\\System32" },
+    { L"{D65231B0-B2F1-4857-A4CE-A8E7C6EA7D27}", L"SystemX86", L"%windir%\\SysWOW64" },
+    { L"{F38BF404-1D43-42F2-9305-67DE0B28FC23}", L"Windows", L"%windir%" },
+    { L"{FD228CB7-AE11-4AE3-864C-16F3910AB8FE}", L"Fonts", L"%windir%\\Fonts" },
+    { L"{8AD10C31-2ADB-4296-A8F7-E4701232C972}", L"ResourceDir", L"%windir%\\Resources" },
+    { L"{6D809377-6AF0-444B-8957-A3773F02200E}", L"ProgramFilesX64", L"%ProgramFiles%" },
+    { L"{7C5A40EF-A0FB-4BFC-874A-C0F2E0B9FA8E}", L"ProgramFilesX86", L"%ProgramFiles(x86)%" },
+    { L"{905E63B6-C1BF-494E-B29C-65B732D3D21A}", L"ProgramFiles", L"%ProgramFiles%" },
+    { L"{F7F1ED05-9F6D-47A2-AAAE-29D317C6F066}", L"ProgramFilesCommon", L"%ProgramFiles%\\Common Files" },
+    { L"{6365D5A7-0F0D-45E5-87F6-0DA56B6A4F7D}", L"ProgramFilesCommonX64", L"%ProgramFiles%\\Common Files" },
+    { L"{DE974D24-D9C6-4D3E-BF91-F4455120B917}", L"ProgramFilesCommonX86", L"%ProgramFiles(x86)%\\Common Files" },
+    { L"{62AB5D82-FDC1-4DC3-A9DD-070D1D495D97}", L"ProgramData", L"%ALLUSERSPROFILE%" },
+    { L"{A4115719-D62E-491D-AA7C-E74B8BE3B067}", L"CommonStartMenu",
+      L"%ALLUSERSPROFILE%\\Microsoft\\Windows\\Start Menu" },
+    { L"{0139D44E-6AFE-49F2-8690-3DAFCAE6FFB8}", L"CommonPrograms",
+      L"%ALLUSERSPROFILE%\\Microsoft\\Windows\\Start Menu\\Programs" },
+    { L"{82A5EA35-D9CD-47C5-9629-E15D2F714E6E}", L"CommonStartup",
+      L"%ALLUSERSPROFILE%\\Microsoft\\Windows\\Start Menu\\Programs\\StartUp" },
+    { L"{D0384E7D-BAC3-4797-8F14-CBA229B392B5}", L"CommonAdminTools",
+      L"%ALLUSERSPROFILE%\\Microsoft\\Windows\\Start Menu\\Programs\\Administrative Tools" },
+    { L"{B94237E7-57AC-4347-9151-B08C6C32D1F7}", L"CommonTemplates",
+      L"%ALLUSERSPROFILE%\\Microsoft\\Windows\\Templates" },
+    { L"{0762D272-C50A-4BB0-A382-697DCD729B80}", L"UserProfiles", L"%SystemDrive%\\Users" },
+    { L"{DFDF76A2-C82A-4D63-906A-5644AC457385}", L"Public", L"%PUBLIC%" },
+    { L"{C4AA340D-F20F-4863-AFEF-F87EF2E6BA25}", L"PublicDesktop", L"%PUBLIC%\\Desktop" },
+    { L"{ED4824AF-DCE4-45A8-81E2-FC7965083634}", L"PublicDocuments", L"%PUBLIC%\\Documents" },
+    { L"{3D644C9B-1FB8-4F30-9B45-F670235F79C0}", L"PublicDownloads", L"%PUBLIC%\\Downloads" },
+    { L"{5E6C858F-0E22-4760-9AFE-EA3317B67173}", L"Profile", L"%USERPROFILE%" },
+    { L"{B4BFCC3A-DB2C-424C-B029-7FE99A87C641}", L"Desktop", L"%USERPROFILE%\\Desktop" },
+    { L"{FDD39AD0-238F-46AF-ADB4-6C85480369C7}", L"Documents", L"%USERPROFILE%\\Documents" },
+    { L"{374DE290-123F-4565-9164-39C4925E467B}", L"Downloads", L"%USERPROFILE%\\Downloads" },
+    { L"{4BD8D571-6D19-48D3-BE97-422220080E43}", L"Music", L"%USERPROFILE%\\Music" },
+    { L"{33E28130-4E1E-4676-835A-98395C3BC3BB}", L"Pictures", L"%USERPROFILE%\\Pictures" },
+    { L"{18989B1D-99B5-455B-841C-AB7C74E4DDFC}", L"Videos", L"%USERPROFILE%\\Videos" },
+    { L"{1777F761-68AD-4D8A-87BD-30B759FA33DD}", L"Favorites", L"%USERPROFILE%\\Favorites" },
+    { L"{BFB9D5E0-C6A9-404C-B2B2-AE6DB6AF4968}", L"Links", L"%USERPROFILE%\\Links" },
+    { L"{56784854-C6CB-462B-8169-88E350ACB882}", L"Contacts", L"%USERPROFILE%\\Contacts" },
+    { L"{4C5C32FF-BB9D-43B0-B5B4-2D72E54EAAA4}", L"SavedGames", L"%USERPROFILE%\\Saved Games" },
+    { L"{7D1D3A04-DEBB-4115-95CF-2F29DA2920DA}", L"SavedSearches", L"%USERPROFILE%\\Searches" },
+    { L"{A52BBA46-E9E1-435F-B3D9-28DAA648C0F6}", L"OneDrive", L"%USERPROFILE%\\OneDrive" },
+    { L"{3EB685DB-65F9-4CF6-A03A-E3EF65729F3D}", L"RoamingAppData", L"%APPDATA%" },
+    { L"{F1B32785-6FBA-4FCF-9D55-7B8E7F157091}", L"LocalAppData", L"%LOCALAPPDATA%" },
+    { L"{A520A1A4-1780-4FF6-BD18-167343C5AF16}", L"LocalAppDataLow", L"%USERPROFILE%\\AppData\\LocalLow" },
+    { L"{5CD7AEE2-2219-4A67-B85D-6C9CE15660CB}", L"UserProgramFiles", L"%LOCALAPPDATA%\\Programs" },
+    { L"{BCBD3057-CA5C-4622-B42D-BC56DB0AE516}", L"UserProgramFilesCommon", L"%LOCALAPPDATA%\\Programs\\Common" },
+    { L"{625B53C3-AB48-4EC1-BA1F-A1EF4146FC19}", L"StartMenu", L"%APPDATA%\\Microsoft\\Windows\\Start Menu" },
+    { L"{A77F5D77-2E2B-44C3-A6A2-ABA601054A51}", L"Programs",
+      L"%APPDATA%\\Microsoft\\Windows\\Start Menu\\Programs" },
+    { L"{B97D20BB-F46A-4C97-BA10-5E3608430854}", L"Startup",
+      L"%APPDATA%\\Microsoft\\Windows\\Start Menu\\Programs\\StartUp" },
+    { L"{724EF170-A42D-4FEF-9F26-B60E846FBA4F}", L"AdminTools",
+      L"%APPDATA%\\Microsoft\\Windows\\Start Menu\\Programs\\Administrative Tools" },
+    { L"{A63293E8-664E-48DB-A079-DF759E0509F7}", L"Templates", L"%APPDATA%\\Microsoft\\Windows\\Templates" },
+    { L"{AE50C081-EBD2-438A-8655-8A092E34987A}", L"Recent", L"%APPDATA%\\Microsoft\\Windows\\Recent" },
+    { L"{8983036C-27C0-404B-8F08-102D10DCFD74}", L"SendTo", L"%APPDATA%\\Microsoft\\Windows\\SendTo" },
+    { L"{52A4F021-7B75-48A9-9F6B-4B87A210BC8F}", L"QuickLaunch",
+      L"%APPDATA%\\Microsoft\\Internet Explorer\\Quick Launch" },
+    { L"{9E3995AB-1F9C-4F13-B827-48B24B6C7174}", L"UserPinned",
+      L"%APPDATA%\\Microsoft\\Internet Explorer\\Quick Launch\\User Pinned" },
+    { L"{BCB5256F-79F6-4CEE-B725-DC34E402FD46}", L"ImplicitAppShortcuts",
+      L"%APPDATA%\\Microsoft\\Internet Explorer\\Quick Launch\\User Pinned\\ImplicitAppShortcuts" },
+};
+
+constexpr size_t KNOWN_FOLDER_COUNT = sizeof(KNOWN_FOLDERS) / sizeof(KNOWN_FOLDERS[0]);
+constexpr size_t KNOWN_FOLDER_GUID_CHARS = 38;      // "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}"
+constexpr unsigned KNOWN_FOLDER_TABLE_BITS = 8;     // 256 cases pour ~50 GUID (une graine se trouve vite)
+static_assert(KNOWN_FOLDER_COUNT < 255, "identifiant sur un octet");
+
+struct KnownFolderKey {
+    uint64_t high = 0;
+    uint64_t low = 0;
+    constexpr bool operator==(const KnownFolderKey& other) const { return high == other.high && low == other.low; }
+};
+
+// Chiffre hexadécimal (casse indifférente), -1 sinon
+template <typename CharT>
+constexpr int KnownFolderHexDigit(CharT ch) {
+    return (ch >= '0' && ch <= '9') ? static_cast<int>(ch - '0')
+         : (ch >= 'A' && ch <= 'F') ? static_cast<int>(ch - 'A' + 10)
+         : (ch >= 'a' && ch <= 'f') ? static_cast<int>(ch - 'a' + 10) : -1;
+}
+
+// Les 32 chiffres du GUID textuel en 128 bits ; faux si la forme n'est pas celle d'un GUID
+template <typename CharT>
+constexpr bool ParseKnownFolderKey(const CharT* text, KnownFolderKey& key) {
+    if (text[0] != '{' || text[9] != '-' || text[14] != '-' || text[19] != '-' || text[24] != '-' ||
+        text[37] != '}') {
+        return false;
+    }
+    uint64_t words[2] = { 0, 0 };
+    size_t digits = 0;
+    for (size_t i = 1; i < KNOWN_FOLDER_GUID_CHARS - 1; i++) {
+        if (i == 9 || i == 14 || i == 19 || i == 24) {
+            continue;
+        }
+        int value = KnownFolderHexDigit(text[i]);
+        if (value < 0) {
+            return false;
+        }
+        words[digits / 16] = (words[digits / 16] << 4) | static_cast<uint64_t>(value);
+        digits++;
+    }
+    key.high = words[0];
+    key.low = words[1];
+    return true;
+}
+
+constexpr size_t KnownFolderSlot(const KnownFolderKey& key, uint64_t seed) {
+    uint64_t h = (key.high ^ (key.low * 0x9E3779B97F4A7C15ull)) * seed;
+    return static_cast<size_t>(h >> (64 - KNOWN_FOLDER_TABLE_BITS));
+}
+
+// Table de hachage parfaite : cases = identifiant + 1 (0 = vide), graine cherchée à la compilation
+struct KnownFolderTable {
+    uint64_t seed = 0;
+    std::array<uint8_t, size_t(1) << KNOWN_FOLDER_TABLE_BITS> slots{};
+    std::array<KnownFolderKey, KNOWN_FOLDER_COUNT> keys{};
+};
+
+constexpr KnownFolderTable BuildKnownFolderTable() {
+    KnownFolderTable table;
+    for (size_t i = 0; i < KNOWN_FOLDER_COUNT; i++) {
+        if (!ParseKnownFolderKey(KNOWN_FOLDERS[i].guid, table.keys[i])) {
+            return table;   // GUID mal formé : seed = 0, refusé par le static_assert
+        }
+    }
+    for (uint64_t candidate = 1; candidate < 20000; candidate++) {
+        uint64_t seed = candidate * 0xBF58476D1CE4E5B9ull | 1;
+        for (auto& slot : table.slots) {
+            slot = 0;
+        }
+        bool collision = false;
+        for (size_t i = 0; i < KNOWN_FOLDER_COUNT && !collision; i++) {
+            uint8_t& slot = table.slots[KnownFolderSlot(table.keys[i], seed)];
+            collision = slot != 0;
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        if (!collision) {
+            table.seed = seed;
+            return table;
+        }
+    }
+    return table;
+}
+
+constexpr KnownFolderTable KNOWN_FOLDER_TABLE = BuildKnownFolderTable();
+static_assert(KNOWN_FOLDER_TABLE.seed != 0, "GUID mal formé ou aucune graine sans collision");
+
+// Identifiant (1..KNOWN_FOLDER_COUNT) du dossier connu en tête du chemin, 0 sinon.
+// Le GUID doit être suivi de la fin du chemin ou d'un '\'.
+template <typename CharT>
+inline uint8_t FindKnownFolder(const CharT* path, size_t length) {
+    if (length < KNOWN_FOLDER_GUID_CHARS || path[0] != '{' ||
+        (length > KNOWN_FOLDER_GUID_CHARS && path[KNOWN_FOLDER_GUID_CHARS] != '\\')) {
+        return 0;
+    }
+    KnownFolderKey key;
+    if (!ParseKnownFolderKey(path, key)) {
+        return 0;
+    }
+    uint8_t id = KNOWN_FOLDER_TABLE.slots[KnownFolderSlot(key, KNOWN_FOLDER_TABLE.seed)];
+    return id != 0 && KNOWN_FOLDER_TABLE.keys[id - 1] == key ? id : 0;
+}
+
+inline uint8_t FindKnownFolder(std::wstring_view path) { return FindKnownFolder(path.data(), path.size()); }
+
+inline const KnownFolder* KnownFolderById(uint8_t id) {
+    return id != 0 && id <= KNOWN_FOLDER_COUNT ? &KNOWN_FOLDERS[id - 1] : nullptr;
+}
+
+// Chemin résolu en deux morceaux (dossier développé + reste commençant par '\'), sans copie ;
+// chemin sans dossier connu : folder vide, rest = chemin d'origine
+struct ResolvedPath {
+    std::wstring_view folder;
+    std::wstring_view rest;
+
+    size_t size() const { return folder.size() + rest.size(); }
+};
+
+inline ResolvedPath ResolveKnownFolder(std::wstring_view path, uint8_t id) {
+    const KnownFolder* folder = KnownFolderById(id);
+    if (!folder) {
+        return ResolvedPath{ std::wstring_view(), path };
+    }
+    return ResolvedPath{ std::wstring_view(folder->path), path.substr(KNOWN_FOLDER_GUID_CHARS) };
+}
+
+inline ResolvedPath ResolveKnownFolder(std::wstring_view path) {
+    return ResolveKnownFolder(path, FindKnownFolder(path));
+}
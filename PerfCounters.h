@@ -0,0 +1,247 @@
+/*
+ * PerfCounters - instrumentation par étape d'un scan (décompression, parcours, ROT13, décodage, affichage, export)
+ * Chaque tâche (ou étape mono-thread) mesure dans un PerfTally local (sans atomique), publié
+ * en une fois dans PerfCounters à la fin de la tâche. Mesure par "tours" : chaque Lap() attribue
+ * le temps écoulé depuis le tour précédent à une étape, sans trou ni double comptage.
+ * Rapport JSON en fin d'exécution (outil, version, hôte, débit, valeurs ignorées, mémoire pic).
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "ExportSink.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+enum PerfStage : uint8_t {
+    PERF_INFLATE = 0,       // Décompression des archives de triage (zip, gzip, tar)
+    PERF_ENUMERATE,     // Parcours registre (RegEnumValueW) ou cellules regf, ouverture des hives
+    PERF_ROT13,             // Décodage des noms de valeurs
+    PERF_DECODE,            // Structures binaires des données Count
+    PERF_STORE,             // Internement, ajout aux colonnes, agrégats
+    PERF_FORMAT,            // Dates et durées en texte
+    PERF_DISPLAY,           // Remplissage de la ListView
+    PERF_EXPORT,            // Écriture CSV/JSON/.uatl (formatage compris en batch)
+    PERF_STAGE_COUNT
+};
+
+enum PerfCounter : uint8_t {
+    PERF_SOURCES = 0,           // Hives ou profils parcourus
+    PERF_VALUES,                // Valeurs Count lues
+    PERF_BYTES_READ,            // Octets des hives mappées, ou noms + données lus dans le registre
+    PERF_SKIPPED_ENUM,          // Échecs de RegEnumValueW (données > buffer, accès refusé...)
+    PERF_SKIPPED_UNDERSIZED,    // Données trop courtes pour une structure connue
+    PERF_SKIPPED_TYPE,          // Type de valeur autre que REG_BINARY
+    PERF_UNKNOWN_VERSION,       // Taille hors des dispositions connues (XP 16 octets, Windows 7+ 72 octets)
+    PERF_ARCHIVES,              // Archives de triage ouvertes
+    PERF_ARCHIVE_BYTES,         // Octets compressés lus dans les archives
+    PERF_COUNTER_COUNT
+};
+
+constexpr const char* PERF_STAGE_NAMES[PERF_STAGE_COUNT] = {
+    "decompression", "enumeration", "rot13", "decodageBinaire", "stockage", "formatage", "affichage", "export"
+};
+
+constexpr const char* PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+    "sources", "valeurs", "octetsLus", "echecsEnumeration", "donneesTropCourtes", "typeInattendu", "versionInconnue",
+    "archives", "octetsArchives"
+};
+
+inline uint64_t PerfNow() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Mesures locales d'une tâche ; désactivé, aucune horloge n'est lue
+struct PerfTally {
+    bool enabled;
+    uint64_t mark = 0;
+    uint64_t ns[PERF_STAGE_COUNT] = {};
+    uint64_t calls[PERF_STAGE_COUNT] = {};
+    uint64_t counters[PERF_COUNTER_COUNT] = {};
+
+    explicit PerfTally(bool enable = true) : enabled(enable) { Start(); }
+
+    void Start() {
+        if (enabled) mark = PerfNow();
+    }
+
+    // Temps écoulé depuis le tour précédent attribué à stage
+    void Lap(PerfStage stage) {
+        if (!enabled) {
+            return;
+        }
+        uint64_t now = PerfNow();
+        ns[stage] += now - mark;
+        calls[stage]++;
+        mark = now;
+    }
+
+    void Count(PerfCounter counter, uint64_t n = 1) { counters[counter] += n; }
+
+    // Classement d'une valeur d'après le statut décodé (DecodeUserAssistCounters ou colonne timeStatus)
+    void CountValue(uint32_t type, uint8_t status) {
+        counters[PERF_VALUES]++;
+        if (status == UA_TIME_INVALID) {
+            counters[type == UA_REG_BINARY ? PERF_SKIPPED_UNDERSIZED : PERF_SKIPPED_TYPE]++;
+        } else if (status == UA_TIME_LEGACY) {
+            counters[PERF_UNKNOWN_VERSION]++;
+        }
+    }
+
+    void CountValue(uint32_t type, const UserAssistCounters& decoded) { CountValue(type, decoded.status); }
+};
+
+// Totaux d'une exécution, alimentés par les tâches (sûr entre threads)
+class PerfCounters {
+    std::atomic<uint64_t> ns[PERF_STAGE_COUNT];
+    std::atomic<uint64_t> calls[PERF_STAGE_COUNT];
+    std::atomic<uint64_t> counters[PERF_COUNTER_COUNT];
+    uint64_t startNs = 0;
+    uint64_t startTime = 0;     // FILETIME UTC
+
+public:
+    PerfCounters() { Reset(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Début d'une exécution (thread appelant, avant les tâches)
+    void Reset() {
+        for (auto& v : ns) v.store(0, std::memory_order_relaxed);
+        for (auto& v : calls) v.store(0, std::memory_order_relaxed);
+        for (auto& v : counters) v.store(0, std::memory_order_relaxed);
+        startNs = PerfNow();
+        startTime = CurrentFileTime();
+    }
+
+    void Add(const PerfTally& tally) {
+        for (size_t i = 0; i < PERF_STAGE_COUNT; i++) {
+            if (tally.calls[i]) {
+                ns[i].fetch_add(tally.ns[i], std::memory_order_relaxed);
+                calls[i].fetch_add(tally.calls[i], std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (tally.counters[i]) {
+                counters[i].fetch_add(tally.counters[i], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    uint64_t Time(PerfStage stage) const { return ns[stage].load(std::memory_order_relaxed); }
+    uint64_t Calls(PerfStage stage) const { return calls[stage].load(std::memory_order_relaxed); }
+    uint64_t Count(PerfCounter counter) const { return counters[counter].load(std::memory_order_relaxed); }
+    uint64_t ElapsedNs() const { return PerfNow() - startNs; }
+    uint64_t StartTime() const { return startTime; }
+
+    static uint64_t CurrentFileTime() {
+        auto since1970 = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return static_cast<uint64_t>(since1970) * 10 + 116444736000000000ull;
+    }
+};
+
+// Pic de mémoire du processus (working set sous Windows, RSS max sous Linux), 0 si indisponible
+inline uint64_t PeakMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc = {};
+    pmc.cb = sizeof(pmc);
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.PeakWorkingSetSize : 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+inline std::wstring PerfHostName() {
+#ifdef _WIN32
+    wchar_t name[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD size = MAX_COMPUTERNAME_LENGTH + 1;
+    return GetComputerNameW(name, &size) ? std::wstring(name, size) : std::wstring();
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return std::wstring();
+    }
+    std::wstring host;
+    AppendLatin1(host, reinterpret_cast<const uint8_t*>(name), std::char_traits<char>::length(name));
+    return host;
+#endif
+}
+
+// Rapport d'une exécution : une ligne JSON par exécution, comparable d'une version et d'un hôte à l'autre
+inline void WritePerfJson(JsonWriter& json, const PerfCounters& perf, std::string_view tool, std::string_view operation,
+                          size_t threads) {
+    uint64_t elapsed = perf.ElapsedNs();
+    double seconds = elapsed / 1e9;
+    uint64_t values = perf.Count(PERF_VALUES);
+    uint64_t bytes = perf.Count(PERF_BYTES_READ);
+
+    json.BeginObject();
+    json.Key("outil");
+    json.String(tool);
+    json.Key("operation");
+    json.String(operation);
+    json.Key("version");
+    json.String(USERASSIST_VERSION);
+    json.Key("hote");
+    json.String(std::wstring_view(PerfHostName()));
+    json.Key("debut");
+    json.Time(perf.StartTime());
+    json.Key("dureeMs");
+    json.Number(elapsed / 1e6);
+    json.Key("threads");
+    json.Number(static_cast<uint64_t>(threads));
+    json.Key("valeursParSeconde");
+    json.Number(seconds > 0 ? values / seconds : 0.0);
+    json.Key("moParSeconde");
+    json.Number(seconds > 0 ? bytes / 1048576.0 / seconds : 0.0);
+    json.Key("memoirePic");
+    json.Number(PeakMemoryBytes());
+
+    // Temps cumulés sur tous les threads (peuvent dépasser la durée murale)
+    json.Key("etapes");
+    json.BeginObject();
+    for (size_t i = 0; i < PERF_STAGE_COUNT; i++) {
+        PerfStage stage = static_cast<PerfStage>(i);
+        json.Key(PERF_STAGE_NAMES[i]);
+        json.BeginObject();
+        json.Key("ms");
+        json.Number(perf.Time(stage) / 1e6);
+        json.Key("appels");
+        json.Number(perf.Calls(stage));
+        json.EndObject();
+    }
+    json.EndObject();
+
+    json.Key("compteurs");
+    json.BeginObject();
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+        json.Key(PERF_COUNTER_NAMES[i]);
+        json.Number(perf.Count(static_cast<PerfCounter>(i)));
+    }
+    json.EndObject();
+    json.EndObject();
+    json.EndDocument();
+}
@@ -0,0 +1,454 @@
+/*
+ * Query - filtre compilé sur les entrées décodées (vue interactive, exports batch)
+ *
+ * Langage : termes séparés par des espaces, tous requis (ET), "-" en tête pour exclure.
+ *   chrome                    sous-chaîne du chemin (casse ignorée), équivaut à chemin:chrome
+ *   chemin:*\cmd.exe          motif glob (* et ?) sur le chemin entier, décodé ou résolu (%SystemRoot%...)
+ *   chemin="C:\Outils\x.exe"  égalité ; guillemets pour les valeurs contenant des espaces
+ *   guid:CEBFF5CD  user:alice sous-chaîne, glob ou égalité (":" / "=" / "!=")
+ *   runs>=10  focus<3         compteurs d'exécution et de focus (=, <, <=, >, >=)
+ *   temps>90                  temps de focus, en secondes par défaut (suffixes ms, s, m, h)
+ *   date>=2024-03-01  date<2024-04-01T12:00Z  date:2024-03-15 (journée entière, UTC)
+ *
+ * Compilation : les bornes numériques d'un même champ sont intersectées en un intervalle,
+ * les motifs textuels sont repliés en minuscules une fois. À l'exécution (Select), les
+ * prédicats textuels sont évalués une fois par chaîne distincte du pool (table par ID), puis
+ * des noyaux sans branchement parcourent les colonnes par lots de QUERY_BATCH_ROWS lignes
+ * (intervalle = une soustraction et une comparaison non signées, texte = une lecture de table).
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "KnownFolders.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t QUERY_BATCH_ROWS = 4096;
+
+enum QueryTextField : uint8_t {
+    QUERY_PATH = 0,
+    QUERY_GUID,
+    QUERY_USER,
+    QUERY_TEXT_FIELDS
+};
+
+// Repli de casse ASCII et Latin-1 (chemins Windows), indépendant de la locale
+inline wchar_t QueryFold(wchar_t c) {
+    if ((c >= L'A' && c <= L'Z') || (c >= 0xC0 && c <= 0xDE && c != 0xD7)) {
+        return static_cast<wchar_t>(c + 32);
+    }
+    return c;
+}
+
+// Motif glob (* = toute suite, ? = un caractère) sur le texte entier ; pattern déjà replié
+inline bool QueryGlobMatch(std::wstring_view pattern, std::wstring_view text) {
+    size_t p = 0, t = 0;
+    size_t star = std::wstring_view::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == L'?' || pattern[p] == QueryFold(text[t]))) {
+            p++;
+            t++;
+        } else if (p < pattern.size() && pattern[p] == L'*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::wstring_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == L'*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+// Sous-chaîne, needle déjà replié : recherche du premier caractère sous ses deux casses, puis vérification
+inline bool QueryContains(std::wstring_view needle, std::wstring_view text) {
+    if (needle.empty()) {
+        return true;
+    }
+    if (needle.size() > text.size()) {
+        return false;
+    }
+    wchar_t lower = needle[0];
+    wchar_t upper = (lower >= L'a' && lower <= L'z') || (lower >= 0xE0 && lower <= 0xFE && lower != 0xF7)
+                  ? static_cast<wchar_t>(lower - 32) : lower;
+    size_t last = text.size() - needle.size();
+    for (size_t i = 0; i <= last; i++) {
+        wchar_t c = text[i];
+        if (c != lower && c != upper) {
+            continue;
+        }
+        size_t j = 1;
+        while (j < needle.size() && needle[j] == QueryFold(text[i + j])) {
+            j++;
+        }
+        if (j == needle.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool QueryEquals(std::wstring_view value, std::wstring_view text) {
+    if (value.size() != text.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        if (value[i] != QueryFold(text[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class Query {
+public:
+    // Intervalle fermé [lo, hi] ; lo > hi = aucune ligne
+    struct Range {
+        uint64_t lo = 0;
+        uint64_t hi = UINT64_MAX;
+        bool active = false;
+
+        void Intersect(uint64_t low, uint64_t high) {
+            if (low > lo) lo = low;
+            if (high < hi) hi = high;
+            active = true;
+        }
+    };
+
+private:
+    enum TextMode : uint8_t { TEXT_CONTAINS, TEXT_GLOB, TEXT_EQUALS };
+
+    struct TextTerm {
+        std::wstring pattern;   // Replié
+        TextMode mode;
+        bool negate;
+
+        bool Matches(std::wstring_view text) const {
+            bool hit = mode == TEXT_CONTAINS ? QueryContains(pattern, text)
+                     : mode == TEXT_GLOB ? QueryGlobMatch(pattern, text)
+                     : QueryEquals(pattern, text);
+            return hit != negate;
+        }
+    };
+
+    std::vector<TextTerm> terms[QUERY_TEXT_FIELDS];
+    Range runs, focus, focusTime, time;
+    size_t termCount = 0;
+
+    static bool IsField(std::wstring_view name) {
+        for (std::wstring_view field : { L"chemin", L"path", L"guid", L"user", L"utilisateur", L"runs", L"focus",
+                                         L"temps", L"date" }) {
+            if (QueryEquals(field, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool ParseNumber(std::wstring_view text, uint64_t& value) {
+        if (text.empty() || text.size() > 19) {
+            return false;
+        }
+        value = 0;
+        for (wchar_t c : text) {
+            if (c < L'0' || c > L'9') {
+                return false;
+            }
+            value = value * 10 + static_cast<uint64_t>(c - L'0');
+        }
+        return true;
+    }
+
+    // Durée en millisecondes : nombre suivi de ms, s (défaut), m ou h
+    static bool ParseDuration(std::wstring_view text, uint64_t& ms) {
+        uint64_t unit = 1000;
+        if (text.size() > 2 && text.substr(text.size() - 2) == L"ms") {
+            unit = 1;
+            text.remove_suffix(2);
+        } else if (!text.empty() && (text.back() == L's' || text.back() == L'm' || text.back() == L'h')) {
+            unit = text.back() == L's' ? 1000 : text.back() == L'm' ? 60000 : 3600000;
+            text.remove_suffix(1);
+        }
+        uint64_t value;
+        if (!ParseNumber(text, value) || value > UINT64_MAX / unit) {
+            return false;
+        }
+        ms = value * unit;
+        return true;
+    }
+
+    // Opérateur de comparaison → intervalle ; "!=" impossible sur un intervalle unique
+    static bool ApplyComparison(Range& range, std::wstring_view op, uint64_t value, uint64_t width, bool negate) {
+        uint64_t last = value + width - 1;      // Fin de la valeur (journée entière pour une date seule)
+        if (negate) {
+            if (op == L">") op = L"<=";
+            else if (op == L">=") op = L"<";
+            else if (op == L"<") op = L">=";
+            else if (op == L"<=") op = L">";
+            else return false;
+        }
+        if (op == L"=" || op == L":") range.Intersect(value, last);
+        else if (op == L">") range.Intersect(last == UINT64_MAX ? UINT64_MAX : last + 1, UINT64_MAX);
+        else if (op == L">=") range.Intersect(value, UINT64_MAX);
+        else if (op == L"<") {
+            if (value == 0) range.Intersect(1, 0);
+            else range.Intersect(0, value - 1);
+        }
+        else if (op == L"<=") range.Intersect(0, last);
+        else return false;
+        return true;
+    }
+
+    bool AddTerm(std::wstring_view field, std::wstring_view op, const std::wstring& value, bool negate,
+                 std::wstring& error) {
+        if (field.empty() || field == L"chemin" || field == L"path" || field == L"guid" || field == L"user" ||
+            field == L"utilisateur") {
+            QueryTextField target = field == L"guid" ? QUERY_GUID
+                                  : (field == L"user" || field == L"utilisateur") ? QUERY_USER : QUERY_PATH;
+            if (op != L":" && op != L"=" && op != L"!=") {
+                error = L"opérateur " + std::wstring(op) + L" impossible sur un champ texte";
+                return false;
+            }
+            TextTerm term;
+            term.pattern.reserve(value.size());
+            for (wchar_t c : value) term.pattern.push_back(QueryFold(c));
+            bool glob = value.find_first_of(L"*?") != std::wstring::npos;
+            term.mode = glob ? TEXT_GLOB : op == L":" ? TEXT_CONTAINS : TEXT_EQUALS;
+            term.negate = negate != (op == L"!=");
+            terms[target].push_back(std::move(term));
+            return true;
+        }
+
+        uint64_t number = 0, width = 1;
+        Range* range;
+        if (field == L"runs" || field == L"focus") {
+            range = field == L"runs" ? &runs : &focus;
+            if (!ParseNumber(value, number) || number > UINT32_MAX) {
+                error = L"nombre invalide : " + value;
+                return false;
+            }
+        } else if (field == L"temps") {
+            range = &focusTime;
+            if (!ParseDuration(value, number) || number > UINT32_MAX) {
+                error = L"durée invalide : " + value;
+                return false;
+            }
+        } else if (field == L"date") {
+            range = &time;
+            if (!ParseIso8601(value.c_str(), number)) {
+                error = L"date invalide : " + value;
+                return false;
+            }
+            if (value.size() == 10) {
+                width = 86400 * FILETIME_TICKS_PER_SECOND;      // Date seule : la journée entière
+            }
+        } else {
+            error = L"champ inconnu : " + std::wstring(field);
+            return false;
+        }
+        if (!ApplyComparison(*range, op, number, width, negate)) {
+            error = L"opérateur " + std::wstring(op) + L" impossible" + (negate ? L" avec une exclusion" : L"") +
+                    L" sur " + std::wstring(field);
+            return false;
+        }
+        return true;
+    }
+
+    // État par ID du pool : 0 = non évalué, 1 = rejeté, 2 = accepté
+    void EvaluateStrings(const EntryStore& store, QueryTextField field, const std::vector<uint32_t>& ids,
+                         std::vector<uint8_t>& state) const {
+        state.assign(store.strings.size(), 0);
+        std::wstring resolved;
+        for (uint32_t id : ids) {
+            if (state[id]) {
+                continue;
+            }
+            std::wstring_view text = store.strings.Get(id);
+            bool ok = true;
+            if (field == QUERY_PATH) {
+                // Chemin décodé ou résolu ({GUID}\ → %ProgramFiles%\...), résolu seulement si utile
+                uint8_t folder = FindKnownFolder(text);
+                bool haveResolved = false;
+                for (size_t i = 0; ok && i < terms[field].size(); i++) {
+                    const TextTerm& term = terms[field][i];
+                    ok = term.Matches(text);
+                    // Inclusion : l'une des deux formes suffit ; exclusion : aucune ne doit correspondre
+                    if (folder && ok == term.negate) {
+                        if (!haveResolved) {
+                            ResolvedPath path = ResolveKnownFolder(text, folder);
+                            resolved.assign(path.folder);
+                            resolved.append(path.rest);
+                            haveResolved = true;
+                        }
+                        ok = term.Matches(resolved);
+                    }
+                }
+            } else {
+                for (size_t i = 0; ok && i < terms[field].size(); i++) {
+                    ok = terms[field][i].Matches(text);
+                }
+            }
+            state[id] = ok ? 2 : 1;
+        }
+    }
+
+    // Noyaux : sel[i] &= prédicat(ligne first + i), sans branchement
+    static void RangeKernel(const uint32_t* values, size_t count, const Range& range, uint8_t* sel) {
+        uint32_t lo = static_cast<uint32_t>(range.lo);
+        uint32_t span = static_cast<uint32_t>((range.hi > UINT32_MAX ? UINT32_MAX : range.hi) - range.lo);
+        for (size_t i = 0; i < count; i++) {
+            sel[i] &= static_cast<uint8_t>(static_cast<uint32_t>(values[i] - lo) <= span);
+        }
+    }
+
+    static void TimeKernel(const uint64_t* values, const uint8_t* status, size_t count, const Range& range,
+                           uint8_t* sel) {
+        uint64_t span = range.hi - range.lo;
+        for (size_t i = 0; i < count; i++) {
+            sel[i] &= static_cast<uint8_t>((values[i] - range.lo <= span) & (status[i] == UA_TIME_VALID));
+        }
+    }
+
+    static void IdKernel(const uint32_t* ids, size_t count, const uint8_t* state, uint8_t* sel) {
+        for (size_t i = 0; i < count; i++) {
+            sel[i] &= static_cast<uint8_t>(state[ids[i]] >> 1);
+        }
+    }
+
+public:
+    // Compile le texte de la requête ; vide = tout accepter. error décrit le premier terme rejeté.
+    bool Parse(std::wstring_view text, std::wstring& error) {
+        *this = Query();
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && (text[i] == L' ' || text[i] == L'\t')) i++;
+            if (i == text.size()) {
+                break;
+            }
+
+            bool negate = false;
+            if (text[i] == L'-' && i + 1 < text.size() && text[i + 1] != L' ') {
+                negate = true;
+                i++;
+            }
+
+            // Champ connu suivi d'un opérateur, sinon terme nu sur le chemin (C:\... reste un chemin)
+            size_t fieldEnd = i;
+            while (fieldEnd < text.size() && ((text[fieldEnd] >= L'a' && text[fieldEnd] <= L'z') ||
+                                              (text[fieldEnd] >= L'A' && text[fieldEnd] <= L'Z'))) {
+                fieldEnd++;
+            }
+            std::wstring field;
+            std::wstring_view op;
+            size_t opEnd = fieldEnd;
+            if (fieldEnd > i && fieldEnd < text.size() && IsField(text.substr(i, fieldEnd - i))) {
+                std::wstring_view rest = text.substr(fieldEnd);
+                for (std::wstring_view candidate : { L">=", L"<=", L"!=", L":", L"=", L">", L"<" }) {
+                    if (rest.substr(0, candidate.size()) == candidate) {
+                        op = candidate;
+                        break;
+                    }
+                }
+            }
+            if (!op.empty()) {
+                for (size_t k = i; k < fieldEnd; k++) field.push_back(QueryFold(text[k]));
+                opEnd = fieldEnd + op.size();
+            } else {
+                op = L":";
+                opEnd = i;
+            }
+
+            // Valeur : guillemets ou jusqu'au prochain espace
+            std::wstring value;
+            size_t k = opEnd;
+            if (k < text.size() && text[k] == L'"') {
+                size_t close = text.find(L'"', k + 1);
+                if (close == std::wstring_view::npos) {
+                    error = L"guillemet non fermé";
+                    return false;
+                }
+                value.assign(text.substr(k + 1, close - k - 1));
+                k = close + 1;
+            } else {
+                while (k < text.size() && text[k] != L' ' && text[k] != L'\t') k++;
+                value.assign(text.substr(opEnd, k - opEnd));
+            }
+            if (value.empty()) {
+                error = L"valeur manquante après " + std::wstring(text.substr(i, opEnd - i));
+                return false;
+            }
+            if (!AddTerm(field, op, value, negate, error)) {
+                return false;
+            }
+            termCount++;
+            i = k;
+        }
+        return true;
+    }
+
+    bool empty() const { return termCount == 0; }
+    size_t TermCount() const { return termCount; }
+
+    // Lignes acceptées (croissantes) ; renvoie leur nombre
+    size_t Select(const EntryStore& store, std::vector<uint32_t>& rows) const {
+        rows.clear();
+        size_t total = store.size();
+        // Intervalle vide, ou borne basse au-delà des compteurs 32 bits
+        for (const Range* range : { &runs, &focus, &focusTime }) {
+            if (range->lo > range->hi || range->lo > UINT32_MAX) {
+                return 0;
+            }
+        }
+        if (time.lo > time.hi) {
+            return 0;
+        }
+
+        const std::vector<uint32_t>* columns[QUERY_TEXT_FIELDS] = { &store.pathId, &store.guidId, &store.userId };
+        std::vector<uint8_t> state[QUERY_TEXT_FIELDS];
+        for (size_t f = 0; f < QUERY_TEXT_FIELDS; f++) {
+            if (!terms[f].empty()) {
+                EvaluateStrings(store, static_cast<QueryTextField>(f), *columns[f], state[f]);
+            }
+        }
+
+        uint8_t sel[QUERY_BATCH_ROWS];
+        for (size_t first = 0; first < total; first += QUERY_BATCH_ROWS) {
+            size_t count = total - first < QUERY_BATCH_ROWS ? total - first : QUERY_BATCH_ROWS;
+            std::memset(sel, 1, count);
+            for (size_t f = 0; f < QUERY_TEXT_FIELDS; f++) {
+                if (!state[f].empty()) {
+                    IdKernel(columns[f]->data() + first, count, state[f].data(), sel);
+                }
+            }
+            if (runs.active) RangeKernel(store.runCount.data() + first, count, runs, sel);
+            if (focus.active) RangeKernel(store.focusCount.data() + first, count, focus, sel);
+            if (focusTime.active) RangeKernel(store.focusTime.data() + first, count, focusTime, sel);
+            if (time.active) {
+                TimeKernel(store.lastExecution.data() + first, store.timeStatus.data() + first, count, time, sel);
+            }
+
+            // Compactage sans branchement : l'indice est toujours écrit, avancé seulement si accepté
+            size_t base = rows.size();
+            rows.resize(base + count);
+            uint32_t* out = rows.data() + base;
+            size_t n = 0;
+            for (size_t i = 0; i < count; i++) {
+                out[n] = static_cast<uint32_t>(first + i);
+                n += sel[i];
+            }
+            rows.resize(base + n);
+        }
+        return rows.size();
+    }
+};
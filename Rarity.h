@@ -0,0 +1,419 @@
+/*
+ * Rarity - analyse de rareté (least frequency of occurrence) des chemins décodés sur un parc
+ * Pour chaque chemin : nombre d'hôtes (hives ou utilisateurs) sur lesquels il apparaît ;
+ * sont rares les chemins présents sur au plus maxHosts hôtes.
+ *
+ * - Comptage exact : chemins internés (StringPool), compteur d'hôtes par hachage 64 bits
+ * - Au-delà du budget mémoire : bascule en comptage approché, count-min sketch (mise à jour
+ *   conservatrice, surestimation seule : un chemin déclaré rare l'est réellement) et
+ *   candidats rares bornés ; HyperLogLog pour le nombre de chemins distincts
+ * - Un moteur par shard (les lignes d'un hôte restent dans un même shard), fusion en fin de
+ *   passe : une seule passe en flux, sans conserver les lignes
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct RarityOptions {
+    uint32_t maxHosts = 5;                      // Rare : présent sur au plus maxHosts hôtes
+    size_t memoryBudget = 256u << 20;           // Octets (exact, puis sketch) par moteur
+    size_t candidateLimit = 100000;             // Chemins rares suivis en mode approché
+    size_t reportLimit = 1000;                  // Chemins listés dans le rapport JSON
+};
+
+// Finaliseur 64 bits (splitmix64) : bits bien répartis pour les sketches
+inline uint64_t RarityMix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+inline uint64_t RarityHash(std::wstring_view path) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (wchar_t ch : path) {
+        h ^= static_cast<uint32_t>(ch);
+        h *= 0x100000001b3ull;
+    }
+    return RarityMix(h);
+}
+
+// Count-min sketch : RARITY_SKETCH_DEPTH lignes de compteurs 32 bits, largeur puissance de 2
+constexpr size_t RARITY_SKETCH_DEPTH = 4;
+
+class CountMinSketch {
+    std::vector<uint32_t> counters;     // depth * width
+    size_t mask = 0;
+
+    size_t Index(size_t row, uint64_t hash) const {
+        // Double hachage (Kirsch-Mitzenmacher) depuis les deux moitiés du hachage
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        return row * (mask + 1) + ((h1 + row * h2) & mask);
+    }
+
+public:
+    bool empty() const { return counters.empty(); }
+
+    // Plus grande largeur qui tient dans bytes
+    void Init(size_t bytes) {
+        size_t width = 1024;
+        while (width * 2 * RARITY_SKETCH_DEPTH * sizeof(uint32_t) <= bytes) {
+            width *= 2;
+        }
+        counters.assign(width * RARITY_SKETCH_DEPTH, 0);
+        mask = width - 1;
+    }
+
+    size_t Width() const { return mask + 1; }
+
+    uint32_t Estimate(uint64_t hash) const {
+        uint32_t estimate = UINT32_MAX;
+        for (size_t row = 0; row < RARITY_SKETCH_DEPTH; row++) {
+            estimate = std::min(estimate, counters[Index(row, hash)]);
+        }
+        return estimate;
+    }
+
+    // Mise à jour conservatrice : seuls les compteurs sous la nouvelle estimation montent
+    uint32_t Add(uint64_t hash, uint32_t count) {
+        uint32_t target = Estimate(hash);
+        target = target > UINT32_MAX - count ? UINT32_MAX : target + count;
+        for (size_t row = 0; row < RARITY_SKETCH_DEPTH; row++) {
+            uint32_t& counter = counters[Index(row, hash)];
+            counter = std::max(counter, target);
+        }
+        return target;
+    }
+
+    // Somme des compteurs : reste un majorant. Largeurs différentes : la plus large est repliée
+    // (l'index d'une largeur plus petite ne garde que les bits de poids faible)
+    void Merge(const CountMinSketch& other) {
+        if (other.empty()) {
+            return;
+        }
+        if (empty() || other.Width() < Width()) {
+            Fold(other.Width());
+        }
+        size_t width = Width(), otherWidth = other.Width();
+        for (size_t row = 0; row < RARITY_SKETCH_DEPTH; row++) {
+            for (size_t i = 0; i < otherWidth; i++) {
+                uint32_t& counter = counters[row * width + (i & mask)];
+                uint64_t sum = static_cast<uint64_t>(counter) + other.counters[row * otherWidth + i];
+                counter = sum > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(sum);
+            }
+        }
+    }
+
+    // Réduit la largeur (puissance de 2) en sommant les compteurs repliés
+    void Fold(size_t width) {
+        std::vector<uint32_t> folded(width * RARITY_SKETCH_DEPTH, 0);
+        size_t oldWidth = counters.empty() ? 0 : Width();
+        for (size_t row = 0; row < RARITY_SKETCH_DEPTH; row++) {
+            for (size_t i = 0; i < oldWidth; i++) {
+                uint32_t& counter = folded[row * width + (i & (width - 1))];
+                uint64_t sum = static_cast<uint64_t>(counter) + counters[row * oldWidth + i];
+                counter = sum > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(sum);
+            }
+        }
+        counters.swap(folded);
+        mask = width - 1;
+    }
+
+    size_t MemoryUsage() const { return counters.capacity() * sizeof(uint32_t); }
+};
+
+// HyperLogLog 2^14 registres (erreur type ~0,8 %)
+class HyperLogLog {
+    static constexpr unsigned PRECISION = 14;
+    std::vector<uint8_t> registers = std::vector<uint8_t>(size_t(1) << PRECISION, 0);
+
+public:
+    void Add(uint64_t hash) {
+        size_t index = static_cast<size_t>(hash >> (64 - PRECISION));
+        uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+        uint8_t rank = 1;
+        while (!(rest & 0x8000000000000000ull)) {
+            rest <<= 1;
+            rank++;
+        }
+        registers[index] = std::max(registers[index], rank);
+    }
+
+    void Merge(const HyperLogLog& other) {
+        for (size_t i = 0; i < registers.size(); i++) {
+            registers[i] = std::max(registers[i], other.registers[i]);
+        }
+    }
+
+    uint64_t Estimate() const {
+        double m = static_cast<double>(registers.size());
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t r : registers) {
+            sum += std::ldexp(1.0, -static_cast<int>(r));
+            zeros += r == 0;
+        }
+        double estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+        if (estimate <= 2.5 * m && zeros > 0) {
+            estimate = m * std::log(m / static_cast<double>(zeros));     // Correction petits effectifs
+        }
+        return static_cast<uint64_t>(estimate + 0.5);
+    }
+};
+
+struct RarePath {
+    std::wstring path;
+    uint32_t hosts = 0;
+    bool exact = true;      // Faux : majorant du count-min sketch
+};
+
+class RarityEngine {
+    struct Counter {
+        uint32_t pathId;
+        uint32_t hosts;
+        uint64_t lastHost;  // Dernier hôte compté (déduplication dans un hôte)
+    };
+
+    RarityOptions options;
+    StringPool paths;
+    std::unordered_map<uint64_t, Counter> exact;
+    bool approximate = false;
+    CountMinSketch sketch;
+    std::unordered_map<uint64_t, std::wstring> candidates;
+    std::unordered_set<uint64_t> hostPaths;     // Chemins déjà comptés pour l'hôte courant (mode approché)
+    HyperLogLog distinct;
+
+    uint64_t hosts = 0;
+    uint64_t rows = 0;
+    uint64_t droppedCandidates = 0;
+    uint64_t lastUser = UINT64_MAX;
+
+    static constexpr size_t EXACT_ENTRY_BYTES = 64;     // Nœud de table + compteur (estimation)
+
+    size_t ExactMemory() const {
+        return paths.MemoryUsage() + exact.size() * EXACT_ENTRY_BYTES + exact.bucket_count() * sizeof(void*);
+    }
+
+    // Chemin rare en mode approché : suivi tant que son estimation reste sous le seuil
+    void TrackCandidate(uint64_t hash, uint32_t estimate, std::wstring_view path) {
+        if (estimate > options.maxHosts) {
+            candidates.erase(hash);
+        } else if (!candidates.count(hash)) {
+            if (candidates.size() < options.candidateLimit) {
+                candidates.emplace(hash, std::wstring(path));
+            } else {
+                droppedCandidates++;
+            }
+        }
+    }
+
+    // Bascule exact -> approché : les compteurs exacts alimentent le sketch
+    void Spill() {
+        approximate = true;
+        sketch.Init(options.memoryBudget / 2);
+        hostPaths.clear();
+        for (const auto& item : exact) {
+            uint32_t estimate = sketch.Add(item.first, item.second.hosts);
+            TrackCandidate(item.first, estimate, paths.Get(item.second.pathId));
+            if (item.second.lastHost == hosts) {
+                hostPaths.insert(item.first);
+            }
+        }
+        exact = std::unordered_map<uint64_t, Counter>();
+        paths.Clear();
+    }
+
+    void PruneCandidates() {
+        for (auto it = candidates.begin(); it != candidates.end();) {
+            it = sketch.Estimate(it->first) > options.maxHosts ? candidates.erase(it) : std::next(it);
+        }
+    }
+
+public:
+    explicit RarityEngine(const RarityOptions& opts = RarityOptions()) : options(opts) {}
+
+    const RarityOptions& Options() const { return options; }
+    uint64_t Hosts() const { return hosts; }
+    uint64_t Rows() const { return rows; }
+    bool Approximate() const { return approximate; }
+    uint64_t DroppedCandidates() const { return droppedCandidates; }
+
+    // Nombre de chemins distincts (exact, sinon estimation HyperLogLog)
+    uint64_t DistinctPaths() const { return approximate ? distinct.Estimate() : exact.size(); }
+
+    size_t MemoryUsage() const {
+        size_t candidateBytes = 0;
+        for (const auto& item : candidates) {
+            candidateBytes += EXACT_ENTRY_BYTES + item.second.capacity() * sizeof(wchar_t);
+        }
+        return ExactMemory() + sketch.MemoryUsage() + candidateBytes + hostPaths.size() * 32;
+    }
+
+    // Nouvel hôte : ses chemins sont comptés une fois chacun
+    void BeginHost() {
+        hosts++;
+        hostPaths.clear();
+    }
+
+    void AddPath(std::wstring_view path) {
+        rows++;
+        uint64_t hash = RarityHash(path);
+        distinct.Add(hash);
+
+        if (approximate) {
+            if (hostPaths.insert(hash).second) {
+                TrackCandidate(hash, sketch.Add(hash, 1), path);
+            }
+            return;
+        }
+
+        auto it = exact.find(hash);
+        if (it == exact.end()) {
+            exact.emplace(hash, Counter{ paths.Intern(path), 1, hosts });
+            if (ExactMemory() > options.memoryBudget / 2) {
+                Spill();
+            }
+        } else if (it->second.lastHost != hosts) {
+            it->second.lastHost = hosts;
+            it->second.hosts++;
+        }
+    }
+
+    // Lignes [first, last) d'un store : un changement d'utilisateur ouvre un nouvel hôte
+    // (les lignes d'un utilisateur doivent être contiguës, comme en sortie de scan)
+    void Add(const EntryStore& store, size_t first, size_t last) {
+        for (size_t row = first; row < last; row++) {
+            if (store.userId[row] != lastUser) {
+                lastUser = store.userId[row];
+                BeginHost();
+            }
+            AddPath(store.DecodedPath(row));
+        }
+        lastUser = UINT64_MAX;
+    }
+
+    void Add(const EntryStore& store) { Add(store, 0, store.size()); }
+
+    // Fusion d'un moteur partiel (hôtes disjoints)
+    void Merge(const RarityEngine& other) {
+        hosts += other.hosts;
+        rows += other.rows;
+        droppedCandidates += other.droppedCandidates;
+        distinct.Merge(other.distinct);
+
+        if (!approximate && !other.approximate) {
+            for (const auto& item : other.exact) {
+                auto it = exact.find(item.first);
+                if (it == exact.end()) {
+                    std::wstring_view path = other.paths.Get(item.second.pathId);
+                    exact.emplace(item.first, Counter{ paths.Intern(path), item.second.hosts, 0 });
+                } else {
+                    it->second.hosts += item.second.hosts;
+                    it->second.lastHost = 0;
+                }
+            }
+            if (ExactMemory() > options.memoryBudget / 2) {
+                Spill();
+            }
+            return;
+        }
+
+        if (!approximate) {
+            Spill();
+        }
+        if (other.approximate) {
+            sketch.Merge(other.sketch);
+            for (const auto& item : other.candidates) {
+                if (candidates.size() < options.candidateLimit) {
+                    candidates.emplace(item.first, item.second);
+                } else if (!candidates.count(item.first)) {
+                    droppedCandidates++;
+                }
+            }
+        } else {
+            for (const auto& item : other.exact) {
+                uint32_t estimate = sketch.Add(item.first, item.second.hosts);
+                TrackCandidate(item.first, estimate, other.paths.Get(item.second.pathId));
+            }
+        }
+        PruneCandidates();
+        hostPaths.clear();
+    }
+
+    // Chemins rares, du plus rare au moins rare puis par chemin
+    std::vector<RarePath> Rare() const {
+        std::vector<RarePath> result;
+        if (approximate) {
+            for (const auto& item : candidates) {
+                uint32_t estimate = sketch.Estimate(item.first);
+                if (estimate <= options.maxHosts) {
+                    result.push_back(RarePath{ item.second, estimate, false });
+                }
+            }
+        } else {
+            for (const auto& item : exact) {
+                if (item.second.hosts <= options.maxHosts) {
+                    std::wstring_view path = paths.Get(item.second.pathId);
+                    result.push_back(RarePath{ std::wstring(path), item.second.hosts, true });
+                }
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const RarePath& a, const RarePath& b) {
+            return a.hosts != b.hosts ? a.hosts < b.hosts : a.path < b.path;
+        });
+        return result;
+    }
+};
+
+// Rapport JSON : résumé puis chemins rares (au plus reportLimit)
+inline void WriteRarityJson(JsonWriter& json, const RarityEngine& engine) {
+    std::vector<RarePath> rare = engine.Rare();
+    const RarityOptions& options = engine.Options();
+
+    json.BeginObject();
+    json.Key("hotes");
+    json.Number(engine.Hosts());
+    json.Key("entrees");
+    json.Number(engine.Rows());
+    json.Key("cheminsDistincts");
+    json.Number(engine.DistinctPaths());
+    json.Key("mode");
+    json.String(std::string_view(engine.Approximate() ? "approche" : "exact"));
+    json.Key("seuilHotes");
+    json.Number(static_cast<uint64_t>(options.maxHosts));
+    json.Key("candidatsIgnores");
+    json.Number(engine.DroppedCandidates());
+    json.Key("cheminsRares");
+    json.Number(static_cast<uint64_t>(rare.size()));
+    json.Key("rares");
+    json.BeginArray();
+    for (size_t i = 0; i < rare.size() && i < options.reportLimit; i++) {
+        json.BeginObject();
+        json.Key("chemin");
+        json.String(std::wstring_view(rare[i].path));
+        json.Key("hotes");
+        json.Number(static_cast<uint64_t>(rare[i].hosts));
+        json.Key("exact");
+        json.Bool(rare[i].exact);
+        json.EndObject();
+    }
+    json.EndArray();
+    json.EndObject();
+    json.EndDocument();
+}
@@ -0,0 +1,369 @@
+/*
+ * ResultCache - cache persistant des résultats d'un scan, relu par mapping mémoire
+ * Réouverture en temps quasi constant : en-tête validé, sections localisées par calcul,
+ * lignes et chaînes lues en place à la demande (aucune désérialisation).
+ *
+ * Disposition (little-endian, sections alignées sur 8 octets) :
+ *   en-tête 64 octets : "UACH" | version u16 | réservé u16 | nb lignes u64 | nb chaînes u64 |
+ *                       hachage de la source u64 | date de création u64 (FILETIME) |
+ *                       unités UTF-16 des chaînes u64 | entrées de l'index temporel u64 |
+ *                       FNV-1a u32 des 56 premiers octets | réservé u32
+ *   offsets des chaînes : u32[nb chaînes + 1] (en unités UTF-16)
+ *   chaînes : UTF-16LE, chacune terminée par un zéro (vue LPCWSTR directe sous Windows)
+ *   lignes : 40 octets - chemin u32, GUID u32, utilisateur u32, runCount u32, focusCount u32,
+ *            focusTime u32, lastExecution u64, état u8, dossier connu u8, 6 octets nuls
+ *   index temporel : FILETIME u64[n] croissants puis lignes u32[n]
+ *   FNV-1a u32 du corps (vérifié par Verify(), pas à l'ouverture)
+ *
+ * Invalidation : hachage du contenu de la hive source (0 = registre live, sans invalidation).
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+constexpr uint32_t RESULT_CACHE_MAGIC = 0x48434155;     // "UACH"
+constexpr uint16_t RESULT_CACHE_VERSION = 2;         // 2 : compteurs des dispositions XP et Windows 7+ corrigés
+constexpr size_t RESULT_CACHE_HEADER_SIZE = 64;
+constexpr size_t RESULT_CACHE_ROW_SIZE = 40;
+
+// Hachage 64 bits du contenu d'une hive (8 octets par tour, plusieurs Go/s)
+inline uint64_t HashContent(const uint8_t* data, size_t size) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        h = (h ^ ReadLE64(data + i)) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    for (; i < size; i++) {
+        h = (h ^ data[i]) * 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 33);
+}
+
+inline bool HashFileContent(const std::filesystem::path& path, uint64_t& hash) {
+    MappedFile file;
+    if (!file.Open(path.c_str())) {
+        return false;
+    }
+    hash = HashContent(file.data(), file.size());
+    return true;
+}
+
+inline size_t ResultCacheAlign(size_t offset) { return (offset + 7) & ~size_t(7); }
+
+// Position des sections, déduite des compteurs de l'en-tête
+struct ResultCacheLayout {
+    size_t offsets = RESULT_CACHE_HEADER_SIZE;
+    size_t strings = 0;
+    size_t rows = 0;
+    size_t timeKeys = 0;
+    size_t timeRows = 0;
+    size_t checksum = 0;
+    size_t total = 0;
+
+    // Faux si les compteurs ne tiennent pas dans limit octets
+    bool Compute(uint64_t rowCount, uint64_t stringCount, uint64_t units, uint64_t timeCount, uint64_t limit) {
+        if (rowCount > limit / RESULT_CACHE_ROW_SIZE || stringCount >= limit / 4 || units > limit / 2 ||
+            timeCount > limit / 12) {
+            return false;
+        }
+        strings = ResultCacheAlign(offsets + (static_cast<size_t>(stringCount) + 1) * 4);
+        rows = ResultCacheAlign(strings + static_cast<size_t>(units) * 2);
+        timeKeys = rows + static_cast<size_t>(rowCount) * RESULT_CACHE_ROW_SIZE;
+        timeRows = timeKeys + static_cast<size_t>(timeCount) * 8;
+        checksum = ResultCacheAlign(timeRows + static_cast<size_t>(timeCount) * 4);
+        total = checksum + 8;
+        return total <= limit;
+    }
+};
+
+// Écriture d'un store (fichier temporaire puis renommage, comme les instantanés)
+inline bool WriteResultCache(const std::filesystem::path& path, const EntryStore& store, uint64_t sourceHash,
+                             uint64_t createdTime) {
+    // Chaînes du pool en UTF-16, IDs conservés
+    std::vector<uint32_t> offsets;
+    std::u16string units;
+    offsets.reserve(store.strings.size() + 1);
+    for (size_t id = 0; id < store.strings.size(); id++) {
+        offsets.push_back(static_cast<uint32_t>(units.size()));
+        for (wchar_t ch : store.strings.Get(static_cast<uint32_t>(id))) {
+            uint32_t c = static_cast<uint32_t>(ch);
+            if (c > 0xFFFF) {
+                c -= 0x10000;
+                units.push_back(static_cast<char16_t>(0xD800 + (c >> 10)));
+                units.push_back(static_cast<char16_t>(0xDC00 + (c & 0x3FF)));
+            } else {
+                units.push_back(static_cast<char16_t>(c));
+            }
+        }
+        units.push_back(u'\0');
+    }
+    offsets.push_back(static_cast<uint32_t>(units.size()));
+
+    EntryStore::TimeRange timeline = store.Timeline();
+    ResultCacheLayout layout;
+    layout.Compute(store.size(), store.strings.size(), units.size(), timeline.size(), UINT64_MAX);
+
+    std::string bytes(layout.total, '\0');
+    auto put = [&bytes](size_t offset, uint64_t v, int width) {
+        for (int i = 0; i < width; i++) bytes[offset + i] = static_cast<char>(v >> (8 * i));
+    };
+    put(0, RESULT_CACHE_MAGIC, 4);
+    put(4, RESULT_CACHE_VERSION, 2);
+    put(8, store.size(), 8);
+    put(16, store.strings.size(), 8);
+    put(24, sourceHash, 8);
+    put(32, createdTime, 8);
+    put(40, units.size(), 8);
+    put(48, timeline.size(), 8);
+    put(56, Fnv1a32(reinterpret_cast<const uint8_t*>(bytes.data()), 56), 4);
+
+    for (size_t i = 0; i < offsets.size(); i++) {
+        put(layout.offsets + i * 4, offsets[i], 4);
+    }
+    for (size_t i = 0; i < units.size(); i++) {
+        put(layout.strings + i * 2, units[i], 2);
+    }
+    for (size_t row = 0; row < store.size(); row++) {
+        size_t p = layout.rows + row * RESULT_CACHE_ROW_SIZE;
+        put(p, store.pathId[row], 4);
+        put(p + 4, store.guidId[row], 4);
+        put(p + 8, store.userId[row], 4);
+        put(p + 12, store.runCount[row], 4);
+        put(p + 16, store.focusCount[row], 4);
+        put(p + 20, store.focusTime[row], 4);
+        put(p + 24, store.lastExecution[row], 8);
+        put(p + 32, store.timeStatus[row], 1);
+        put(p + 33, store.knownFolder[row], 1);
+    }
+    size_t i = 0;
+    for (uint32_t row : timeline) {
+        put(layout.timeKeys + i * 8, store.lastExecution[row], 8);
+        put(layout.timeRows + i * 4, row, 4);
+        i++;
+    }
+    put(layout.checksum, Fnv1a32(reinterpret_cast<const uint8_t*>(bytes.data()) + RESULT_CACHE_HEADER_SIZE,
+                                 layout.checksum - RESULT_CACHE_HEADER_SIZE), 4);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    {
+        FileSink file;
+        if (!file.Open(temp.c_str()) || !file.Write(bytes.data(), bytes.size())) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Lecture en place d'un cache mappé ; valide tant que l'objet est ouvert
+class ResultCache {
+    MappedFile file;
+    ResultCacheLayout layout;
+    const uint8_t* base = nullptr;
+    uint64_t rowCount = 0;
+    uint64_t stringCount = 0;
+    uint64_t unitCount = 0;
+    uint64_t timeCount = 0;
+    uint64_t sourceHash = 0;
+    uint64_t createdTime = 0;
+
+    const uint8_t* RowData(size_t row) const { return base + layout.rows + row * RESULT_CACHE_ROW_SIZE; }
+
+public:
+    struct Row {
+        uint32_t pathId;
+        uint32_t guidId;
+        uint32_t userId;
+        uint8_t knownFolder;
+        UserAssistCounters counters;
+    };
+
+    // Vérifie l'en-tête et la taille des sections (pas le contenu : voir Verify)
+    bool Open(const std::filesystem::path& path, std::string& error) {
+        Close();
+        if (!file.Open(path.c_str())) {
+            error = "ouverture impossible";
+            return false;
+        }
+        const uint8_t* data = file.data();
+        if (file.size() < RESULT_CACHE_HEADER_SIZE || ReadLE32(data) != RESULT_CACHE_MAGIC) {
+            error = "format de cache invalide";
+            file.Close();
+            return false;
+        }
+        if (ReadLE16(data + 4) != RESULT_CACHE_VERSION) {
+            error = "version de cache non prise en charge";
+            file.Close();
+            return false;
+        }
+        if (Fnv1a32(data, 56) != ReadLE32(data + 56)) {
+            error = "en-tête corrompu";
+            file.Close();
+            return false;
+        }
+        rowCount = ReadLE64(data + 8);
+        stringCount = ReadLE64(data + 16);
+        sourceHash = ReadLE64(data + 24);
+        createdTime = ReadLE64(data + 32);
+        unitCount = ReadLE64(data + 40);
+        timeCount = ReadLE64(data + 48);
+        if (!layout.Compute(rowCount, stringCount, unitCount, timeCount, file.size()) ||
+            layout.total != file.size() || timeCount > rowCount) {
+            error = "cache tronqué";
+            file.Close();
+            return false;
+        }
+        base = data;
+        return true;
+    }
+
+    void Close() {
+        file.Close();
+        base = nullptr;
+        rowCount = stringCount = unitCount = timeCount = 0;
+    }
+
+    bool is_open() const { return base != nullptr; }
+    size_t size() const { return static_cast<size_t>(rowCount); }
+    size_t StringCount() const { return static_cast<size_t>(stringCount); }
+    uint64_t SourceHash() const { return sourceHash; }
+    uint64_t CreatedTime() const { return createdTime; }
+
+    // Cache produit depuis cette source (hachage de contenu identique)
+    bool Matches(uint64_t hash) const { return is_open() && sourceHash == hash; }
+
+    // Chaîne UTF-16LE en place (octets, unités sans le zéro final) ; vide si ID invalide
+    const uint8_t* StringData(uint32_t id, size_t& length) const {
+        length = 0;
+        if (id >= stringCount) {
+            return nullptr;
+        }
+        uint32_t first = ReadLE32(base + layout.offsets + static_cast<size_t>(id) * 4);
+        uint32_t last = ReadLE32(base + layout.offsets + static_cast<size_t>(id) * 4 + 4);
+        if (first >= last || last > unitCount) {
+            return nullptr;
+        }
+        length = last - first - 1;
+        return base + layout.strings + static_cast<size_t>(first) * 2;
+    }
+
+    void String(uint32_t id, std::wstring& out) const {
+        out.clear();
+        size_t length;
+        if (const uint8_t* data = StringData(id, length)) {
+            AppendUtf16LE(out, data, length * 2);
+        }
+    }
+
+#ifdef _WIN32
+    // wchar_t = UTF-16 : vue directe dans le mapping, terminée par un zéro
+    std::wstring_view View(uint32_t id) const {
+        size_t length;
+        const uint8_t* data = StringData(id, length);
+        return data ? std::wstring_view(reinterpret_cast<const wchar_t*>(data), length) : std::wstring_view(L"", 0);
+    }
+#endif
+
+    Row GetRow(size_t row) const {
+        const uint8_t* p = RowData(row);
+        Row r;
+        r.pathId = ReadLE32(p);
+        r.guidId = ReadLE32(p + 4);
+        r.userId = ReadLE32(p + 8);
+        r.counters.runCount = ReadLE32(p + 12);
+        r.counters.focusCount = ReadLE32(p + 16);
+        r.counters.focusTime = ReadLE32(p + 20);
+        r.counters.lastExecution = ReadLE64(p + 24);
+        r.counters.status = p[32];
+        r.knownFolder = p[33];
+        return r;
+    }
+
+    // Positions [first, last) de l'index temporel pour les exécutions dans [from, to]
+    void ExecutedBetween(uint64_t from, uint64_t to, size_t& first, size_t& last) const {
+        auto key = [this](size_t i) { return ReadLE64(base + layout.timeKeys + i * 8); };
+        auto lower = [&](uint64_t value, bool inclusive) {
+            size_t lo = 0, hi = static_cast<size_t>(timeCount);
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (inclusive ? key(mid) <= value : key(mid) < value) lo = mid + 1; else hi = mid;
+            }
+            return lo;
+        };
+        first = last = 0;
+        if (from <= to) {
+            first = lower(from, false);
+            last = lower(to, true);
+        }
+    }
+
+    size_t TimeCount() const { return static_cast<size_t>(timeCount); }
+
+    // Ligne à la position i de l'index temporel (par date croissante)
+    size_t TimeRow(size_t i) const {
+        uint32_t row = ReadLE32(base + layout.timeRows + i * 4);
+        return row < rowCount ? row : 0;
+    }
+
+    // Vérification complète (somme de contrôle du corps, références des lignes)
+    bool Verify(std::string& error) const {
+        if (!is_open()) {
+            error = "cache fermé";
+            return false;
+        }
+        if (Fnv1a32(base + RESULT_CACHE_HEADER_SIZE, layout.checksum - RESULT_CACHE_HEADER_SIZE) !=
+            ReadLE32(base + layout.checksum)) {
+            error = "somme de contrôle invalide";
+            return false;
+        }
+        for (size_t row = 0; row < rowCount; row++) {
+            const uint8_t* p = RowData(row);
+            if (ReadLE32(p) >= stringCount || ReadLE32(p + 4) >= stringCount || ReadLE32(p + 8) >= stringCount) {
+                error = "référence de chaîne hors limites";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Remplit un EntryStore (affichage, exports) depuis le cache
+    void LoadInto(EntryStore& store) const {
+        std::vector<uint32_t> remap(static_cast<size_t>(stringCount));
+        std::wstring text;
+        for (size_t id = 0; id < remap.size(); id++) {
+            String(static_cast<uint32_t>(id), text);
+            remap[id] = store.strings.Intern(text);
+        }
+        store.reserve(store.size() + size());
+        for (size_t row = 0; row < size(); row++) {
+            Row r = GetRow(row);
+            std::wstring_view path = r.pathId < remap.size() ? store.strings.Get(remap[r.pathId]) : std::wstring_view();
+            uint32_t guid = r.guidId < remap.size() ? remap[r.guidId] : store.strings.Intern(std::wstring_view());
+            uint32_t user = r.userId < remap.size() ? remap[r.userId] : store.strings.Intern(std::wstring_view());
+            store.Append(path, guid, user, r.counters);
+        }
+    }
+};
@@ -0,0 +1,332 @@
+/*
+ * ResultModel - publication des résultats de scan par lots immuables, affichage progressif
+ * Les workers ajoutent des lots immuables (un EntryStore par clé GUID terminée) sans verrou ; les
+ * lecteurs obtiennent des instantanés immuables échangés atomiquement : un export ou une comparaison
+ * lancés pendant le scan travaillent sur un état cohérent, jamais sur un store en cours d'écriture.
+ *
+ * - ResultModel : pile de lots en attente (CAS, sans verrou), intégrés au prochain instantané par le
+ *   lecteur qui les récupère ; Reset remplace tout (nouveau scan, résultat final ordonné) et change la
+ *   génération. L'instantané courant passe par std::atomic_load / atomic_compare_exchange_strong sur
+ *   shared_ptr (C++17) : ces fonctions prennent un verrou interne de la bibliothèque, le temps de la copie
+ *   du pointeur seulement (jamais pendant le filtrage ou le formatage). En C++20 : std::atomic<std::shared_ptr>
+ * - ResultView : instantané affiché et lignes retenues par le filtre ; seuls les lots ajoutés depuis
+ *   la vue précédente sont filtrés (coût proportionnel aux nouvelles lignes)
+ * - ResultRowCache : cellules d'une ligne formatées à la demande (ListView virtuelle), LRU de quelques
+ *   centaines de lignes : un million de lignes sans un million d'items
+ *
+ * Indépendant de Win32 : utilisable et testable hors de l'interface.
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "Query.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+constexpr size_t RESULT_COLUMNS = 9;
+constexpr size_t RESULT_ROW_CACHE_ROWS = 512;
+
+// Lot immuable : lignes d'une clé GUID d'une source, ordonné par (source, GUID) comme le scan final
+struct ResultBatch {
+    size_t source = 0;
+    std::wstring guid;
+    std::shared_ptr<const EntryStore> rows;
+};
+
+struct ResultRow {
+    const EntryStore* store;
+    size_t row;
+};
+
+class ResultSnapshot {
+public:
+    uint64_t generation = 0;    // Change à chaque Reset : les lignes ne prolongent plus l'instantané précédent
+    std::vector<std::shared_ptr<const ResultBatch>> batches;
+    std::vector<size_t> ends;   // Nombre cumulé de lignes à la fin de chaque lot
+
+    size_t size() const { return ends.empty() ? 0 : ends.back(); }
+    bool empty() const { return size() == 0; }
+    size_t BatchStart(size_t batch) const { return batch ? ends[batch - 1] : 0; }
+
+    void Add(std::shared_ptr<const ResultBatch> batch) {
+        ends.push_back(size() + batch->rows->size());
+        batches.push_back(std::move(batch));
+    }
+
+    // Ligne globale → lot et ligne locale
+    ResultRow Locate(size_t row) const {
+        size_t batch = static_cast<size_t>(std::upper_bound(ends.begin(), ends.end(), row) - ends.begin());
+        return { batches[batch]->rows.get(), row - BatchStart(batch) };
+    }
+
+    // Toutes les lignes dans un seul store, lots dans l'ordre (source, GUID) du scan final.
+    // Sans copie quand l'instantané n'a qu'un lot (résultat final, cache).
+    std::shared_ptr<const EntryStore> Flatten() const {
+        if (batches.size() == 1) {
+            return batches[0]->rows;
+        }
+        std::vector<const ResultBatch*> ordered;
+        for (const auto& batch : batches) {
+            ordered.push_back(batch.get());
+        }
+        std::sort(ordered.begin(), ordered.end(), [](const ResultBatch* a, const ResultBatch* b) {
+            return a->source != b->source ? a->source < b->source : a->guid < b->guid;
+        });
+        auto merged = std::make_shared<EntryStore>();
+        for (const ResultBatch* batch : ordered) {
+            merged->Append(*batch->rows);
+        }
+        return merged;
+    }
+};
+
+class ResultModel {
+    struct Pending {
+        std::shared_ptr<const ResultBatch> batch;
+        uint64_t generation;
+        Pending* next;
+    };
+
+    std::atomic<Pending*> pending{nullptr};
+    std::atomic<uint64_t> generation{1};
+    // Accès par std::atomic_load / atomic_store / atomic_compare_exchange_strong uniquement (verrou
+    // interne de la bibliothèque, tenu pendant l'échange du pointeur)
+    std::shared_ptr<const ResultSnapshot> current;
+
+    static void Free(Pending* node) {
+        while (node) {
+            Pending* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+public:
+    ResultModel() {
+        auto empty = std::make_shared<ResultSnapshot>();
+        empty->generation = generation.load();
+        current = std::move(empty);
+    }
+
+    ~ResultModel() { Free(pending.exchange(nullptr)); }
+
+    ResultModel(const ResultModel&) = delete;
+    ResultModel& operator=(const ResultModel&) = delete;
+
+    // Producteurs (workers) : lot ajouté sans verrou ni copie, visible au prochain Current()
+    void Append(ResultBatch batch) {
+        if (!batch.rows || batch.rows->empty()) {
+            return;
+        }
+        Pending* node = new Pending{ std::make_shared<const ResultBatch>(std::move(batch)),
+                                     generation.load(std::memory_order_acquire), nullptr };
+        node->next = pending.load(std::memory_order_relaxed);
+        while (!pending.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    // Lecteurs : instantané courant, lots en attente intégrés au passage. La pile est vidée sans verrou ;
+    // la publication compare-échange le shared_ptr (verrou interne court) et se rebase si un autre lecteur
+    // ou un Reset a publié entre-temps ; les lots d'une génération remplacée sont abandonnés
+    std::shared_ptr<const ResultSnapshot> Current() {
+        Pending* list = pending.exchange(nullptr, std::memory_order_acquire);
+        std::shared_ptr<const ResultSnapshot> snapshot = std::atomic_load(&current);
+        if (!list) {
+            return snapshot;
+        }
+        std::vector<Pending*> added;
+        for (Pending* node = list; node; node = node->next) {
+            added.push_back(node);
+        }
+        std::reverse(added.begin(), added.end());     // Ordre d'arrivée
+
+        std::shared_ptr<const ResultSnapshot> next;
+        for (;;) {
+            auto extended = std::make_shared<ResultSnapshot>(*snapshot);
+            for (Pending* node : added) {
+                if (node->generation == snapshot->generation) {
+                    extended->Add(node->batch);
+                }
+            }
+            next = std::move(extended);
+            if (std::atomic_compare_exchange_strong(&current, &snapshot, next)) {
+                break;
+            }
+        }
+        Free(list);
+        return next;
+    }
+
+    // Remplace tout le contenu (rows nullptr : vide). Appelé sans producteur actif :
+    // au début d'un scan, ou à la fin avec le résultat fusionné dans l'ordre déterministe
+    void Reset(std::shared_ptr<const EntryStore> rows) {
+        auto snapshot = std::make_shared<ResultSnapshot>();
+        snapshot->generation = generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (rows && !rows->empty()) {
+            auto batch = std::make_shared<ResultBatch>();
+            batch->rows = std::move(rows);
+            snapshot->Add(std::move(batch));
+        }
+        Free(pending.exchange(nullptr, std::memory_order_acquire));
+        std::atomic_store(&current, std::shared_ptr<const ResultSnapshot>(std::move(snapshot)));
+    }
+};
+
+// Instantané affiché et lignes retenues (thread de l'interface uniquement)
+class ResultView {
+    std::shared_ptr<const ResultSnapshot> snapshot = std::make_shared<ResultSnapshot>();
+    std::vector<uint32_t> visible;      // Lignes globales retenues, croissantes
+    size_t selectedBatches = 0;
+    std::vector<uint32_t> scratch;
+
+public:
+    // Nouvel instantané : seuls les lots ajoutés sont filtrés. Renvoie true si la vue repart de zéro
+    // (génération différente) : les items déjà affichés ne correspondent plus aux mêmes lignes.
+    bool Update(std::shared_ptr<const ResultSnapshot> next, const Query& filter) {
+        bool reset = next->generation != snapshot->generation;
+        if (reset) {
+            visible.clear();
+            selectedBatches = 0;
+        }
+        snapshot = std::move(next);
+        for (; selectedBatches < snapshot->batches.size(); selectedBatches++) {
+            const EntryStore& rows = *snapshot->batches[selectedBatches]->rows;
+            uint32_t start = static_cast<uint32_t>(snapshot->BatchStart(selectedBatches));
+            if (filter.empty()) {
+                for (size_t row = 0; row < rows.size(); row++) {
+                    visible.push_back(start + static_cast<uint32_t>(row));
+                }
+            } else {
+                filter.Select(rows, scratch);
+                for (uint32_t row : scratch) {
+                    visible.push_back(start + row);
+                }
+            }
+        }
+        return reset;
+    }
+
+    // Filtre modifié : toutes les lignes de l'instantané courant resélectionnées
+    void Reselect(const Query& filter) {
+        visible.clear();
+        selectedBatches = 0;
+        Update(snapshot, filter);
+    }
+
+    const ResultSnapshot& Snapshot() const { return *snapshot; }
+    size_t size() const { return visible.size(); }
+    bool empty() const { return visible.empty(); }
+    size_t total() const { return snapshot->size(); }
+    bool Filtered() const { return visible.size() != snapshot->size(); }
+
+    ResultRow Row(size_t item) const { return snapshot->Locate(visible[item]); }
+
+    // Lignes retenues copiées dans out (une plage contiguë par lot)
+    void Select(EntryStore& out) const {
+        size_t item = 0;
+        for (size_t batch = 0; batch < snapshot->batches.size() && item < visible.size(); batch++) {
+            uint32_t start = static_cast<uint32_t>(snapshot->BatchStart(batch));
+            uint32_t end = static_cast<uint32_t>(snapshot->ends[batch]);
+            std::vector<uint32_t> rows;
+            for (; item < visible.size() && visible[item] < end; item++) {
+                rows.push_back(visible[item] - start);
+            }
+            if (!rows.empty()) {
+                out.Append(*snapshot->batches[batch]->rows, rows);
+            }
+        }
+    }
+};
+
+// Cellules affichées d'une ligne, dans l'ordre des colonnes de la ListView
+struct FormattedRow {
+    std::wstring cells[RESULT_COLUMNS];
+};
+
+inline void FormatResultRow(const EntryStore& entries, size_t row, FormattedRow& out) {
+    wchar_t text[UA_TIME_TEXT_CHARS];
+    std::wstring_view path = entries.DecodedPath(row);
+    out.cells[0].assign(path.data(), path.size());
+    entries.EncodedName(row, out.cells[1]);
+    out.cells[2] = std::to_wstring(entries.runCount[row]);
+    // Date formatée à l'affichage depuis le FILETIME brut
+    out.cells[3].assign(text, entries.FormatLastExecution(row, text));
+    out.cells[4] = std::to_wstring(entries.focusCount[row]);
+    out.cells[5].assign(text, FormatDuration(entries.focusTime[row], text));
+    std::wstring_view guid = entries.Guid(row);
+    out.cells[6].assign(guid.data(), guid.size());
+    std::wstring_view user = entries.Username(row);
+    out.cells[7].assign(user.data(), user.size());
+    // GUID de dossier connu remplacé par son emplacement (%ProgramFiles%, %APPDATA%...)
+    entries.ResolvedPathString(row, out.cells[8]);
+}
+
+// LRU des lignes formatées, indexé par item de la vue (valable tant que la vue n'est pas réinitialisée)
+class ResultRowCache {
+    struct Slot {
+        size_t item;
+        FormattedRow row;
+    };
+
+    std::list<Slot> slots;      // Plus récent en tête
+    std::unordered_map<size_t, std::list<Slot>::iterator> index;
+    size_t capacity;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+public:
+    explicit ResultRowCache(size_t rows = RESULT_ROW_CACHE_ROWS) : capacity(std::max<size_t>(1, rows)) {}
+
+    // Vue réinitialisée ou filtre modifié (slots conservés pour réutiliser leurs buffers)
+    void Clear() { index.clear(); }
+
+    uint64_t Hits() const { return hits; }
+    uint64_t Misses() const { return misses; }
+
+    const FormattedRow& Get(const ResultView& view, size_t item) {
+        auto found = index.find(item);
+        if (found != index.end()) {
+            hits++;
+            slots.splice(slots.begin(), slots, found->second);
+            return found->second->row;
+        }
+        misses++;
+        // Slot le plus ancien recyclé (ou un slot libéré par Clear, repéré par son absence de l'index)
+        if (slots.size() >= capacity) {
+            auto oldest = std::prev(slots.end());
+            auto owner = index.find(oldest->item);
+            if (owner != index.end() && owner->second == oldest) {
+                index.erase(owner);
+            }
+            slots.splice(slots.begin(), slots, oldest);
+        } else {
+            slots.emplace_front();
+        }
+        Slot& slot = slots.front();
+        slot.item = item;
+        ResultRow row = view.Row(item);
+        FormatResultRow(*row.store, row.row, slot.row);
+        index[item] = slots.begin();
+        return slot.row;
+    }
+
+    // Indication de la ListView (plage sur le point d'être affichée) : lignes formatées en une passe
+    void Prefetch(const ResultView& view, size_t from, size_t to) {
+        to = std::min(to, view.size() ? view.size() - 1 : 0);
+        for (size_t item = from; item <= to && item < view.size() && item - from < capacity; item++) {
+            Get(view, item);
+        }
+    }
+};
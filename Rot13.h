@@ -0,0 +1,196 @@
+/*
+ * Rot13 - décodage ROT13 vectorisé des noms de valeurs UserAssist
+ * Noyaux SSE2 / AVX2 sélectionnés à l'exécution (CPUID), repli scalaire ailleurs.
+ *
+ * Seules les lettres ASCII sont modifiées : le résultat est identique bit à bit
+ * à l'algorithme scalaire, y compris pour les caractères non ASCII.
+ * Fonctionne sur des unités de 16 bits (wchar_t Windows, char16_t) ou 32 bits (wchar_t Linux).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define UA_ROT13_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC autorise les intrinsèques sans option ; GCC/Clang exigent un attribut cible
+#if defined(UA_ROT13_X86) && (defined(__GNUC__) || defined(__clang__))
+#define UA_TARGET_SSE2 __attribute__((target("sse2")))
+#define UA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UA_TARGET_SSE2
+#define UA_TARGET_AVX2
+#endif
+
+// Noyau scalaire (référence et traitement des fins de buffer)
+template <typename T>
+inline void Rot13Scalar(const T* in, T* out, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        T ch = in[i];
+        if (ch >= T('A') && ch <= T('Z')) {
+            ch = static_cast<T>((ch - T('A') + 13) % 26 + T('A'));
+        } else if (ch >= T('a') && ch <= T('z')) {
+            ch = static_cast<T>((ch - T('a') + 13) % 26 + T('a'));
+        }
+        out[i] = ch;
+    }
+}
+
+#ifdef UA_ROT13_X86
+
+// Principe (par voie) : l = c | 0x20 ramène les majuscules en minuscules ;
+// lettre si 'a' <= l <= 'z' ; +13 pour a..m, -13 pour n..z.
+// Les comparaisons signées excluent d'office les unités >= 0x8000 (16 bits).
+template <typename T>
+UA_TARGET_SSE2 inline void Rot13Sse2(const T* in, T* out, size_t length) {
+    static_assert(sizeof(T) == 2 || sizeof(T) == 4, "unité UTF-16 ou UTF-32 attendue");
+    constexpr size_t lanes = 16 / sizeof(T);
+    size_t i = 0;
+
+    if (sizeof(T) == 2) {
+        const __m128i lowerBit = _mm_set1_epi16(0x20);
+        const __m128i beforeA = _mm_set1_epi16('a' - 1);
+        const __m128i afterZ = _mm_set1_epi16('z' + 1);
+        const __m128i lastFirstHalf = _mm_set1_epi16('m');
+        const __m128i thirteen = _mm_set1_epi16(13);
+        const __m128i twentySix = _mm_set1_epi16(26);
+
+        for (; i + lanes <= length; i += lanes) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i l = _mm_or_si128(c, lowerBit);
+            __m128i letter = _mm_and_si128(_mm_cmpgt_epi16(l, beforeA), _mm_cmpgt_epi16(afterZ, l));
+            __m128i secondHalf = _mm_and_si128(letter, _mm_cmpgt_epi16(l, lastFirstHalf));
+            __m128i delta = _mm_sub_epi16(_mm_and_si128(letter, thirteen), _mm_and_si128(secondHalf, twentySix));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi16(c, delta));
+        }
+    } else {
+        const __m128i lowerBit = _mm_set1_epi32(0x20);
+        const __m128i beforeA = _mm_set1_epi32('a' - 1);
+        const __m128i afterZ = _mm_set1_epi32('z' + 1);
+        const __m128i lastFirstHalf = _mm_set1_epi32('m');
+        const __m128i thirteen = _mm_set1_epi32(13);
+        const __m128i twentySix = _mm_set1_epi32(26);
+
+        for (; i + lanes <= length; i += lanes) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i l = _mm_or_si128(c, lowerBit);
+            __m128i letter = _mm_and_si128(_mm_cmpgt_epi32(l, beforeA), _mm_cmpgt_epi32(afterZ, l));
+            __m128i secondHalf = _mm_and_si128(letter, _mm_cmpgt_epi32(l, lastFirstHalf));
+            __m128i delta = _mm_sub_epi32(_mm_and_si128(letter, thirteen), _mm_and_si128(secondHalf, twentySix));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(c, delta));
+        }
+    }
+
+    Rot13Scalar(in + i, out + i, length - i);
+}
+
+template <typename T>
+UA_TARGET_AVX2 inline void Rot13Avx2(const T* in, T* out, size_t length) {
+    static_assert(sizeof(T) == 2 || sizeof(T) == 4, "unité UTF-16 ou UTF-32 attendue");
+    constexpr size_t lanes = 32 / sizeof(T);
+    size_t i = 0;
+
+    if (sizeof(T) == 2) {
+        const __m256i lowerBit = _mm256_set1_epi16(0x20);
+        const __m256i beforeA = _mm256_set1_epi16('a' - 1);
+        const __m256i afterZ = _mm256_set1_epi16('z' + 1);
+        const __m256i lastFirstHalf = _mm256_set1_epi16('m');
+        const __m256i thirteen = _mm256_set1_epi16(13);
+        const __m256i twentySix = _mm256_set1_epi16(26);
+
+        for (; i + lanes <= length; i += lanes) {
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i l = _mm256_or_si256(c, lowerBit);
+            __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi16(l, beforeA), _mm256_cmpgt_epi16(afterZ, l));
+            __m256i secondHalf = _mm256_and_si256(letter, _mm256_cmpgt_epi16(l, lastFirstHalf));
+            __m256i delta = _mm256_sub_epi16(_mm256_and_si256(letter, thirteen),
+                                             _mm256_and_si256(secondHalf, twentySix));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi16(c, delta));
+        }
+    } else {
+        const __m256i lowerBit = _mm256_set1_epi32(0x20);
+        const __m256i beforeA = _mm256_set1_epi32('a' - 1);
+        const __m256i afterZ = _mm256_set1_epi32('z' + 1);
+        const __m256i lastFirstHalf = _mm256_set1_epi32('m');
+        const __m256i thirteen = _mm256_set1_epi32(13);
+        const __m256i twentySix = _mm256_set1_epi32(26);
+
+        for (; i + lanes <= length; i += lanes) {
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i l = _mm256_or_si256(c, lowerBit);
+            __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi32(l, beforeA), _mm256_cmpgt_epi32(afterZ, l));
+            __m256i secondHalf = _mm256_and_si256(letter, _mm256_cmpgt_epi32(l, lastFirstHalf));
+            __m256i delta = _mm256_sub_epi32(_mm256_and_si256(letter, thirteen),
+                                             _mm256_and_si256(secondHalf, twentySix));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(c, delta));
+        }
+    }
+
+    // Fin de buffer : un passage SSE2 puis scalaire
+    Rot13Sse2(in + i, out + i, length - i);
+}
+
+// AVX2 disponible sur le CPU et activé par l'OS (XSAVE des registres YMM)
+inline bool CpuSupportsAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif  // UA_ROT13_X86
+
+template <typename T>
+using Rot13Kernel = void (*)(const T*, T*, size_t);
+
+// Sélection unique du meilleur noyau disponible
+template <typename T>
+inline Rot13Kernel<T> SelectRot13Kernel() {
+#ifdef UA_ROT13_X86
+    if (CpuSupportsAvx2()) {
+        return &Rot13Avx2<T>;
+    }
+    return &Rot13Sse2<T>;
+#else
+    return &Rot13Scalar<T>;
+#endif
+}
+
+inline const char* Rot13KernelName() {
+#ifdef UA_ROT13_X86
+    return CpuSupportsAvx2() ? "AVX2" : "SSE2";
+#else
+    return "scalaire";
+#endif
+}
+
+// Décodage dans un buffer fourni par l'appelant ; in == out autorisé (décodage en place)
+template <typename T>
+inline void DecodeROT13Buffer(const T* in, T* out, size_t length) {
+    static const Rot13Kernel<T> kernel = SelectRot13Kernel<T>();
+    if (length < 16 / sizeof(T)) {
+        Rot13Scalar(in, out, length);
+        return;
+    }
+    kernel(in, out, length);
+}
@@ -0,0 +1,434 @@
+/*
+ * ScanScheduler - scan UserAssist parallèle, annulable, avec progression par lots
+ * Sources : profils chargés (HKEY_USERS\<SID>, ou HKCU) et hives NTUSER.DAT offline.
+ * Chaque source est explorée par une tâche qui liste ses sous-clés {GUID} (toutes, pas
+ * seulement Executable/Shortcut) puis soumet une tâche par GUID au pool work-stealing.
+ *
+ * - Annulation coopérative : drapeau testé à chaque valeur, arrêt en quelques ms
+ * - Progression : compteurs atomiques publiés toutes les SCAN_PROGRESS_BATCH valeurs,
+ *   callback limité à un appel toutes les SCAN_PROGRESS_INTERVAL (depuis un worker)
+ * - Résultats : un EntryStore par tâche, fusionnés dans l'ordre (source, GUID) :
+ *   même résultat quel que soit l'ordonnancement ; chaque store terminé est aussi transmis
+ *   immuable (OnBatch) pour un affichage progressif pendant le scan
+ * - Instrumentation optionnelle (SetPerfCounters) : temps par étape et valeurs ignorées,
+ *   mesurés par tâche puis publiés en une fois
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "HiveReader.h"
+#include "PerfCounters.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sddl.h>
+#endif
+
+constexpr size_t SCAN_PROGRESS_BATCH = 256;
+constexpr std::chrono::milliseconds SCAN_PROGRESS_INTERVAL(50);
+
+enum ScanSourceKind : uint8_t {
+    UA_SOURCE_REGISTRY = 0,     // Profil chargé : HKEY_USERS\<sid> (sid vide = HKCU)
+    UA_SOURCE_HIVE = 1          // Hive NTUSER.DAT offline
+};
+
+struct ScanSource {
+    ScanSourceKind kind = UA_SOURCE_REGISTRY;
+    std::wstring user;          // Nom affiché dans la colonne Username
+    std::wstring sid;
+    std::filesystem::path hive;
+};
+
+struct ScanProgress {
+    size_t sources = 0;
+    size_t sourcesDone = 0;
+    size_t tasks = 0;           // Tâches GUID découvertes
+    size_t tasksDone = 0;
+    uint64_t values = 0;
+    bool cancelled = false;
+};
+
+class ScanScheduler {
+public:
+    using ProgressCallback = std::function<void(const ScanProgress&)>;
+    using BatchCallback = std::function<void(size_t source, const std::wstring& guid,
+                                             std::shared_ptr<const EntryStore> entries)>;
+
+private:
+    struct TaskResult {
+        size_t source;
+        std::wstring guid;
+        std::shared_ptr<const EntryStore> entries;
+    };
+
+    // Hive mappée partagée par les tâches GUID d'une même source
+    struct MappedHive {
+        MappedFile file;
+        HiveReader hive;
+    };
+
+    size_t threads;
+    std::atomic<bool> cancel{false};
+    ProgressCallback progressCallback;
+    BatchCallback batchCallback;
+    PerfCounters* perf = nullptr;
+
+    std::atomic<size_t> sourceCount{0};
+    std::atomic<size_t> sourcesDone{0};
+    std::atomic<size_t> taskCount{0};
+    std::atomic<size_t> tasksDone{0};
+    std::atomic<uint64_t> values{0};
+    std::atomic<int64_t> lastProgressMs{0};
+
+    std::mutex resultsLock;
+    std::vector<TaskResult> results;
+
+    static int64_t NowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Un seul worker publie par intervalle (CAS sur l'horodatage), les autres continuent
+    void EmitProgress(bool force) {
+        if (!progressCallback) {
+            return;
+        }
+        int64_t now = NowMs();
+        int64_t last = lastProgressMs.load(std::memory_order_relaxed);
+        if (!force && now - last < SCAN_PROGRESS_INTERVAL.count()) {
+            return;
+        }
+        if (!lastProgressMs.compare_exchange_strong(last, now, std::memory_order_relaxed) && !force) {
+            return;
+        }
+        progressCallback(Progress());
+    }
+
+    // Compteur local publié par lots (un atomique toutes les SCAN_PROGRESS_BATCH valeurs)
+    struct ValueCounter {
+        ScanScheduler& owner;
+        size_t pending = 0;
+
+        explicit ValueCounter(ScanScheduler& scheduler) : owner(scheduler) {}
+        ~ValueCounter() { owner.values += pending; }
+
+        // false si le scan est annulé
+        bool Next() {
+            if (++pending == SCAN_PROGRESS_BATCH) {
+                owner.values += pending;
+                pending = 0;
+                owner.EmitProgress(false);
+            }
+            return !owner.cancel.load(std::memory_order_relaxed);
+        }
+    };
+
+    // Store terminé, plus jamais modifié : partagé entre la fusion finale et l'affichage progressif
+    void StoreResult(size_t source, const std::wstring& guid, std::shared_ptr<const EntryStore> entries) {
+        if (!entries->empty()) {
+            if (batchCallback) {
+                batchCallback(source, guid, entries);
+            }
+            std::lock_guard<std::mutex> guard(resultsLock);
+            results.push_back(TaskResult{ source, guid, std::move(entries) });
+        }
+        tasksDone++;
+        EmitProgress(false);
+    }
+
+    void Publish(const PerfTally& tally) {
+        if (perf) {
+            perf->Add(tally);
+        }
+    }
+
+    void ScanHiveGuid(size_t index, const ScanSource& source, const std::shared_ptr<MappedHive>& mapped,
+                      const std::wstring& guid) {
+        auto entries = std::make_unique<EntryStore>();
+        PerfTally tally(perf != nullptr);
+        if (!cancel.load(std::memory_order_relaxed)) {
+            uint32_t guidId = entries->strings.Intern(guid);
+            uint32_t userId = entries->strings.Intern(source.user);
+            std::wstring path;
+            std::vector<uint32_t> paths;
+            std::vector<UserAssistBlob> blobs;
+            ValueCounter counter(*this);
+            ForEachUserAssistValue(mapped->hive, guid.c_str(), [&](const HiveValue& value) {
+                value.name.AssignTo(path);
+                tally.Lap(PERF_ENUMERATE);
+                DecodeROT13InPlace(&path[0], path.size());
+                tally.Lap(PERF_ROT13);
+                paths.push_back(entries->strings.Intern(path));
+                blobs.push_back({ value.data, value.dataSize, value.type });
+                tally.Lap(PERF_STORE);
+                return counter.Next();
+            });
+            tally.Lap(PERF_ENUMERATE);
+            // Hive mappée jusqu'à la fin de la tâche : données Count décodées en un lot
+            AppendUserAssistBlobs(*entries, paths, guidId, userId, blobs, tally);
+        }
+        Publish(tally);
+        StoreResult(index, guid, std::move(entries));
+    }
+
+    void DiscoverHive(ThreadPool& pool, size_t index, const ScanSource& source) {
+        auto mapped = std::make_shared<MappedHive>();
+        PerfTally tally(perf != nullptr);
+        if (mapped->file.Open(source.hive.c_str()) &&
+            mapped->hive.Open(mapped->file.data(), mapped->file.size())) {
+            tally.Count(PERF_SOURCES);
+            tally.Count(PERF_BYTES_READ, mapped->file.size());
+            std::vector<std::wstring> guids = ListUserAssistGuids(mapped->hive);
+            tally.Lap(PERF_ENUMERATE);
+            for (const std::wstring& guid : guids) {
+                taskCount++;
+                pool.Submit([this, index, &source, mapped, guid] { ScanHiveGuid(index, source, mapped, guid); });
+            }
+        } else {
+            tally.Lap(PERF_ENUMERATE);
+        }
+        Publish(tally);
+        sourcesDone++;
+    }
+
+#ifdef _WIN32
+    static HKEY OpenUserAssistKey(const ScanSource& source, const std::wstring& suffix) {
+        std::wstring path;
+        HKEY root = HKEY_CURRENT_USER;
+        if (!source.sid.empty()) {
+            root = HKEY_USERS;
+            path = source.sid + L"\\";
+        }
+        path += USERASSIST_KEY_PATH;
+        path += suffix;
+
+        HKEY key = nullptr;
+        if (RegOpenKeyExW(root, path.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS) {
+            return nullptr;
+        }
+        return key;
+    }
+
+    void ScanRegistryGuid(size_t index, const ScanSource& source, const std::wstring& guid) {
+        auto entries = std::make_unique<EntryStore>();
+        PerfTally tally(perf != nullptr);
+        HKEY key = cancel.load(std::memory_order_relaxed) ? nullptr
+                                                          : OpenUserAssistKey(source, L"\\" + guid + L"\\Count");
+        if (key) {
+            uint32_t guidId = entries->strings.Intern(guid);
+            uint32_t userId = entries->strings.Intern(source.user);
+            std::vector<wchar_t> valueName(16384);
+            BYTE data[1024];
+            ValueCounter counter(*this);
+
+            for (DWORD i = 0;; i++) {
+                DWORD valueNameSize = static_cast<DWORD>(valueName.size());
+                DWORD dataSize = sizeof(data);
+                DWORD type = 0;
+                LONG result = RegEnumValueW(key, i, valueName.data(), &valueNameSize, nullptr, &type,
+                                            data, &dataSize);
+                if (result == ERROR_NO_MORE_ITEMS) {
+                    break;
+                }
+                if (result != ERROR_SUCCESS) {
+                    // ERROR_MORE_DATA : données plus grandes que le buffer, valeur ignorée
+                    tally.Count(PERF_SKIPPED_ENUM);
+                    continue;
+                }
+                tally.Count(PERF_BYTES_READ, valueNameSize * sizeof(wchar_t) + dataSize);
+                tally.Lap(PERF_ENUMERATE);
+                // Décodage ROT13 en place : le nom encodé se recalcule à l'affichage
+                DecodeROT13InPlace(valueName.data(), valueNameSize);
+                tally.Lap(PERF_ROT13);
+                UserAssistCounters counters = DecodeUserAssistCounters(data, dataSize, type);
+                tally.CountValue(type, counters);
+                tally.Lap(PERF_DECODE);
+                entries->Append(std::wstring_view(valueName.data(), valueNameSize), guidId, userId, counters);
+                tally.Lap(PERF_STORE);
+                if (!counter.Next()) {
+                    break;
+                }
+            }
+            RegCloseKey(key);
+        }
+        tally.Lap(PERF_ENUMERATE);
+        Publish(tally);
+        StoreResult(index, guid, std::move(entries));
+    }
+
+    void DiscoverRegistry(ThreadPool& pool, size_t index, const ScanSource& source) {
+        PerfTally tally(perf != nullptr);
+        HKEY userAssist = OpenUserAssistKey(source, std::wstring());
+        if (userAssist) {
+            tally.Count(PERF_SOURCES);
+            wchar_t name[256];
+            for (DWORD i = 0; !cancel.load(std::memory_order_relaxed); i++) {
+                DWORD nameSize = 256;
+                LONG result = RegEnumKeyExW(userAssist, i, name, &nameSize, nullptr, nullptr, nullptr, nullptr);
+                if (result == ERROR_NO_MORE_ITEMS) {
+                    break;
+                }
+                if (result != ERROR_SUCCESS) {
+                    continue;
+                }
+                std::wstring guid(name, nameSize);
+                taskCount++;
+                pool.Submit([this, index, &source, guid] { ScanRegistryGuid(index, source, guid); });
+            }
+            RegCloseKey(userAssist);
+        }
+        tally.Lap(PERF_ENUMERATE);
+        Publish(tally);
+        sourcesDone++;
+    }
+#endif
+
+public:
+    // threadCount = 0 : un worker par cœur logique
+    explicit ScanScheduler(size_t threadCount = 0) : threads(threadCount) {}
+
+    ScanScheduler(const ScanScheduler&) = delete;
+    ScanScheduler& operator=(const ScanScheduler&) = delete;
+
+    // Appelé depuis un worker : ne doit pas bloquer (ex. PostMessage)
+    void OnProgress(ProgressCallback callback) { progressCallback = std::move(callback); }
+
+    // Appelé depuis un worker à chaque clé GUID terminée (store immuable) : ne doit pas bloquer
+    void OnBatch(BatchCallback callback) { batchCallback = std::move(callback); }
+
+    // Mesures par étape publiées dans counters pendant Run (nullptr = désactivé)
+    void SetPerfCounters(PerfCounters* counters) { perf = counters; }
+
+    // Réarmement avant un nouveau scan (thread appelant, avant Run)
+    void Reset() { cancel.store(false); }
+    void Cancel() { cancel.store(true); }
+    bool Cancelled() const { return cancel.load(); }
+
+    ScanProgress Progress() const {
+        ScanProgress progress;
+        progress.sources = sourceCount.load();
+        progress.sourcesDone = sourcesDone.load();
+        progress.tasks = taskCount.load();
+        progress.tasksDone = tasksDone.load();
+        progress.values = values.load();
+        progress.cancelled = cancel.load();
+        return progress;
+    }
+
+    // Scanne toutes les sources ; les résultats terminés sont ajoutés à entries (partiels si annulé).
+    // Renvoie false si le scan a été annulé.
+    bool Run(const std::vector<ScanSource>& sources, EntryStore& entries) {
+        sourceCount = sources.size();
+        sourcesDone = 0;
+        taskCount = 0;
+        tasksDone = 0;
+        values = 0;
+        lastProgressMs = 0;
+        results.clear();
+
+        {
+            ThreadPool pool(threads);
+            for (size_t i = 0; i < sources.size(); i++) {
+                const ScanSource& source = sources[i];
+                ThreadPool* workers = &pool;
+                pool.Submit([this, workers, i, &source] {
+                    if (cancel.load(std::memory_order_relaxed)) {
+                        sourcesDone++;
+                        return;
+                    }
+                    if (source.kind == UA_SOURCE_HIVE) {
+                        DiscoverHive(*workers, i, source);
+                    } else {
+#ifdef _WIN32
+                        DiscoverRegistry(*workers, i, source);
+#else
+                        sourcesDone++;
+#endif
+                    }
+                });
+            }
+            pool.Wait();
+        }
+
+        std::sort(results.begin(), results.end(), [](const TaskResult& a, const TaskResult& b) {
+            return a.source != b.source ? a.source < b.source : a.guid < b.guid;
+        });
+        PerfTally merge(perf != nullptr);
+        for (const TaskResult& result : results) {
+            entries.Append(*result.entries);
+        }
+        results.clear();
+        merge.Lap(PERF_STORE);
+        Publish(merge);
+
+        EmitProgress(true);
+        return !cancel.load();
+    }
+};
+
+#ifdef _WIN32
+// Profils chargés sous HKEY_USERS (S-1-5-21-..., hors *_Classes et comptes de service).
+// Sans droit de lecture sur HKU, seul le profil courant (HKCU) est renvoyé.
+inline std::vector<ScanSource> EnumerateLoadedProfiles() {
+    std::vector<ScanSource> sources;
+    wchar_t name[256];
+    for (DWORD i = 0;; i++) {
+        DWORD nameSize = 256;
+        LONG result = RegEnumKeyExW(HKEY_USERS, i, name, &nameSize, nullptr, nullptr, nullptr, nullptr);
+        if (result == ERROR_NO_MORE_ITEMS) {
+            break;
+        }
+        if (result != ERROR_SUCCESS) {
+            continue;
+        }
+        std::wstring sid(name, nameSize);
+        if (sid.compare(0, 9, L"S-1-5-21-") != 0 || sid.find(L"_Classes") != std::wstring::npos) {
+            continue;
+        }
+
+        ScanSource source;
+        source.kind = UA_SOURCE_REGISTRY;
+        source.sid = sid;
+        source.user = sid;
+
+        // SID → nom de compte (le SID reste affiché si le compte est inconnu)
+        PSID psid = nullptr;
+        if (ConvertStringSidToSidW(sid.c_str(), &psid)) {
+            wchar_t account[256], domain[256];
+            DWORD accountSize = 256, domainSize = 256;
+            SID_NAME_USE use;
+            if (LookupAccountSidW(nullptr, psid, account, &accountSize, domain, &domainSize, &use)) {
+                source.user = account;
+            }
+            LocalFree(psid);
+        }
+        sources.push_back(std::move(source));
+    }
+
+    if (sources.empty()) {
+        wchar_t username[256] = L"Utilisateur actuel";
+        DWORD size = 256;
+        GetUserNameW(username, &size);
+        ScanSource current;
+        current.kind = UA_SOURCE_REGISTRY;
+        current.user = username;
+        sources.push_back(std::move(current));
+    }
+    return sources;
+}
+#endif
@@ -0,0 +1,324 @@
+/*
+ * Snapshot - instantané persistant d'un scan UserAssist et moteur de différences
+ * Pour la surveillance continue : un scan n'émet que les entrées nouvelles, les
+ * incréments de compteurs et les dates de dernière exécution déplacées.
+ *
+ * Clé d'une entrée : FNV-1a 64 bits de (utilisateur, GUID, chemin décodé) ; le chemin
+ * décodé est équivalent au nom de valeur (ROT13 involutif). Le fichier ne conserve que
+ * clés et compteurs (32 octets par entrée), triés par clé pour la recherche dichotomique.
+ *
+ * Disposition (little-endian) :
+ *   "UASN" | version u16 | réservé u16 | nb entrées u64
+ *   entrées : clé u64, lastExecution u64, runCount u32, focusCount u32, focusTime u32, état u8, 3 octets nuls
+ *   FNV-1a u32 des entrées
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x4E534155;     // "UASN"
+constexpr uint16_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_HEADER_SIZE = 16;
+constexpr size_t SNAPSHOT_RECORD_SIZE = 32;
+
+struct SnapshotRecord {
+    uint64_t key = 0;
+    uint64_t lastExecution = 0;
+    uint32_t runCount = 0;
+    uint32_t focusCount = 0;
+    uint32_t focusTime = 0;
+    uint8_t status = UA_TIME_INVALID;
+
+    bool operator<(const SnapshotRecord& other) const { return key < other.key; }
+};
+
+enum SnapshotChange : uint8_t {
+    UA_CHANGE_NEW = 0,          // Entrée absente de l'instantané
+    UA_CHANGE_UPDATED = 1       // Compteurs ou date de dernière exécution modifiés
+};
+
+// Différence d'une ligne du scan courant par rapport à l'instantané
+struct EntryDiff {
+    uint32_t row = 0;
+    uint8_t change = UA_CHANGE_NEW;
+    int64_t runDelta = 0;               // Négatif si les compteurs ont été remis à zéro
+    int64_t focusCountDelta = 0;
+    int64_t focusTimeDelta = 0;
+    uint64_t previousLastExecution = 0;
+    uint8_t previousStatus = UA_TIME_INVALID;
+};
+
+struct SnapshotDiffSummary {
+    size_t added = 0;
+    size_t updated = 0;
+    size_t unchanged = 0;
+    size_t removed = 0;         // Présentes dans l'instantané, absentes du scan (clé effacée ?)
+};
+
+inline uint64_t SnapshotKeyHash(uint64_t h, std::wstring_view text) {
+    for (wchar_t ch : text) {
+        h ^= static_cast<uint32_t>(ch);
+        h *= 0x100000001b3ull;
+    }
+    h ^= 0xFFFF;    // Séparateur (hors des unités ROT13 possibles dans un nom)
+    h *= 0x100000001b3ull;
+    return h;
+}
+
+inline uint64_t SnapshotKey(std::wstring_view user, std::wstring_view guid, std::wstring_view path) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    h = SnapshotKeyHash(h, user);
+    h = SnapshotKeyHash(h, guid);
+    return SnapshotKeyHash(h, path);
+}
+
+class UserAssistSnapshot {
+    std::vector<SnapshotRecord> records;    // Triés par clé
+
+public:
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    void clear() { records.clear(); }
+
+    // Instantané du scan courant (entrées en double : la dernière l'emporte)
+    void Assign(const EntryStore& entries) {
+        records.clear();
+        Merge(entries);
+    }
+
+    // Mise à jour partielle (surveillance incrémentale) : clés stale (triées) retirées, entrées relues ajoutées
+    void Replace(const std::vector<uint64_t>& stale, const EntryStore& entries) {
+        records.erase(std::remove_if(records.begin(), records.end(), [&](const SnapshotRecord& record) {
+            return std::binary_search(stale.begin(), stale.end(), record.key);
+        }), records.end());
+        Merge(entries);
+    }
+
+    // Ajout des entrées puis tri ; à clé égale, la dernière ajoutée l'emporte
+    void Merge(const EntryStore& entries) {
+        records.reserve(records.size() + entries.size());
+        for (size_t row = 0; row < entries.size(); row++) {
+            SnapshotRecord record;
+            record.key = SnapshotKey(entries.Username(row), entries.Guid(row), entries.DecodedPath(row));
+            record.lastExecution = entries.lastExecution[row];
+            record.runCount = entries.runCount[row];
+            record.focusCount = entries.focusCount[row];
+            record.focusTime = entries.focusTime[row];
+            record.status = entries.timeStatus[row];
+            records.push_back(record);
+        }
+        std::stable_sort(records.begin(), records.end());
+        auto last = std::unique(records.rbegin(), records.rend(),
+                                [](const SnapshotRecord& a, const SnapshotRecord& b) { return a.key == b.key; });
+        records.erase(records.begin(), last.base());
+    }
+
+    const SnapshotRecord* Find(uint64_t key) const {
+        SnapshotRecord probe;
+        probe.key = key;
+        auto it = std::lower_bound(records.begin(), records.end(), probe);
+        return it != records.end() && it->key == key ? &*it : nullptr;
+    }
+
+    // Compare un scan à l'instantané : seules les lignes nouvelles ou modifiées sont ajoutées à diffs.
+    // scope : clés relues (triées) pour un scan partiel, les disparues ne sont cherchées que parmi elles
+    SnapshotDiffSummary Diff(const EntryStore& entries, std::vector<EntryDiff>& diffs,
+                             const std::vector<uint64_t>* scope = nullptr) const {
+        SnapshotDiffSummary summary;
+        std::vector<uint8_t> seen(records.size(), 0);
+
+        for (size_t row = 0; row < entries.size(); row++) {
+            uint64_t key = SnapshotKey(entries.Username(row), entries.Guid(row), entries.DecodedPath(row));
+            const SnapshotRecord* previous = Find(key);
+
+            EntryDiff diff;
+            diff.row = static_cast<uint32_t>(row);
+            if (!previous) {
+                diff.change = UA_CHANGE_NEW;
+                diff.runDelta = entries.runCount[row];
+                diff.focusCountDelta = entries.focusCount[row];
+                diff.focusTimeDelta = entries.focusTime[row];
+                diffs.push_back(diff);
+                summary.added++;
+                continue;
+            }
+
+            seen[static_cast<size_t>(previous - records.data())] = 1;
+            diff.change = UA_CHANGE_UPDATED;
+            diff.runDelta = static_cast<int64_t>(entries.runCount[row]) - previous->runCount;
+            diff.focusCountDelta = static_cast<int64_t>(entries.focusCount[row]) - previous->focusCount;
+            diff.focusTimeDelta = static_cast<int64_t>(entries.focusTime[row]) - previous->focusTime;
+            diff.previousLastExecution = previous->lastExecution;
+            diff.previousStatus = previous->status;
+
+            bool moved = entries.lastExecution[row] != previous->lastExecution ||
+                         entries.timeStatus[row] != previous->status;
+            if (diff.runDelta || diff.focusCountDelta || diff.focusTimeDelta || moved) {
+                diffs.push_back(diff);
+                summary.updated++;
+            } else {
+                summary.unchanged++;
+            }
+        }
+
+        if (!scope) {
+            summary.removed = static_cast<size_t>(std::count(seen.begin(), seen.end(), 0));
+            return summary;
+        }
+        for (uint64_t key : *scope) {
+            const SnapshotRecord* previous = Find(key);
+            if (previous && !seen[static_cast<size_t>(previous - records.data())]) {
+                summary.removed++;
+            }
+        }
+        return summary;
+    }
+
+    bool Load(const std::filesystem::path& path, std::string& error) {
+        records.clear();
+        MappedFile file;
+        if (!file.Open(path.c_str())) {
+            error = "ouverture impossible";
+            return false;
+        }
+
+        const uint8_t* data = file.data();
+        size_t size = file.size();
+        if (size < SNAPSHOT_HEADER_SIZE + 4 || ReadLE32(data) != SNAPSHOT_MAGIC ||
+            ReadLE16(data + 4) != SNAPSHOT_VERSION) {
+            error = "format d'instantané invalide";
+            return false;
+        }
+        uint64_t count = ReadLE64(data + 8);
+        if (count > (size - SNAPSHOT_HEADER_SIZE - 4) / SNAPSHOT_RECORD_SIZE ||
+            SNAPSHOT_HEADER_SIZE + count * SNAPSHOT_RECORD_SIZE + 4 != size) {
+            error = "instantané tronqué";
+            return false;
+        }
+        const uint8_t* p = data + SNAPSHOT_HEADER_SIZE;
+        size_t bytes = static_cast<size_t>(count) * SNAPSHOT_RECORD_SIZE;
+        if (Fnv1a32(p, bytes) != ReadLE32(p + bytes)) {
+            error = "somme de contrôle invalide";
+            return false;
+        }
+
+        records.resize(static_cast<size_t>(count));
+        for (auto& record : records) {
+            record.key = ReadLE64(p);
+            record.lastExecution = ReadLE64(p + 8);
+            record.runCount = ReadLE32(p + 16);
+            record.focusCount = ReadLE32(p + 20);
+            record.focusTime = ReadLE32(p + 24);
+            record.status = p[28];
+            p += SNAPSHOT_RECORD_SIZE;
+        }
+        if (!std::is_sorted(records.begin(), records.end())) {
+            records.clear();
+            error = "entrées non triées";
+            return false;
+        }
+        return true;
+    }
+
+    // Écriture dans un fichier temporaire puis renommage : un instantané n'est jamais à moitié écrit
+    bool Save(const std::filesystem::path& path) const {
+        std::string bytes;
+        bytes.reserve(SNAPSHOT_HEADER_SIZE + records.size() * SNAPSHOT_RECORD_SIZE + 4);
+        auto put = [&bytes](uint64_t v, int width) {
+            for (int i = 0; i < width; i++) bytes.push_back(static_cast<char>(v >> (8 * i)));
+        };
+        put(SNAPSHOT_MAGIC, 4);
+        put(SNAPSHOT_VERSION, 2);
+        put(0, 2);
+        put(records.size(), 8);
+        for (const auto& record : records) {
+            put(record.key, 8);
+            put(record.lastExecution, 8);
+            put(record.runCount, 4);
+            put(record.focusCount, 4);
+            put(record.focusTime, 4);
+            put(record.status, 1);
+            put(0, 3);
+        }
+        put(Fnv1a32(reinterpret_cast<const uint8_t*>(bytes.data()) + SNAPSHOT_HEADER_SIZE,
+                                  bytes.size() - SNAPSHOT_HEADER_SIZE), 4);
+
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            FileSink file;
+            if (!file.Open(temp.c_str()) || !file.Write(bytes.data(), bytes.size())) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+};
+
+// Export CSV des différences (mêmes colonnes que l'export complet, précédées du changement et des deltas)
+constexpr std::string_view USERASSIST_DIFF_CSV_HEADER =
+    "Changement,Application,CheminD\xC3\xA9" "cod\xC3\xA9,CompteurEx\xC3\xA9" "c,DeltaEx\xC3\xA9" "c,"
+    "Derni\xC3\xA8reEx\xC3\xA9" "c,Derni\xC3\xA8reEx\xC3\xA9" "cPr\xC3\xA9" "c\xC3\xA9" "dente,"
+    "CompteurFocus,DeltaFocus,TempsFocus,DeltaTempsFocus,GUID,Username,CheminR\xC3\xA9solu";
+
+inline void WriteUserAssistDiffCsvHeader(CsvWriter& csv, bool bom) {
+    if (bom) {
+        csv.writer().Append(UTF8_BOM);
+    }
+    csv.RawRecord(USERASSIST_DIFF_CSV_HEADER);
+}
+
+inline void WriteUserAssistDiffCsvRow(CsvWriter& csv, const EntryStore& entries, const EntryDiff& diff,
+                                      std::wstring& scratch) {
+    size_t row = diff.row;
+    char text[UA_TIME_TEXT_CHARS];
+    auto delta = [&](int64_t value) {
+        int length = std::snprintf(text, sizeof(text), "%+lld", static_cast<long long>(value));
+        csv.Field(text, length > 0 ? static_cast<size_t>(length) : 0);
+    };
+
+    if (diff.change == UA_CHANGE_NEW) {
+        csv.Field(std::string_view("nouvelle"));
+    } else {
+        csv.Field(std::string_view("modifi\xC3\xA9" "e"));
+    }
+    csv.Field(entries.EncodedName(row, scratch));
+    csv.Field(entries.DecodedPath(row));
+    csv.Field(entries.runCount[row]);
+    delta(diff.runDelta);
+    csv.Field(text, entries.FormatLastExecution(row, text));
+    if (diff.change == UA_CHANGE_NEW) {
+        csv.Field(std::string_view());
+    } else {
+        csv.Field(text, FormatLastExecution(diff.previousStatus, diff.previousLastExecution, text));
+    }
+    csv.Field(entries.focusCount[row]);
+    delta(diff.focusCountDelta);
+    csv.Field(text, FormatDuration(entries.focusTime[row], text));
+    delta(diff.focusTimeDelta);
+    csv.Field(entries.Guid(row));
+    csv.Field(entries.Username(row));
+    ResolvedPath resolved = entries.Resolved(row);
+    csv.Field(resolved.folder, resolved.rest);
+    csv.EndRow();
+}
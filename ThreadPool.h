@@ -0,0 +1,177 @@
+/*
+ * ThreadPool - pool de threads à vol de tâches (work-stealing)
+ * Une file par worker : le propriétaire dépile en LIFO, les autres volent en FIFO.
+ * Utilisé par le mode batch pour répartir les hives sur tous les cœurs.
+ * Une exception levée par une tâche est capturée (le worker continue) et relancée par Wait().
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued;     // Tâches en file, pas encore prises
+    std::atomic<size_t> pending;    // Tâches soumises, pas encore terminées
+    std::atomic<size_t> nextQueue;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool stopping;
+    std::exception_ptr failure;     // Première exception d'une tâche (sous sleepLock), relancée par Wait
+
+    // Pool et index du worker courant : un thread d'un autre pool est externe pour celui-ci
+    struct WorkerSlot {
+        const ThreadPool* pool = nullptr;
+        size_t index = SIZE_MAX;
+    };
+
+    static WorkerSlot& CurrentWorker() {
+        static thread_local WorkerSlot slot;
+        return slot;
+    }
+
+    bool PopLocal(size_t self, std::function<void()>& task) {
+        WorkQueue& q = *queues[self];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.tasks.empty()) {
+            return false;
+        }
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        queued--;
+        return true;
+    }
+
+    bool Steal(size_t self, std::function<void()>& task) {
+        for (size_t i = 1; i < queues.size(); i++) {
+            WorkQueue& q = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t self) {
+        CurrentWorker() = WorkerSlot{ this, self };
+        std::function<void()> task;
+
+        while (true) {
+            if (PopLocal(self, task) || Steal(self, task)) {
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(sleepLock);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+                task = nullptr;
+                if (--pending == 0) {
+                    std::lock_guard<std::mutex> guard(sleepLock);
+                    idle.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepLock);
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) {
+                return;
+            }
+        }
+    }
+
+public:
+    // threadCount = 0 : un worker par cœur logique
+    explicit ThreadPool(size_t threadCount = 0)
+        : queued(0), pending(0), nextQueue(0), stopping(false) {
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+
+        for (size_t i = 0; i < threadCount; i++) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // Index du worker appelant dans [0, size()), SIZE_MAX hors de ce pool (données par worker)
+    size_t WorkerIndex() const {
+        const WorkerSlot& slot = CurrentWorker();
+        return slot.pool == this ? slot.index : SIZE_MAX;
+    }
+
+    // Depuis un worker de ce pool la tâche va dans sa propre file, sinon répartition round-robin
+    void Submit(std::function<void()> task) {
+        size_t target = WorkerIndex();
+        if (target >= queues.size()) {
+            target = nextQueue++ % queues.size();
+        }
+
+        pending++;
+        queued++;
+        {
+            WorkQueue& q = *queues[target];
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.tasks.push_back(std::move(task));
+        }
+
+        std::lock_guard<std::mutex> guard(sleepLock);
+        wake.notify_one();
+    }
+
+    // Attend la fin de toutes les tâches soumises (y compris celles soumises entre-temps) ;
+    // relance la première exception levée par une tâche depuis le Wait précédent
+    void Wait() {
+        std::unique_lock<std::mutex> lock(sleepLock);
+        idle.wait(lock, [this] { return pending.load() == 0; });
+        if (failure) {
+            std::exception_ptr error = std::move(failure);
+            failure = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+};
@@ -0,0 +1,467 @@
+/*
+ * TimelineFormat - sortie binaire colonnaire de la timeline UserAssist (.uatl)
+ * Pour les moteurs d'analyse : pas de re-parsing CSV, lecture sélective par colonne
+ * et élimination des groupes de lignes hors de l'intervalle de temps demandé.
+ *
+ * Disposition (little-endian) :
+ *   En-tête   "UATL" | version u16 | nb colonnes u16 | réservé u64
+ *   Groupes   jusqu'à TIMELINE_GROUP_ROWS lignes ; chaque colonne est un bloc aligné sur 8 octets :
+ *             path/guid/user u32 (ID du dictionnaire du groupe), runCount/focusCount/focusTime u32,
+ *             lastExecution u64 (FILETIME brut), timeStatus u8,
+ *             dictionnaire : offsets u32[n + 1] puis chaînes UTF-8 concaténées
+ *   Pied      nb groupes u32 | nb colonnes u32 | par groupe : offset u64, lignes u32, entrées dict u32,
+ *             min/max lastExecution u64 (lignes à date valide), puis par colonne offset u64, taille u64,
+ *             FNV-1a u32, réservé u32
+ *   Fin       offset du pied u64 | taille du pied u32 | "UATL"
+ *
+ * Le pied est écrit en dernier : la sortie peut être un flux (stdout) et les groupes
+ * produits en parallèle puis ajoutés dans un ordre quelconque.
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr uint32_t TIMELINE_MAGIC = 0x4C544155;     // "UATL"
+constexpr uint16_t TIMELINE_VERSION = 1;
+constexpr size_t TIMELINE_HEADER_SIZE = 16;
+constexpr size_t TIMELINE_TRAILER_SIZE = 16;
+constexpr size_t TIMELINE_GROUP_ROWS = 65536;
+constexpr uint64_t TIMELINE_NO_TIME_MIN = UINT64_MAX;  // Groupe sans date valide : min > max
+
+enum TimelineColumn : uint32_t {
+    TL_COL_PATH = 0,
+    TL_COL_GUID,
+    TL_COL_USER,
+    TL_COL_RUN_COUNT,
+    TL_COL_FOCUS_COUNT,
+    TL_COL_FOCUS_TIME,
+    TL_COL_LAST_EXECUTION,
+    TL_COL_TIME_STATUS,
+    TL_COL_DICT_OFFSETS,
+    TL_COL_DICT_DATA,
+    TL_COLUMN_COUNT
+};
+
+constexpr size_t TIMELINE_GROUP_INFO_SIZE = 32 + TL_COLUMN_COUNT * 24;
+
+// Largeur d'un élément par colonne (0 = données du dictionnaire, taille libre)
+inline size_t TimelineColumnWidth(uint32_t column) {
+    static const uint8_t widths[TL_COLUMN_COUNT] = { 4, 4, 4, 4, 4, 4, 8, 1, 4, 0 };
+    return column < TL_COLUMN_COUNT ? widths[column] : 0;
+}
+
+inline const char* TimelineColumnName(uint32_t column) {
+    static const char* names[TL_COLUMN_COUNT] = { "path", "guid", "user", "run", "focus", "focustime",
+                                                  "time", "status", "dictoffsets", "dictdata" };
+    return column < TL_COLUMN_COUNT ? names[column] : "?";
+}
+
+struct TimelineChunk {
+    uint64_t offset = 0;        // Absolu dans le fichier (relatif au groupe pendant la construction)
+    uint64_t size = 0;
+    uint32_t checksum = 0;
+};
+
+struct TimelineGroupInfo {
+    uint64_t offset = 0;
+    uint32_t rows = 0;
+    uint32_t dictCount = 0;
+    uint64_t minTime = TIMELINE_NO_TIME_MIN;
+    uint64_t maxTime = 0;
+    TimelineChunk chunks[TL_COLUMN_COUNT];
+
+    bool Overlaps(uint64_t from, uint64_t to) const { return minTime <= to && maxTime >= from; }
+};
+
+inline void PutLE16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v));
+    out.push_back(static_cast<char>(v >> 8));
+}
+
+inline void PutLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+inline void PutLE64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<char>(v >> (8 * i)));
+}
+
+// Construction d'un groupe de lignes depuis un EntryStore (un builder par thread, buffers réutilisés)
+class TimelineGroupBuilder {
+    std::string bytes;
+    TimelineGroupInfo info;
+
+    // Remappage ID du pool → ID du dictionnaire du groupe (tampon de génération, pas de remise à zéro)
+    std::vector<uint32_t> localIds;
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+    std::vector<uint32_t> dictionary;       // ID du pool par ID local
+
+    uint32_t LocalId(uint32_t poolId) {
+        if (poolId >= stamps.size()) {
+            stamps.resize(poolId + 1, 0);
+            localIds.resize(poolId + 1, 0);
+        }
+        if (stamps[poolId] != generation) {
+            stamps[poolId] = generation;
+            localIds[poolId] = static_cast<uint32_t>(dictionary.size());
+            dictionary.push_back(poolId);
+        }
+        return localIds[poolId];
+    }
+
+    void BeginChunk(uint32_t column) {
+        while (bytes.size() % 8) {
+            bytes.push_back('\0');
+        }
+        info.chunks[column].offset = bytes.size();
+    }
+
+    void EndChunk(uint32_t column) {
+        TimelineChunk& chunk = info.chunks[column];
+        chunk.size = bytes.size() - chunk.offset;
+        chunk.checksum = Fnv1a32(reinterpret_cast<const uint8_t*>(bytes.data()) + chunk.offset,
+                                 static_cast<size_t>(chunk.size));
+    }
+
+    template <typename T>
+    void WriteColumn(uint32_t column, const T* values, size_t count) {
+        BeginChunk(column);
+        for (size_t i = 0; i < count; i++) {
+            if (sizeof(T) == 8) PutLE64(bytes, static_cast<uint64_t>(values[i]));
+            else if (sizeof(T) == 4) PutLE32(bytes, static_cast<uint32_t>(values[i]));
+            else bytes.push_back(static_cast<char>(values[i]));
+        }
+        EndChunk(column);
+    }
+
+    void WriteIdColumn(uint32_t column, const uint32_t* poolIds, size_t count) {
+        BeginChunk(column);
+        for (size_t i = 0; i < count; i++) {
+            PutLE32(bytes, LocalId(poolIds[i]));
+        }
+        EndChunk(column);
+    }
+
+public:
+    // Lignes [first, first + count) ; les offsets des blocs sont relatifs au début du groupe
+    void Build(const EntryStore& store, size_t first, size_t count) {
+        bytes.clear();
+        info = TimelineGroupInfo();
+        info.rows = static_cast<uint32_t>(count);
+        dictionary.clear();
+        if (++generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0u);
+            generation = 1;
+        }
+
+        WriteIdColumn(TL_COL_PATH, store.pathId.data() + first, count);
+        WriteIdColumn(TL_COL_GUID, store.guidId.data() + first, count);
+        WriteIdColumn(TL_COL_USER, store.userId.data() + first, count);
+        WriteColumn(TL_COL_RUN_COUNT, store.runCount.data() + first, count);
+        WriteColumn(TL_COL_FOCUS_COUNT, store.focusCount.data() + first, count);
+        WriteColumn(TL_COL_FOCUS_TIME, store.focusTime.data() + first, count);
+        WriteColumn(TL_COL_LAST_EXECUTION, store.lastExecution.data() + first, count);
+        WriteColumn(TL_COL_TIME_STATUS, store.timeStatus.data() + first, count);
+
+        for (size_t row = first; row < first + count; row++) {
+            uint64_t ft = store.lastExecution[row];
+            if (store.timeStatus[row] == UA_TIME_VALID && ft != 0 && ft <= FILETIME_MAX_VALID) {
+                if (ft < info.minTime) info.minTime = ft;
+                if (ft > info.maxTime) info.maxTime = ft;
+            }
+        }
+
+        // Dictionnaire : chaînes UTF-8 écrites à la suite, offsets de fin cumulés
+        info.dictCount = static_cast<uint32_t>(dictionary.size());
+        std::string text;
+        std::vector<uint32_t> ends;
+        ends.reserve(dictionary.size() + 1);
+        ends.push_back(0);
+        for (uint32_t poolId : dictionary) {
+            std::wstring_view s = store.strings.Get(poolId);
+            AppendUtf8(text, s.data(), s.size());
+            ends.push_back(static_cast<uint32_t>(text.size()));
+        }
+        WriteColumn(TL_COL_DICT_OFFSETS, ends.data(), ends.size());
+        BeginChunk(TL_COL_DICT_DATA);
+        bytes += text;
+        EndChunk(TL_COL_DICT_DATA);
+        while (bytes.size() % 8) {
+            bytes.push_back('\0');
+        }
+    }
+
+    const std::string& data() const { return bytes; }
+    const TimelineGroupInfo& group() const { return info; }
+};
+
+// Écriture du fichier : en-tête, groupes (ajout thread-safe), pied
+class TimelineWriter {
+    ByteSink& sink;
+    std::mutex lock;
+    std::vector<TimelineGroupInfo> groups;
+    uint64_t position = 0;
+    bool failed = false;
+
+    bool Put(const std::string& data) {
+        if (!failed && !sink.Write(data.data(), data.size())) {
+            failed = true;
+        }
+        position += data.size();
+        return !failed;
+    }
+
+public:
+    explicit TimelineWriter(ByteSink& target) : sink(target) {}
+
+    bool Begin() {
+        std::string header;
+        PutLE32(header, TIMELINE_MAGIC);
+        PutLE16(header, TIMELINE_VERSION);
+        PutLE16(header, TL_COLUMN_COUNT);
+        PutLE64(header, 0);
+        std::lock_guard<std::mutex> guard(lock);
+        return Put(header);
+    }
+
+    bool Append(const TimelineGroupBuilder& builder) {
+        if (builder.group().rows == 0) {
+            return true;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        TimelineGroupInfo info = builder.group();
+        info.offset = position;
+        for (auto& chunk : info.chunks) {
+            chunk.offset += position;
+        }
+        groups.push_back(info);
+        return Put(builder.data());
+    }
+
+    // Tous les groupes d'un EntryStore
+    bool Append(const EntryStore& store, TimelineGroupBuilder& builder) {
+        for (size_t first = 0; first < store.size(); first += TIMELINE_GROUP_ROWS) {
+            size_t count = store.size() - first < TIMELINE_GROUP_ROWS ? store.size() - first : TIMELINE_GROUP_ROWS;
+            builder.Build(store, first, count);
+            if (!Append(builder)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Finish() {
+        std::lock_guard<std::mutex> guard(lock);
+        std::string footer;
+        PutLE32(footer, static_cast<uint32_t>(groups.size()));
+        PutLE32(footer, TL_COLUMN_COUNT);
+        for (const auto& g : groups) {
+            PutLE64(footer, g.offset);
+            PutLE32(footer, g.rows);
+            PutLE32(footer, g.dictCount);
+            PutLE64(footer, g.minTime);
+            PutLE64(footer, g.maxTime);
+            for (const auto& chunk : g.chunks) {
+                PutLE64(footer, chunk.offset);
+                PutLE64(footer, chunk.size);
+                PutLE32(footer, chunk.checksum);
+                PutLE32(footer, 0);
+            }
+        }
+
+        std::string trailer;
+        PutLE64(trailer, position);
+        PutLE32(trailer, static_cast<uint32_t>(footer.size()));
+        PutLE32(trailer, TIMELINE_MAGIC);
+        return Put(footer) && Put(trailer);
+    }
+
+    uint64_t rows() {
+        std::lock_guard<std::mutex> guard(lock);
+        uint64_t total = 0;
+        for (const auto& g : groups) total += g.rows;
+        return total;
+    }
+};
+
+// Lecture sans copie d'un fichier .uatl mappé (les colonnes sont des vues dans le mapping)
+class TimelineReader {
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    std::vector<TimelineGroupInfo> groupInfos;
+
+public:
+    template <typename T>
+    struct ColumnView {
+        const T* data;
+        size_t count;
+        T operator[](size_t i) const {
+            T value;
+            std::memcpy(&value, data + i, sizeof(T));   // Format little-endian, hôte supposé LE
+            return value;
+        }
+    };
+
+    // Contrôle de structure : en-tête, pied et bornes de chaque bloc
+    bool Open(const uint8_t* data, size_t size, std::string& error) {
+        base = data;
+        length = size;
+        groupInfos.clear();
+
+        if (size < TIMELINE_HEADER_SIZE + TIMELINE_TRAILER_SIZE || ReadLE32(data) != TIMELINE_MAGIC) {
+            error = "en-tête UATL absent";
+            return false;
+        }
+        if (ReadLE16(data + 4) != TIMELINE_VERSION || ReadLE16(data + 6) != TL_COLUMN_COUNT) {
+            error = "version ou nombre de colonnes non supporté";
+            return false;
+        }
+        const uint8_t* trailer = data + size - TIMELINE_TRAILER_SIZE;
+        uint64_t footerOffset = ReadLE64(trailer);
+        uint32_t footerSize = ReadLE32(trailer + 8);
+        if (ReadLE32(trailer + 12) != TIMELINE_MAGIC || footerOffset < TIMELINE_HEADER_SIZE ||
+            footerOffset + footerSize != size - TIMELINE_TRAILER_SIZE || footerSize < 8) {
+            error = "pied de fichier invalide (fichier tronqué ?)";
+            return false;
+        }
+
+        const uint8_t* footer = data + footerOffset;
+        uint32_t groupCount = ReadLE32(footer);
+        if (ReadLE32(footer + 4) != TL_COLUMN_COUNT ||
+            8 + static_cast<uint64_t>(groupCount) * TIMELINE_GROUP_INFO_SIZE != footerSize) {
+            error = "pied de fichier incohérent";
+            return false;
+        }
+
+        groupInfos.resize(groupCount);
+        const uint8_t* p = footer + 8;
+        for (auto& g : groupInfos) {
+            g.offset = ReadLE64(p);
+            g.rows = ReadLE32(p + 8);
+            g.dictCount = ReadLE32(p + 12);
+            g.minTime = ReadLE64(p + 16);
+            g.maxTime = ReadLE64(p + 24);
+            p += 32;
+            for (uint32_t c = 0; c < TL_COLUMN_COUNT; c++, p += 24) {
+                TimelineChunk& chunk = g.chunks[c];
+                chunk.offset = ReadLE64(p);
+                chunk.size = ReadLE64(p + 8);
+                chunk.checksum = ReadLE32(p + 16);
+
+                uint64_t expected = c == TL_COL_DICT_OFFSETS ? (static_cast<uint64_t>(g.dictCount) + 1) * 4
+                                  : c == TL_COL_DICT_DATA ? chunk.size
+                                  : static_cast<uint64_t>(g.rows) * TimelineColumnWidth(c);
+                if (chunk.offset % 8 || chunk.offset < TIMELINE_HEADER_SIZE || chunk.size > footerOffset ||
+                    chunk.offset > footerOffset - chunk.size || chunk.size != expected) {
+                    error = "bloc hors limites ou de taille invalide (colonne " +
+                            std::string(TimelineColumnName(c)) + ")";
+                    groupInfos.clear();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    size_t groups() const { return groupInfos.size(); }
+    const TimelineGroupInfo& group(size_t g) const { return groupInfos[g]; }
+
+    uint64_t rows() const {
+        uint64_t total = 0;
+        for (const auto& g : groupInfos) total += g.rows;
+        return total;
+    }
+
+    template <typename T>
+    ColumnView<T> Column(size_t g, uint32_t column) const {
+        const TimelineChunk& chunk = groupInfos[g].chunks[column];
+        return ColumnView<T>{ reinterpret_cast<const T*>(base + chunk.offset),
+                              static_cast<size_t>(chunk.size / sizeof(T)) };
+    }
+
+    // Chaîne UTF-8 du dictionnaire du groupe (vue vide si ID invalide)
+    std::string_view DictString(size_t g, uint32_t id) const {
+        const TimelineGroupInfo& info = groupInfos[g];
+        if (id >= info.dictCount) {
+            return std::string_view();
+        }
+        ColumnView<uint32_t> offsets = Column<uint32_t>(g, TL_COL_DICT_OFFSETS);
+        uint32_t begin = offsets[id], end = offsets[id + 1];
+        const TimelineChunk& text = info.chunks[TL_COL_DICT_DATA];
+        if (begin > end || end > text.size) {
+            return std::string_view();
+        }
+        return std::string_view(reinterpret_cast<const char*>(base + text.offset) + begin, end - begin);
+    }
+
+    // Vérification complète : sommes de contrôle, ID de dictionnaire, offsets, statistiques min/max
+    bool Verify(std::string& error) const {
+        for (size_t g = 0; g < groupInfos.size(); g++) {
+            const TimelineGroupInfo& info = groupInfos[g];
+            std::string where = "groupe " + std::to_string(g) + " : ";
+
+            for (uint32_t c = 0; c < TL_COLUMN_COUNT; c++) {
+                const TimelineChunk& chunk = info.chunks[c];
+                if (Fnv1a32(base + chunk.offset, static_cast<size_t>(chunk.size)) != chunk.checksum) {
+                    error = where + "somme de contrôle invalide (colonne " + TimelineColumnName(c) + ")";
+                    return false;
+                }
+            }
+
+            ColumnView<uint32_t> offsets = Column<uint32_t>(g, TL_COL_DICT_OFFSETS);
+            if (offsets[0] != 0 || offsets[info.dictCount] != info.chunks[TL_COL_DICT_DATA].size) {
+                error = where + "offsets du dictionnaire invalides";
+                return false;
+            }
+            for (uint32_t i = 0; i < info.dictCount; i++) {
+                if (offsets[i] > offsets[i + 1]) {
+                    error = where + "offsets du dictionnaire non croissants";
+                    return false;
+                }
+            }
+
+            for (uint32_t c : { TL_COL_PATH, TL_COL_GUID, TL_COL_USER }) {
+                ColumnView<uint32_t> ids = Column<uint32_t>(g, c);
+                for (size_t i = 0; i < ids.count; i++) {
+                    if (ids[i] >= info.dictCount) {
+                        error = where + "ID hors dictionnaire (colonne " + TimelineColumnName(c) + ")";
+                        return false;
+                    }
+                }
+            }
+
+            ColumnView<uint64_t> times = Column<uint64_t>(g, TL_COL_LAST_EXECUTION);
+            ColumnView<uint8_t> status = Column<uint8_t>(g, TL_COL_TIME_STATUS);
+            uint64_t minTime = TIMELINE_NO_TIME_MIN, maxTime = 0;
+            for (size_t i = 0; i < times.count; i++) {
+                uint64_t ft = times[i];
+                if (status[i] > UA_TIME_INVALID) {
+                    error = where + "état de date inconnu";
+                    return false;
+                }
+                if (status[i] == UA_TIME_VALID && ft != 0 && ft <= FILETIME_MAX_VALID) {
+                    if (ft < minTime) minTime = ft;
+                    if (ft > maxTime) maxTime = ft;
+                }
+            }
+            if (minTime != info.minTime || maxTime != info.maxTime) {
+                error = where + "statistiques min/max incohérentes";
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,526 @@
+/*
+ * TimelineMerge - timeline globale "qui a exécuté quoi, quand" d'un parc plus grand que la mémoire
+ * Tri externe : chaque worker accumule ses lignes dans un tampon borné, le trie par date de dernière
+ * exécution et le déverse en run sur disque quand il est plein ; les runs (et les tampons restants,
+ * triés en mémoire) sont ensuite fusionnés k voies par un arbre des perdants en un seul flux ordonné.
+ *
+ * - Mémoire : la moitié du budget pour les tampons de tri (répartie entre workers), l'autre moitié
+ *   pour les tampons de lecture de la fusion ; au-delà de fanIn runs, passes intermédiaires
+ * - Ordre : FILETIME croissant ("Jamais" en tête), lignes sans date valide en fin ; égalités départagées
+ *   par hive puis par ligne, identique quel que soit le nombre de threads
+ * - Runs : fichiers temporaires propres au processus, supprimés après fusion (ou à la destruction)
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+constexpr uint64_t TIMELINE_UNDATED = UINT64_MAX;               // Clé des lignes sans date valide
+constexpr size_t TIMELINE_MIN_READ_BUFFER = 64 * 1024;
+constexpr size_t TIMELINE_MAX_READ_BUFFER = 4 * 1024 * 1024;
+constexpr size_t TIMELINE_WRITE_BUFFER = 1024 * 1024;
+
+struct TimelineMergeOptions {
+    uint64_t memoryBudget = 256ull << 20;   // Tampons de tri et de fusion, tous workers confondus
+    std::filesystem::path directory;        // Runs (vide = dossier temporaire du système)
+    size_t fanIn = 64;                      // Runs fusionnés à la fois (fichiers ouverts)
+};
+
+// En-tête d'un enregistrement, suivi des chaînes (wchar_t) chemin décodé, GUID, utilisateur ;
+// taille totale multiple de 8 (en-têtes alignés dans les tampons comme dans les runs)
+struct TimelineRecord {
+    uint64_t key;               // lastExecution si date valide, TIMELINE_UNDATED sinon
+    uint64_t origin;            // Hachage du chemin de la hive
+    uint32_t row;
+    uint32_t pathLength;
+    uint32_t guidLength;
+    uint32_t userLength;
+    UserAssistCounters counters;
+    uint8_t knownFolder;
+    uint8_t reserved[7];
+
+    size_t Size() const {
+        size_t size = sizeof(TimelineRecord) + (size_t(pathLength) + guidLength + userLength) * sizeof(wchar_t);
+        return (size + 7) & ~size_t(7);
+    }
+};
+
+static_assert(sizeof(TimelineRecord) % 8 == 0, "TimelineRecord doit rester aligné sur 8 octets");
+
+inline bool TimelineBefore(const TimelineRecord& a, const TimelineRecord& b) {
+    if (a.key != b.key) return a.key < b.key;
+    if (a.origin != b.origin) return a.origin < b.origin;
+    return a.row < b.row;
+}
+
+// Vue d'un enregistrement (valide tant que la source n'avance pas)
+struct TimelineRow {
+    const TimelineRecord* record;
+    std::wstring_view path;
+    std::wstring_view guid;
+    std::wstring_view user;
+};
+
+inline TimelineRow ViewTimelineRecord(const uint8_t* bytes) {
+    const auto* record = reinterpret_cast<const TimelineRecord*>(bytes);
+    const auto* text = reinterpret_cast<const wchar_t*>(bytes + sizeof(TimelineRecord));
+    TimelineRow row;
+    row.record = record;
+    row.path = std::wstring_view(text, record->pathLength);
+    row.guid = std::wstring_view(text + record->pathLength, record->guidLength);
+    row.user = std::wstring_view(text + record->pathLength + record->guidLength, record->userLength);
+    return row;
+}
+
+// Tampon de tri d'un worker : enregistrements contigus + clés compactes triées
+class TimelineSorter {
+    struct SortKey {
+        uint64_t key;
+        uint64_t origin;
+        uint64_t offset;
+        uint32_t row;
+        uint32_t reserved;
+    };
+
+    std::vector<uint8_t> arena;
+    std::vector<SortKey> keys;
+    uint64_t budget;
+
+public:
+    explicit TimelineSorter(uint64_t bytes) : budget(bytes) {}
+
+    uint64_t Bytes() const { return arena.size() + keys.size() * sizeof(SortKey); }
+    size_t size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+
+    // Un enregistrement de size octets tient-il encore dans le budget ?
+    bool Fits(size_t size) const { return empty() || Bytes() + size + sizeof(SortKey) <= budget; }
+
+    void Add(const TimelineRecord& header, std::wstring_view path, std::wstring_view guid, std::wstring_view user) {
+        if (arena.capacity() == 0) {
+            arena.reserve(static_cast<size_t>(budget));
+        }
+        size_t offset = arena.size();
+        size_t size = header.Size();
+        arena.resize(offset + size);
+        uint8_t* p = arena.data() + offset;
+        std::memcpy(p, &header, sizeof(TimelineRecord));
+        p += sizeof(TimelineRecord);
+        for (std::wstring_view text : { path, guid, user }) {
+            std::memcpy(p, text.data(), text.size() * sizeof(wchar_t));
+            p += text.size() * sizeof(wchar_t);
+        }
+        keys.push_back({ header.key, header.origin, offset, header.row, 0 });
+    }
+
+    void Sort() {
+        std::sort(keys.begin(), keys.end(), [](const SortKey& a, const SortKey& b) {
+            if (a.key != b.key) return a.key < b.key;
+            if (a.origin != b.origin) return a.origin < b.origin;
+            return a.row < b.row;
+        });
+    }
+
+    // Enregistrement de rang i après Sort()
+    const uint8_t* Record(size_t i) const { return arena.data() + keys[i].offset; }
+
+    void clear() {
+        arena.clear();
+        keys.clear();
+    }
+};
+
+// Source ordonnée de la fusion : tampon trié ou run sur disque
+class TimelineSource {
+public:
+    const uint8_t* current = nullptr;   // nullptr : source épuisée
+    bool failed = false;
+
+    virtual ~TimelineSource() = default;
+
+    // Avance à l'enregistrement suivant ; false en fin de source (ou sur erreur : failed)
+    virtual bool Next() = 0;
+
+    const TimelineRecord& Record() const { return *reinterpret_cast<const TimelineRecord*>(current); }
+};
+
+class TimelineMemorySource : public TimelineSource {
+    const TimelineSorter& sorter;
+    size_t index = 0;
+
+public:
+    explicit TimelineMemorySource(const TimelineSorter& s) : sorter(s) {}
+
+    bool Next() override {
+        current = index < sorter.size() ? sorter.Record(index++) : nullptr;
+        return current != nullptr;
+    }
+};
+
+class TimelineFileSource : public TimelineSource {
+    std::ifstream in;
+    std::vector<uint8_t> buffer;
+    size_t pos = 0;
+    size_t fill = 0;
+    size_t currentSize = 0;
+
+    // Au moins n octets disponibles à partir de pos (compactage puis lecture)
+    bool Ensure(size_t n) {
+        if (fill - pos >= n) {
+            return true;
+        }
+        std::memmove(buffer.data(), buffer.data() + pos, fill - pos);
+        fill -= pos;
+        pos = 0;
+        if (buffer.size() < n) {
+            buffer.resize(n);
+        }
+        while (fill < n && in) {
+            in.read(reinterpret_cast<char*>(buffer.data() + fill), static_cast<std::streamsize>(buffer.size() - fill));
+            fill += static_cast<size_t>(in.gcount());
+        }
+        return fill >= n;
+    }
+
+public:
+    TimelineFileSource(const std::filesystem::path& path, size_t bufferSize)
+        : in(path, std::ios::binary), buffer(bufferSize) {
+        failed = !in.is_open();
+    }
+
+    bool Next() override {
+        pos += currentSize;
+        currentSize = 0;
+        current = nullptr;
+        if (failed || !Ensure(sizeof(TimelineRecord))) {
+            failed = failed || fill != pos;     // Octets restants : run tronqué
+            return false;
+        }
+        size_t size = reinterpret_cast<const TimelineRecord*>(buffer.data() + pos)->Size();
+        if (!Ensure(size)) {
+            failed = true;
+            return false;
+        }
+        current = buffer.data() + pos;
+        currentSize = size;
+        return true;
+    }
+};
+
+// Écriture séquentielle d'un run
+class TimelineRunWriter {
+    FileSink file;
+    std::vector<uint8_t> buffer;
+    size_t used = 0;
+    bool failed = false;
+
+public:
+    uint64_t written = 0;
+
+    bool Open(const std::filesystem::path& path) {
+        buffer.resize(TIMELINE_WRITE_BUFFER);
+        failed = !file.Open(path.c_str());
+        return !failed;
+    }
+
+    void Write(const uint8_t* data, size_t size) {
+        if (used + size > buffer.size()) {
+            failed = failed || (used && !file.Write(reinterpret_cast<const char*>(buffer.data()), used));
+            used = 0;
+            if (size > buffer.size()) {
+                failed = failed || !file.Write(reinterpret_cast<const char*>(data), size);
+                written += size;
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+        written += size;
+    }
+
+    bool Close() {
+        failed = failed || (used && !file.Write(reinterpret_cast<const char*>(buffer.data()), used));
+        used = 0;
+        file.Close();
+        return !failed;
+    }
+};
+
+// Fusion k voies par arbre des perdants : log2(k) comparaisons par enregistrement émis.
+// emit(const uint8_t* record) → false pour arrêter ; false si une source est en échec
+template <typename Emit>
+bool MergeTimelineSources(std::vector<std::unique_ptr<TimelineSource>>& sources, Emit&& emit) {
+    size_t k = sources.size();
+    if (k == 0) {
+        return true;
+    }
+    for (auto& source : sources) {
+        source->Next();
+    }
+    // Source épuisée : plus grande que toute autre ; à égalité, la source de rang le plus faible
+    auto before = [&](size_t a, size_t b) {
+        const uint8_t* x = sources[a]->current;
+        const uint8_t* y = sources[b]->current;
+        if (!x || !y) return x != nullptr || (y == nullptr && a < b);
+        const auto& rx = *reinterpret_cast<const TimelineRecord*>(x);
+        const auto& ry = *reinterpret_cast<const TimelineRecord*>(y);
+        if (TimelineBefore(rx, ry)) return true;
+        if (TimelineBefore(ry, rx)) return false;
+        return a < b;
+    };
+
+    // tree[0] : vainqueur ; tree[1..k-1] : perdant de chaque match (feuille i en position k + i)
+    std::vector<size_t> tree(k);
+    std::vector<size_t> winners(2 * k);
+    for (size_t i = 0; i < k; i++) {
+        winners[k + i] = i;
+    }
+    for (size_t node = k - 1; node >= 1; node--) {
+        size_t a = winners[2 * node];
+        size_t b = winners[2 * node + 1];
+        bool first = before(a, b);
+        winners[node] = first ? a : b;
+        tree[node] = first ? b : a;
+    }
+    tree[0] = k > 1 ? winners[1] : 0;
+
+    for (;;) {
+        size_t winner = tree[0];
+        if (!sources[winner]->current) {
+            break;
+        }
+        if (!emit(sources[winner]->current)) {
+            return true;
+        }
+        sources[winner]->Next();
+        if (sources[winner]->failed) {
+            return false;
+        }
+        // Rejoue les matchs de la feuille jusqu'à la racine
+        for (size_t node = (k + winner) / 2; node >= 1; node /= 2) {
+            if (before(tree[node], winner)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+    for (const auto& source : sources) {
+        if (source->failed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Timeline globale : un TimelineSorter par worker, runs partagés, fusion finale sur le thread appelant
+class ExternalTimeline {
+    TimelineMergeOptions options;
+    std::vector<std::unique_ptr<TimelineSorter>> sorters;
+    std::mutex runLock;
+    std::vector<std::filesystem::path> runs;
+    std::string firstError;
+    std::atomic<uint64_t> runCount{0};
+    std::atomic<uint64_t> spilledBytes{0};
+    std::atomic<uint64_t> records{0};
+    size_t passes = 0;
+
+    std::filesystem::path NextRunPath() {
+        static std::atomic<uint64_t> sequence{0};
+#ifdef _WIN32
+        unsigned long pid = GetCurrentProcessId();
+#else
+        unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+        char name[64];
+        std::snprintf(name, sizeof(name), "uatimeline-%lu-%llu.run", pid,
+                      static_cast<unsigned long long>(sequence.fetch_add(1)));
+        return options.directory / name;
+    }
+
+    void Fail(const std::string& error) {
+        std::lock_guard<std::mutex> lock(runLock);
+        if (firstError.empty()) {
+            firstError = error;
+        }
+    }
+
+    // Tampon trié écrit en run, puis vidé
+    void Spill(TimelineSorter& sorter) {
+        sorter.Sort();
+        std::filesystem::path path = NextRunPath();
+        TimelineRunWriter writer;
+        if (writer.Open(path)) {
+            for (size_t i = 0; i < sorter.size(); i++) {
+                const uint8_t* record = sorter.Record(i);
+                writer.Write(record, reinterpret_cast<const TimelineRecord*>(record)->Size());
+            }
+        }
+        bool ok = writer.Close();
+        {
+            std::lock_guard<std::mutex> lock(runLock);
+            runs.push_back(path);       // Supprimé à la destruction même en échec
+        }
+        if (!ok) {
+            Fail("écriture du run " + path.u8string() + " impossible (espace disque ?)");
+        }
+        runCount++;
+        spilledBytes += writer.written;
+        sorter.clear();
+    }
+
+    bool MergeFiles(const std::vector<std::filesystem::path>& inputs, size_t bufferSize,
+                    const std::filesystem::path& output, std::string& error) {
+        std::vector<std::unique_ptr<TimelineSource>> sources;
+        for (const auto& input : inputs) {
+            sources.push_back(std::make_unique<TimelineFileSource>(input, bufferSize));
+        }
+        TimelineRunWriter writer;
+        if (!writer.Open(output)) {
+            error = "création du run " + output.u8string() + " impossible";
+            return false;
+        }
+        bool ok = MergeTimelineSources(sources, [&](const uint8_t* record) {
+            writer.Write(record, reinterpret_cast<const TimelineRecord*>(record)->Size());
+            return true;
+        });
+        if (!writer.Close() || !ok) {
+            error = ok ? "écriture du run " + output.u8string() + " impossible (espace disque ?)"
+                       : "run de timeline illisible ou tronqué";
+            return false;
+        }
+        spilledBytes += writer.written;
+        return true;
+    }
+
+public:
+    ExternalTimeline(const TimelineMergeOptions& opts, size_t workers) : options(opts) {
+        if (options.directory.empty()) {
+            std::error_code ec;
+            options.directory = std::filesystem::temp_directory_path(ec);
+        }
+        options.fanIn = std::max<size_t>(options.fanIn, 2);
+        uint64_t perWorker = std::max<uint64_t>(options.memoryBudget / 2 / std::max<size_t>(workers, 1), 1 << 18);
+        for (size_t i = 0; i < workers; i++) {
+            sorters.push_back(std::make_unique<TimelineSorter>(perWorker));
+        }
+    }
+
+    ExternalTimeline(const ExternalTimeline&) = delete;
+    ExternalTimeline& operator=(const ExternalTimeline&) = delete;
+
+    ~ExternalTimeline() {
+        std::error_code ec;
+        for (const auto& run : runs) {
+            std::filesystem::remove(run, ec);
+        }
+    }
+
+    const std::filesystem::path& Directory() const { return options.directory; }
+    uint64_t Records() const { return records.load(); }
+    uint64_t Runs() const { return runCount.load(); }
+    uint64_t SpilledBytes() const { return spilledBytes.load(); }
+    size_t Passes() const { return passes; }
+
+    // Lignes d'une hive (worker = pool.WorkerIndex() du pool appelant) ; origin départage les dates égales
+    void Add(size_t worker, const EntryStore& entries, uint64_t origin) {
+        TimelineSorter& sorter = *sorters[worker];
+        TimelineRecord header = {};
+        header.origin = origin;
+        for (size_t row = 0; row < entries.size(); row++) {
+            std::wstring_view path = entries.DecodedPath(row);
+            std::wstring_view guid = entries.Guid(row);
+            std::wstring_view user = entries.Username(row);
+            header.counters = entries.Counters(row);
+            header.key = header.counters.status == UA_TIME_VALID ? header.counters.lastExecution : TIMELINE_UNDATED;
+            header.row = static_cast<uint32_t>(row);
+            header.pathLength = static_cast<uint32_t>(path.size());
+            header.guidLength = static_cast<uint32_t>(guid.size());
+            header.userLength = static_cast<uint32_t>(user.size());
+            header.knownFolder = entries.knownFolder[row];
+            if (!sorter.Fits(header.Size())) {
+                Spill(sorter);
+            }
+            sorter.Add(header, path, guid, user);
+        }
+        records += entries.size();
+    }
+
+    // Après tous les Add : flux unique ordonné ; emit(const TimelineRow&) → false pour arrêter
+    template <typename Emit>
+    bool Merge(Emit&& emit, std::string& error) {
+        if (!firstError.empty()) {
+            error = firstError;
+            return false;
+        }
+
+        // Passes intermédiaires tant qu'il y a plus de runs que fanIn
+        size_t readBudget = static_cast<size_t>(options.memoryBudget / 2);
+        auto bufferFor = [&](size_t count) {
+            size_t size = readBudget / std::max<size_t>(count, 1);
+            return std::min(std::max(size, TIMELINE_MIN_READ_BUFFER), TIMELINE_MAX_READ_BUFFER);
+        };
+        std::vector<std::filesystem::path> pending = runs;
+        while (pending.size() > options.fanIn) {
+            passes++;
+            std::vector<std::filesystem::path> next;
+            for (size_t i = 0; i < pending.size(); i += options.fanIn) {
+                size_t end = std::min(pending.size(), i + options.fanIn);
+                if (end - i == 1) {
+                    next.push_back(pending[i]);
+                    continue;
+                }
+                std::vector<std::filesystem::path> group(pending.begin() + i, pending.begin() + end);
+                std::filesystem::path output = NextRunPath();
+                runs.push_back(output);
+                if (!MergeFiles(group, bufferFor(group.size()), output, error)) {
+                    return false;
+                }
+                std::error_code ec;
+                for (const auto& run : group) {
+                    std::filesystem::remove(run, ec);
+                }
+                next.push_back(output);
+            }
+            pending.swap(next);
+        }
+
+        passes++;
+        std::vector<std::unique_ptr<TimelineSource>> sources;
+        for (const auto& run : pending) {
+            sources.push_back(std::make_unique<TimelineFileSource>(run, bufferFor(pending.size())));
+        }
+        for (auto& sorter : sorters) {
+            if (!sorter->empty()) {
+                sorter->Sort();
+                sources.push_back(std::make_unique<TimelineMemorySource>(*sorter));
+            }
+        }
+        if (!MergeTimelineSources(sources, [&](const uint8_t* record) { return emit(ViewTimelineRecord(record)); })) {
+            error = "run de timeline illisible ou tronqué";
+            return false;
+        }
+        return true;
+    }
+};
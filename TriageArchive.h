@@ -0,0 +1,688 @@
+/*
+ * TriageArchive - hives NTUSER.DAT lues directement dans les paquets de triage (zip, gzip, tar, tar.gz)
+ * Aucune extraction sur disque : l'archive est mappée, chaque membre NTUSER.DAT est décompressé
+ * en mémoire (Inflate.h) et livré à un Handler dès qu'il est complet, pendant que la suite
+ * de l'archive est décompressée (le Handler le confie typiquement au pool de parsing).
+ *
+ * Handler :
+ * - Reserve(uint64_t bytes) : avant la décompression d'un membre retenu, peut bloquer (contre-pression)
+ * - Deliver(ArchiveHive&& hive) : une fois par Reserve, membre complet ou en échec (error renseigné)
+ *
+ * - zip : répertoire central (zip64 compris), membres stockés (lus en place) ou deflate, CRC vérifié
+ * - gzip : hive seule (nom d'origine FNAME) ou tar compressé, membres concaténés, CRC vérifié
+ * - tar : ustar/GNU (noms longs), pax (path=)
+ */
+
+#pragma once
+
+#include "UserAssistCore.h"
+#include "HiveReader.h"
+#include "Inflate.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum ArchiveFormat : uint8_t {
+    ARCHIVE_NONE = 0,
+    ARCHIVE_ZIP,
+    ARCHIVE_GZIP,
+    ARCHIVE_TAR
+};
+
+constexpr const char* ARCHIVE_FORMAT_NAMES[] = { "aucun", "zip", "gzip", "tar" };
+
+constexpr size_t TAR_BLOCK = 512;
+constexpr size_t TAR_MAX_NAME = 64 * 1024;          // Nom long GNU ou en-tête pax conservé au plus
+constexpr uint64_t DEFLATE_MAX_RATIO = 1032;        // Taux maximal de deflate (bornes des tailles annoncées)
+
+// Membre extrait : contenu décompressé, ou vue dans l'archive mappée si stocké sans compression
+struct ArchiveHive {
+    std::string name;                               // Chemin dans l'archive, séparateurs '/', UTF-8
+    std::vector<uint8_t> bytes;
+    std::shared_ptr<const MappedFile> source;       // Maintient la vue valide (membre stocké)
+    const uint8_t* view = nullptr;
+    size_t viewSize = 0;
+    uint64_t reserved = 0;                          // Octets annoncés au Reserve correspondant
+    std::string error;                              // Non vide : membre illisible
+
+    const uint8_t* data() const { return view ? view : bytes.data(); }
+    size_t size() const { return view ? viewSize : bytes.size(); }
+};
+
+inline ArchiveFormat DetectArchiveFormat(const uint8_t* data, size_t size) {
+    if (size >= 4 && data[0] == 'P' && data[1] == 'K' &&
+        ((data[2] == 3 && data[3] == 4) || (data[2] == 5 && data[3] == 6) || (data[2] == 6 && data[3] == 6))) {
+        return ARCHIVE_ZIP;
+    }
+    if (size >= 2 && data[0] == 0x1F && data[1] == 0x8B) {
+        return ARCHIVE_GZIP;
+    }
+    if (size >= TAR_BLOCK && std::memcmp(data + 257, "ustar", 5) == 0) {
+        return ARCHIVE_TAR;
+    }
+    return ARCHIVE_NONE;
+}
+
+// Dernier composant du chemin égal à NTUSER.DAT (casse ignorée)
+inline bool IsNtUserMember(std::string_view name) {
+    size_t slash = name.find_last_of("/\\");
+    std::string_view file = slash == std::string_view::npos ? name : name.substr(slash + 1);
+    const char* expected = "NTUSER.DAT";
+    if (file.size() != 10) {
+        return false;
+    }
+    for (size_t i = 0; i < file.size(); i++) {
+        char c = file[i];
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 32);
+        if (c != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nom de membre : UTF-8 tel quel, sinon octets CP437/Latin-1 convertis ; '\' normalisé en '/'
+inline std::string ArchiveMemberName(const uint8_t* data, size_t size, bool utf8) {
+    std::string name;
+    name.reserve(size);
+    for (size_t i = 0; i < size && data[i]; i++) {
+        uint8_t c = data[i];
+        if (c == '\\') {
+            name += '/';
+        } else if (c < 0x80 || utf8) {
+            name += static_cast<char>(c);
+        } else {
+            name += static_cast<char>(0xC0 | (c >> 6));
+            name += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return name;
+}
+
+// Champ numérique tar : octal ASCII, ou base 256 (bit de poids fort du premier octet)
+inline uint64_t ParseTarNumber(const uint8_t* field, size_t size) {
+    uint64_t value = 0;
+    if (field[0] & 0x80) {
+        value = field[0] & 0x7F;
+        for (size_t i = 1; i < size; i++) {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+    size_t i = 0;
+    while (i < size && field[i] == ' ') i++;
+    for (; i < size && field[i] >= '0' && field[i] <= '7'; i++) {
+        value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+    return value;
+}
+
+// Flux tar alimenté par tranches (fichier mappé ou sortie de l'inflater)
+template <typename Handler>
+class TarStream {
+    enum State : uint8_t { TAR_HEADER, TAR_DATA, TAR_PADDING, TAR_END };
+    enum Capture : uint8_t { CAPTURE_SKIP, CAPTURE_HIVE, CAPTURE_LONG_NAME, CAPTURE_PAX };
+
+    Handler& handler;
+    uint8_t header[TAR_BLOCK];
+    size_t headerFill = 0;
+    State state = TAR_HEADER;
+    Capture capture = CAPTURE_SKIP;
+    uint64_t remaining = 0;
+    uint64_t padding = 0;
+    uint64_t position = 0;      // Octets du flux déjà consommés
+    uint64_t limit;             // Taille maximale du flux (fichier, ou borne deflate)
+    size_t zeroBlocks = 0;
+    std::string text;           // Contenu d'un nom long GNU ou d'un en-tête pax
+    std::string nextName;       // Nom imposé au membre suivant
+    ArchiveHive current;
+    bool holding = false;       // current réservé, pas encore livré
+
+    bool Header(std::string& error) {
+        bool zero = std::all_of(header, header + TAR_BLOCK, [](uint8_t b) { return b == 0; });
+        if (zero) {
+            state = ++zeroBlocks >= 2 ? TAR_END : TAR_HEADER;
+            return true;
+        }
+        zeroBlocks = 0;
+
+        uint64_t expected = ParseTarNumber(header + 148, 8);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < TAR_BLOCK; i++) {
+            sum += (i >= 148 && i < 156) ? ' ' : header[i];
+        }
+        if (sum != expected) {
+            error = "en-tête tar invalide (somme de contrôle)";
+            return false;
+        }
+
+        std::string name;
+        if (!nextName.empty()) {
+            name.swap(nextName);
+        } else {
+            if (std::memcmp(header + 257, "ustar", 5) == 0 && header[345]) {
+                name = ArchiveMemberName(header + 345, 155, true) + "/";
+            }
+            name += ArchiveMemberName(header, 100, true);
+        }
+
+        remaining = ParseTarNumber(header + 124, 12);
+        if (position > limit || remaining > limit - position) {
+            error = "membre tar plus grand que l'archive";
+            return false;
+        }
+        padding = (TAR_BLOCK - remaining % TAR_BLOCK) % TAR_BLOCK;
+        char type = static_cast<char>(header[156]);
+        capture = CAPTURE_SKIP;
+        if (type == 'L' || type == 'x') {
+            capture = type == 'L' ? CAPTURE_LONG_NAME : CAPTURE_PAX;
+            text.clear();
+        } else if ((type == '0' || type == '\0' || type == '7') && IsNtUserMember(name)) {
+            handler.Reserve(remaining);
+            current = ArchiveHive();
+            current.name = std::move(name);
+            current.reserved = remaining;
+            holding = true;     // Livré en échec par le destructeur si la réservation échoue
+            current.bytes.reserve(static_cast<size_t>(remaining));
+            capture = CAPTURE_HIVE;
+        }
+        state = TAR_DATA;
+        return remaining ? true : EndOfData();
+    }
+
+    bool EndOfData() {
+        if (capture == CAPTURE_HIVE) {
+            holding = false;
+            handler.Deliver(std::move(current));
+        } else if (capture == CAPTURE_LONG_NAME) {
+            nextName = ArchiveMemberName(reinterpret_cast<const uint8_t*>(text.data()), text.size(), true);
+        } else if (capture == CAPTURE_PAX) {
+            // Enregistrements "<longueur> <clé>=<valeur>\n"
+            size_t pos = 0;
+            while (pos < text.size()) {
+                size_t space = text.find(' ', pos);
+                size_t length = std::strtoul(text.c_str() + pos, nullptr, 10);
+                if (space == std::string::npos || length == 0 || length > text.size() - pos ||
+                    space >= pos + length) {
+                    break;
+                }
+                std::string_view record(text.data() + space + 1, pos + length - space - 1);
+                if (record.size() > 5 && record.substr(0, 5) == "path=") {
+                    record.remove_suffix(record.back() == '\n' ? 1 : 0);
+                    nextName = ArchiveMemberName(reinterpret_cast<const uint8_t*>(record.data()) + 5,
+                                                 record.size() - 5, true);
+                }
+                pos += length;
+            }
+        }
+        state = padding ? TAR_PADDING : TAR_HEADER;
+        return true;
+    }
+
+public:
+    // limit : longueur maximale du flux ; un membre annoncé au-delà est rejeté
+    TarStream(Handler& h, uint64_t max) : handler(h), limit(max) {}
+
+    ~TarStream() {
+        if (holding) {
+            Fail("archive tar interrompue");
+        }
+    }
+
+    // Livre le membre en cours en échec (réservation rendue au Handler)
+    void Fail(const std::string& error) {
+        if (holding) {
+            holding = false;
+            current.bytes = std::vector<uint8_t>();
+            current.error = error;
+            handler.Deliver(std::move(current));
+        }
+    }
+
+    bool Ended() const { return state == TAR_END; }
+
+    // false : en-tête invalide (error renseigné) ou fin d'archive atteinte (Ended)
+    bool Feed(const uint8_t* data, size_t size, std::string& error) {
+        while (size && state != TAR_END) {
+            if (state == TAR_HEADER) {
+                size_t n = std::min(size, TAR_BLOCK - headerFill);
+                std::memcpy(header + headerFill, data, n);
+                headerFill += n;
+                position += n;
+                data += n;
+                size -= n;
+                if (headerFill == TAR_BLOCK) {
+                    headerFill = 0;
+                    if (!Header(error)) {
+                        return false;
+                    }
+                }
+            } else if (state == TAR_DATA) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(size, remaining));
+                if (capture == CAPTURE_HIVE) {
+                    current.bytes.insert(current.bytes.end(), data, data + n);
+                } else if (capture != CAPTURE_SKIP && text.size() < TAR_MAX_NAME) {
+                    text.append(reinterpret_cast<const char*>(data), std::min(n, TAR_MAX_NAME - text.size()));
+                }
+                position += n;
+                data += n;
+                size -= n;
+                remaining -= n;
+                if (remaining == 0) {
+                    EndOfData();
+                }
+            } else {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(size, padding));
+                position += n;
+                data += n;
+                size -= n;
+                padding -= n;
+                if (padding == 0) {
+                    state = TAR_HEADER;
+                }
+            }
+        }
+        return state != TAR_END;
+    }
+
+    // Fin des données : un membre inachevé est livré en échec
+    bool Finish(std::string& error) {
+        if (state == TAR_END || (state == TAR_HEADER && headerFill == 0)) {
+            return true;
+        }
+        error = "archive tar tronquée";
+        Fail(error);
+        return false;
+    }
+};
+
+template <typename Handler>
+bool ReadTarArchive(const MappedFile& file, Handler& handler, std::string& error) {
+    TarStream<Handler> tar(handler, file.size());
+    tar.Feed(file.data(), file.size(), error);
+    if (!error.empty()) {
+        tar.Fail(error);
+        return false;
+    }
+    return tar.Finish(error);
+}
+
+// Contenu d'un gzip : tar compressé, ou hive seule (décidé sur le premier bloc décompressé)
+template <typename Handler>
+class GzipContent {
+    enum Mode : uint8_t { GZ_UNDECIDED, GZ_TAR, GZ_HIVE, GZ_OTHER };
+
+    Handler& handler;
+    TarStream<Handler> tar;
+    std::vector<uint8_t> head;
+    Mode mode = GZ_UNDECIDED;
+    ArchiveHive hive;
+    bool holding = false;
+    uint64_t sizeHint;
+
+    bool Decide(std::string& error) {
+        if (head.size() >= TAR_BLOCK && std::memcmp(head.data() + 257, "ustar", 5) == 0) {
+            mode = GZ_TAR;
+            return tar.Feed(head.data(), head.size(), error);
+        }
+        if (head.size() >= 4 && std::memcmp(head.data(), "regf", 4) == 0) {
+            mode = GZ_HIVE;
+            handler.Reserve(sizeHint);
+            hive.reserved = sizeHint;
+            holding = true;
+            hive.bytes.reserve(static_cast<size_t>(std::max<uint64_t>(sizeHint, head.size())));
+            hive.bytes.insert(hive.bytes.end(), head.begin(), head.end());
+            return true;
+        }
+        mode = GZ_OTHER;
+        return false;
+    }
+
+public:
+    // limit : borne de la taille décompressée (taux maximal de deflate), plafonne ISIZE et le tar
+    GzipContent(Handler& h, std::string name, uint64_t expected, uint64_t limit)
+        : handler(h), tar(h, limit), sizeHint(std::min(expected, limit)) { hive.name = std::move(name); }
+
+    ~GzipContent() { Fail("archive gzip interrompue"); }
+
+    bool Feed(const uint8_t* data, size_t size, std::string& error) {
+        if (mode == GZ_UNDECIDED) {
+            size_t n = std::min(size, TAR_BLOCK - head.size());
+            head.insert(head.end(), data, data + n);
+            data += n;
+            size -= n;
+            if (head.size() < TAR_BLOCK) {
+                return true;
+            }
+            if (!Decide(error)) {
+                return false;
+            }
+        }
+        if (mode == GZ_TAR) {
+            return tar.Feed(data, size, error);
+        }
+        hive.bytes.insert(hive.bytes.end(), data, data + size);
+        return true;
+    }
+
+    // Nom pris dans l'en-tête gzip (FNAME), pour une hive seule
+    void SetName(std::string name) { hive.name = std::move(name); }
+
+    bool Unsupported() const { return mode == GZ_OTHER; }
+
+    void Fail(const std::string& error) {
+        tar.Fail(error);
+        if (holding) {
+            holding = false;
+            hive.bytes = std::vector<uint8_t>();
+            hive.error = error;
+            handler.Deliver(std::move(hive));
+        }
+    }
+
+    bool Finish(std::string& error) {
+        if (mode == GZ_UNDECIDED && !Decide(error)) {
+            return false;
+        }
+        if (mode == GZ_TAR) {
+            return tar.Finish(error);
+        }
+        if (holding) {
+            holding = false;
+            handler.Deliver(std::move(hive));
+        }
+        return true;
+    }
+};
+
+// fallbackName : nom de la hive seule si l'en-tête gzip n'a pas de FNAME
+template <typename Handler>
+bool ReadGzipArchive(const MappedFile& file, const std::string& fallbackName, Handler& handler, std::string& error) {
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    // ISIZE du dernier membre : taille décompressée modulo 2^32 (réservation seulement)
+    uint64_t expected = size >= 4 ? ReadLE32(data + size - 4) : 0;
+    GzipContent<Handler> content(handler, fallbackName, expected, static_cast<uint64_t>(size) * DEFLATE_MAX_RATIO + 1024);
+    Inflater inflater;
+
+    size_t offset = 0;
+    bool first = true;
+    while (size - offset >= 18 && data[offset] == 0x1F && data[offset + 1] == 0x8B) {
+        uint8_t method = data[offset + 2];
+        uint8_t flags = data[offset + 3];
+        if (method != 8 || (flags & 0xE0)) {
+            error = "méthode gzip non supportée";
+            content.Fail(error);
+            return false;
+        }
+        size_t pos = offset + 10;
+        if (flags & 0x04) {         // FEXTRA
+            pos = size - pos >= 2 ? pos + 2 + ReadLE16(data + pos) : size + 1;
+        }
+        size_t nameStart = pos;
+        for (int field = 0x08; field <= 0x10; field <<= 1) {    // FNAME, FCOMMENT
+            if (flags & field) {
+                while (pos < size && data[pos]) pos++;
+                if (field == 0x08 && first && pos > nameStart) {
+                    content.SetName(ArchiveMemberName(data + nameStart, pos - nameStart, false));
+                }
+                pos++;
+            }
+        }
+        if (flags & 0x02) {         // FHCRC
+            pos += 2;
+        }
+        if (pos > size) {
+            error = "en-tête gzip tronqué";
+            content.Fail(error);
+            return false;
+        }
+
+        uint32_t crc = 0;
+        size_t consumed = 0;
+        InflateStatus status = inflater.Run(data + pos, size - pos, [&](const uint8_t* p, size_t n) {
+            crc = Crc32(crc, p, n);
+            return content.Feed(p, n, error);
+        }, &consumed);
+        if (status == INFLATE_STOPPED) {
+            if (content.Unsupported()) {
+                error = "contenu gzip ni hive regf ni tar";
+                return false;
+            }
+            if (!error.empty()) {
+                content.Fail(error);
+                return false;
+            }
+            return true;    // Fin de l'archive tar atteinte
+        }
+        if (status != INFLATE_DONE) {
+            error = INFLATE_STATUS_NAMES[status];
+            content.Fail(error);
+            return false;
+        }
+        pos += consumed;
+        if (pos > size || size - pos < 8) {
+            error = "fin gzip tronquée";
+            content.Fail(error);
+            return false;
+        }
+        if (ReadLE32(data + pos) != crc) {
+            error = "CRC gzip invalide";
+            content.Fail(error);
+            return false;
+        }
+        offset = pos + 8;
+        first = false;
+    }
+    if (first) {
+        error = "en-tête gzip invalide";
+        return false;
+    }
+    if (!content.Finish(error)) {
+        if (error.empty()) {
+            error = "contenu gzip ni hive regf ni tar";
+        }
+        return false;
+    }
+    return true;
+}
+
+struct ZipEntry {
+    std::string name;
+    uint16_t flags = 0;
+    uint16_t method = 0;
+    uint32_t crc = 0;
+    uint64_t compressedSize = 0;
+    uint64_t size = 0;
+    uint64_t localOffset = 0;
+};
+
+// Répertoire central (fin de fichier, zip64 si les champs 32 bits sont saturés)
+inline bool ReadZipDirectory(const uint8_t* data, size_t size, std::vector<ZipEntry>& entries, std::string& error) {
+    constexpr size_t EOCD_SIZE = 22;
+    if (size < EOCD_SIZE) {
+        error = "archive zip tronquée";
+        return false;
+    }
+    size_t eocd = size - EOCD_SIZE;
+    size_t lowest = size > EOCD_SIZE + 0xFFFF ? size - EOCD_SIZE - 0xFFFF : 0;
+    while (ReadLE32(data + eocd) != 0x06054B50) {
+        if (eocd == lowest) {
+            error = "fin de répertoire central zip introuvable";
+            return false;
+        }
+        eocd--;
+    }
+    uint64_t count = ReadLE16(data + eocd + 10);
+    uint64_t directorySize = ReadLE32(data + eocd + 12);
+    uint64_t directory = ReadLE32(data + eocd + 16);
+    if ((count == 0xFFFF || directory == 0xFFFFFFFF || directorySize == 0xFFFFFFFF) && eocd >= 20 &&
+        ReadLE32(data + eocd - 20) == 0x07064B50) {
+        uint64_t zip64 = ReadLE64(data + eocd - 20 + 8);
+        if (zip64 > size || size - zip64 < 56 || ReadLE32(data + zip64) != 0x06064B50) {
+            error = "fin de répertoire central zip64 invalide";
+            return false;
+        }
+        count = ReadLE64(data + zip64 + 32);
+        directorySize = ReadLE64(data + zip64 + 40);
+        directory = ReadLE64(data + zip64 + 48);
+    }
+    if (directory > size || directorySize > size - directory) {
+        error = "répertoire central zip hors du fichier";
+        return false;
+    }
+
+    size_t pos = static_cast<size_t>(directory);
+    size_t end = static_cast<size_t>(directory + directorySize);
+    for (uint64_t i = 0; i < count; i++) {
+        if (end - pos < 46 || ReadLE32(data + pos) != 0x02014B50) {
+            error = "répertoire central zip corrompu";
+            return false;
+        }
+        ZipEntry entry;
+        entry.flags = ReadLE16(data + pos + 8);
+        entry.method = ReadLE16(data + pos + 10);
+        entry.crc = ReadLE32(data + pos + 16);
+        entry.compressedSize = ReadLE32(data + pos + 20);
+        entry.size = ReadLE32(data + pos + 24);
+        entry.localOffset = ReadLE32(data + pos + 42);
+        size_t nameLength = ReadLE16(data + pos + 28);
+        size_t extraLength = ReadLE16(data + pos + 30);
+        size_t commentLength = ReadLE16(data + pos + 32);
+        if (end - pos - 46 < nameLength + extraLength + commentLength) {
+            error = "répertoire central zip corrompu";
+            return false;
+        }
+        entry.name = ArchiveMemberName(data + pos + 46, nameLength, (entry.flags & 0x0800) != 0);
+
+        // Champ zip64 : uniquement les valeurs saturées, dans cet ordre
+        const uint8_t* extra = data + pos + 46 + nameLength;
+        for (size_t e = 0; e + 4 <= extraLength;) {
+            uint16_t id = ReadLE16(extra + e);
+            size_t length = ReadLE16(extra + e + 2);
+            if (length > extraLength - e - 4) {
+                break;
+            }
+            if (id == 0x0001) {
+                const uint8_t* field = extra + e + 4;
+                const uint8_t* fieldEnd = field + length;
+                uint64_t* targets[] = { &entry.size, &entry.compressedSize, &entry.localOffset };
+                for (uint64_t* target : targets) {
+                    if (*target == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                        *target = ReadLE64(field);
+                        field += 8;
+                    }
+                }
+            }
+            e += 4 + length;
+        }
+        entries.push_back(std::move(entry));
+        pos += 46 + nameLength + extraLength + commentLength;
+    }
+    return true;
+}
+
+template <typename Handler>
+bool ReadZipArchive(const std::shared_ptr<const MappedFile>& file, Handler& handler, std::string& error) {
+    const uint8_t* data = file->data();
+    size_t size = file->size();
+    std::vector<ZipEntry> entries;
+    if (!ReadZipDirectory(data, size, entries, error)) {
+        return false;
+    }
+
+    std::unique_ptr<Inflater> inflater;
+    for (const ZipEntry& entry : entries) {
+        if (!IsNtUserMember(entry.name) || entry.name.back() == '/') {
+            continue;
+        }
+        // Réservation bornée par le taux maximal de deflate (en-tête forgé)
+        uint64_t cap = std::min<uint64_t>(entry.compressedSize, size) * DEFLATE_MAX_RATIO + 1024;
+        uint64_t reserved = std::min(entry.size, cap);
+        handler.Reserve(reserved);
+        ArchiveHive hive;
+        hive.name = entry.name;
+        hive.reserved = reserved;
+
+        size_t local = static_cast<size_t>(entry.localOffset);
+        size_t start = 0;
+        if (entry.localOffset > size || size - entry.localOffset < 30 || ReadLE32(data + local) != 0x04034B50) {
+            hive.error = "en-tête local zip invalide";
+        } else {
+            start = local + 30 + ReadLE16(data + local + 26) + ReadLE16(data + local + 28);
+            if (start > size || entry.compressedSize > size - start) {
+                hive.error = "membre zip hors du fichier";
+            }
+        }
+        if (!hive.error.empty()) {
+            // Déjà signalé
+        } else if (entry.flags & 0x0001) {
+            hive.error = "membre zip chiffré";
+        } else if (entry.method == 0) {
+            if (entry.compressedSize != entry.size) {
+                hive.error = "taille de membre stocké incohérente";
+            } else if (Crc32(0, data + start, static_cast<size_t>(entry.size)) != entry.crc) {
+                hive.error = "CRC zip invalide";
+            } else {
+                hive.source = file;
+                hive.view = data + start;
+                hive.viewSize = static_cast<size_t>(entry.size);
+            }
+        } else if (entry.method == 8) {
+            if (!inflater) {
+                inflater = std::make_unique<Inflater>();
+            }
+            hive.bytes.reserve(static_cast<size_t>(reserved));
+            uint32_t crc = 0;
+            InflateStatus status = inflater->Run(data + start, static_cast<size_t>(entry.compressedSize),
+                [&](const uint8_t* p, size_t n) {
+                    if (hive.bytes.size() + n > entry.size) {
+                        return false;
+                    }
+                    crc = Crc32(crc, p, n);
+                    hive.bytes.insert(hive.bytes.end(), p, p + n);
+                    return true;
+                });
+            if (status == INFLATE_STOPPED) {
+                hive.error = "taille décompressée incohérente";
+            } else if (status != INFLATE_DONE) {
+                hive.error = INFLATE_STATUS_NAMES[status];
+            } else if (hive.bytes.size() != entry.size) {
+                hive.error = "taille décompressée incohérente";
+            } else if (crc != entry.crc) {
+                hive.error = "CRC zip invalide";
+            }
+        } else {
+            hive.error = "méthode de compression zip " + std::to_string(entry.method) + " non supportée";
+        }
+        if (!hive.error.empty()) {
+            hive.bytes = std::vector<uint8_t>();
+        }
+        handler.Deliver(std::move(hive));
+    }
+    return true;
+}
+
+// Point d'entrée : format détecté sur le contenu. false : archive illisible (error renseigné) ;
+// les membres livrés avant l'erreur restent valides
+template <typename Handler>
+bool ReadTriageArchive(const std::shared_ptr<const MappedFile>& file, const std::string& fallbackName,
+                       Handler& handler, std::string& error) {
+    switch (DetectArchiveFormat(file->data(), file->size())) {
+    case ARCHIVE_ZIP:
+        return ReadZipArchive(file, handler, error);
+    case ARCHIVE_GZIP:
+        return ReadGzipArchive(*file, fallbackName, handler, error);
+    case ARCHIVE_TAR:
+        return ReadTarArchive(*file, handler, error);
+    default:
+        error = "format d'archive non reconnu (zip, gzip ou tar attendu)";
+        return false;
+    }
+}
@@ -0,0 +1,1146 @@
+/*
+ * UserAssistBatch - mode batch headless (WinToolsSuite Serie 3 #21)
+ * Décode en parallèle des milliers de hives NTUSER.DAT collectées (triage, ferme d'analyse)
+ *
+ * Fonctionnalités :
+ * - Entrées : hives, dossiers (recherche récursive des NTUSER.DAT), listes de fichiers (-l)
+ * - Archives de triage (.zip, .gz, .tgz, .tar) lues sans extraction : décompression sur des threads
+ *   dédiés, chaque NTUSER.DAT confié au pool dès qu'il est complet (mémoire en vol bornée)
+ * - Pool work-stealing dimensionné sur le nombre de cœurs (-j pour forcer)
+ * - Sortie CSV UTF-8 (RFC 4180) unique fusionnée (fichier ou stdout), écrite en flux
+ *   depuis le parseur : mémoire bornée quel que soit le volume
+ * - Ou timeline binaire colonnaire .uatl (-f uatl), relue par UserAssistTimeline
+ * - Ou flux d'événements NDJSON (-f ndjson) vers stdout ou un pipe : un objet JSON compact par entrée,
+ *   file bornée vers un thread d'écriture (-Q), un consommateur lent ralentit le parsing
+ * - Surveillance continue (-s) : instantané persistant par hive, seules les entrées
+ *   nouvelles ou modifiées depuis la collecte précédente sont émises ; -i relit seulement les hives
+ *   dont les numéros de séquence ont changé, et dans celles-ci les clés Count dont une hbin a changé
+ * - Agrégats (-a) : rapport JSON par utilisateur, GUID et application (top-K, temps de
+ *   focus, applications distinctes), calculé par worker puis fusionné
+ * - Rareté (-r) : chemins présents sur au plus N hives du parc (-n), comptage exact puis
+ *   sketches au-delà du budget mémoire (-b)
+ * - Timeline globale (-t) : toutes les hives triées par date de dernière exécution, tri externe
+ *   (runs triés sur disque puis fusion k voies), mémoire bornée (-M) quel que soit le parc
+ * - Filtre (-w) : requête compilée une fois (chemin, GUID, utilisateur, compteurs, dates),
+ *   appliquée par lots de colonnes à chaque hive avant export, agrégats et rareté
+ * - Carving (-c, -C) : valeurs supprimées récupérées dans les cellules libres, après la dernière
+ *   hbin ou dans un vidage mémoire (signatures vk vectorisées), avec un indice de confiance
+ * - Performances (-p) : temps par étape (parcours, ROT13, décodage, stockage, export), octets lus,
+ *   valeurs ignorées et mémoire pic, en JSON en fin de batch (suivi par version et par hôte)
+ * - Débit par hive et échecs rapportés sur stderr (journal asynchrone) sans interrompre le batch ;
+ *   -v détaille chaque valeur décodée
+ *
+ * Portable : Windows (cl.exe, voir go.bat) et Linux (g++, voir go.sh)
+ * Auteur : WinToolsSuite
+ * License : MIT
+ */
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "HiveReader.h"
+#include "ThreadPool.h"
+#include "ExportSink.h"
+#include "TimelineFormat.h"
+#include "Snapshot.h"
+#include "Aggregates.h"
+#include "Rarity.h"
+#include "AsyncLog.h"
+#include "PerfCounters.h"
+#include "Query.h"
+#include "HiveCarver.h"
+#include "TriageArchive.h"
+#include "TimelineMerge.h"
+#include "HiveIncremental.h"
+#include "EventStream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+namespace fs = std::filesystem;
+
+// Octets décompressés en attente de parsing au-delà desquels les threads de décompression attendent
+constexpr uint64_t ARCHIVE_INFLIGHT_BYTES = 512ull * 1024 * 1024;
+
+struct BatchOptions {
+    std::vector<fs::path> inputs;
+    fs::path output;            // Vide = stdout
+    size_t threads = 0;         // 0 = nombre de cœurs
+    bool quiet = false;
+    bool verbose = false;       // -v : une ligne par valeur décodée
+    bool columnar = false;      // -f uatl
+    bool ndjson = false;        // -f ndjson
+    uint64_t streamBudget = EVENT_STREAM_DEFAULT_BUDGET;   // -Q : blocs NDJSON en attente d'écriture
+    fs::path snapshots;         // -s : dossier des instantanés (vide = export complet)
+    bool incremental = false;   // -i : état des séquences et hbins à côté de chaque instantané
+    fs::path aggregates;        // -a : rapport JSON des agrégats ("-" = stdout)
+    AggregateOptions aggregate; // -k, -m
+    fs::path rarity;            // -r : rapport JSON de rareté ("-" = stdout)
+    RarityOptions rare;         // -n, -b (budget total, réparti entre les workers)
+    fs::path perf;              // -p : rapport JSON de performance ("-" = stdout)
+    Query filter;               // -w : lignes retenues (vide = toutes)
+    bool carve = false;         // -c / -C : récupération des valeurs supprimées au lieu du décodage
+    CarveOptions carving;       // -C : cellules allouées incluses
+    bool globalTimeline = false;        // -t : CSV unique trié par date sur tout le parc
+    TimelineMergeOptions merge;         // -M (budget), -T (dossier des runs)
+};
+
+// Statistiques globales du batch (mises à jour par les workers)
+struct BatchStats {
+    std::atomic<uint64_t> hives{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> entries{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> changes{0};
+    std::atomic<uint64_t> archives{0};
+    std::atomic<uint64_t> inflated{0};      // Octets décompressés des membres retenus
+    std::atomic<uint64_t> unchanged{0};     // -i : hives non relues (base block identique)
+    std::atomic<uint64_t> reparsed{0};      // -i : clés Count relues
+    std::atomic<uint64_t> countKeys{0};     // -i : clés Count présentes
+};
+
+// -i : état de la passe précédente et de la passe courante d'une hive (réutilisé par worker)
+struct IncrementalScan {
+    fs::path snapshotFile;
+    fs::path stateFile;
+    UserAssistSnapshot snapshot;
+    HiveIncrementalState previous;
+    HiveIncrementalState next;
+    bool loaded = false;        // État et instantané précédents utilisables
+    IncrementalPass pass;
+};
+
+// Le profil est le dossier parent (C:\Users\<nom>\NTUSER.DAT)
+static std::wstring ProfileName(const fs::path& hive) {
+    std::wstring name = hive.parent_path().filename().wstring();
+    return name.empty() ? hive.filename().wstring() : name;
+}
+
+// FNV-1a 64 bits de la forme native du chemin
+static uint64_t PathHash(const fs::path& path) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (auto ch : path.native()) {
+        h ^= static_cast<uint32_t>(ch);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Instantané d'une hive : <profil>-<hash du chemin absolu>.uasnap (deux hôtes, deux fichiers)
+static fs::path SnapshotPath(const fs::path& directory, const fs::path& hive) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(hive, ec);
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx.uasnap", static_cast<unsigned long long>(PathHash(ec ? hive : absolute)));
+    fs::path name = ProfileName(hive);
+    name += suffix;
+    return directory / name;
+}
+
+static bool IsNtUserHive(const fs::path& file) {
+    // Comparaison sur la forme native (pas de conversion de page de codes)
+    fs::path fileName = file.filename();
+    const auto& name = fileName.native();
+    const char* expected = "NTUSER.DAT";
+    if (name.size() != 10) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); i++) {
+        auto c = name[i];
+        if (c >= 'a' && c <= 'z') c = static_cast<decltype(c)>(c - 32);
+        if (c != static_cast<decltype(c)>(expected[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Paquet de triage reconnu à l'extension (.zip, .gz, .tgz, .tar) ; le format réel est lu dans le contenu
+static bool IsTriageArchive(const fs::path& file) {
+    fs::path extension = file.extension();
+    const auto& ext = extension.native();
+    for (const char* expected : { ".zip", ".gz", ".tgz", ".tar" }) {
+        size_t length = std::char_traits<char>::length(expected);
+        if (ext.size() != length) {
+            continue;
+        }
+        size_t i = 0;
+        for (; i < length; i++) {
+            auto c = ext[i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<decltype(c)>(c + 32);
+            if (c != static_cast<decltype(c)>(expected[i])) {
+                break;
+            }
+        }
+        if (i == length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void CollectHives(const fs::path& input, std::vector<fs::path>& hives, std::vector<fs::path>& archives) {
+    std::error_code ec;
+    if (!fs::is_directory(input, ec)) {
+        (IsTriageArchive(input) ? archives : hives).push_back(input);
+        return;
+    }
+
+    fs::recursive_directory_iterator it(input, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        if (IsNtUserHive(it->path())) {
+            hives.push_back(it->path());
+        } else if (IsTriageArchive(it->path())) {
+            archives.push_back(it->path());
+        }
+    }
+    if (ec) {
+        std::fprintf(stderr, "[ATTENTION] Parcours incomplet de %s : %s\n",
+                     input.u8string().c_str(), ec.message().c_str());
+    }
+}
+
+static bool ReadListFile(const fs::path& list, std::vector<fs::path>& inputs) {
+    std::ifstream in(list, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            inputs.push_back(fs::u8path(line));
+        }
+    }
+    return true;
+}
+
+class BatchRunner {
+    const BatchOptions& options;
+    BatchStats stats;
+    SharedSink* out;
+    TimelineWriter* timeline;
+    EventStream* stream = nullptr;      // -f ndjson : file bornée devant la sortie
+    std::vector<std::unique_ptr<AggregateEngine>> engines;     // Un par worker, fusionnés en fin de batch
+    std::vector<std::unique_ptr<RarityEngine>> rarities;       // Idem : une hive = un hôte, jamais partagée
+    std::unique_ptr<ExternalTimeline> ordered;                 // -t : tampons de tri par worker, fusion en fin de batch
+    AsyncLogger log;        // Rapport par hive sur stderr, sans sérialiser les workers
+    PerfCounters perf;      // Alimenté par hive si -p
+    size_t threads = 0;
+
+    // Membres d'archives décompressés pas encore parsés (contre-pression des threads de décompression)
+    ThreadPool* pool = nullptr;
+    std::mutex inflightLock;
+    std::condition_variable inflightDone;
+    uint64_t inflight = 0;
+
+    void Report(const char* status, const fs::path& hive, const std::string& detail) {
+        LogLevel level = status[0] == 'O' ? UA_LOG_INFO : status[0] == 'A' ? UA_LOG_WARNING : UA_LOG_ERROR;
+        if (!log.Enabled(level)) {
+            return;
+        }
+        log.Write(level, "[" + std::string(status) + "] " + hive.u8string() + " : " + detail);
+    }
+
+    void ReportValue(const fs::path& hive, std::wstring_view guid, std::wstring_view decoded,
+                     const UserAssistCounters& counters) {
+        if (!log.Enabled(UA_LOG_DEBUG)) {
+            return;
+        }
+        static thread_local std::string line;
+        char text[UA_TIME_TEXT_CHARS];
+        line = "[VALEUR] " + hive.u8string() + " : ";
+        AppendUtf8(line, guid.data(), guid.size());
+        line += ' ';
+        AppendUtf8(line, decoded.data(), decoded.size());
+        line += " (";
+        line += std::to_string(counters.runCount);
+        line += ", ";
+        line.append(text, FormatLastExecution(counters.status, counters.lastExecution, text));
+        line += ", session ";
+        line += std::to_string(counters.session);
+        line += ", format ";
+        line += UA_LAYOUT_NAMES[counters.layout];
+        line += ')';
+        log.Write(UA_LOG_DEBUG, std::string_view(line));
+    }
+
+    // Émet les différences avec l'instantané précédent puis le remplace ; renvoie le détail du rapport
+    std::string DiffAgainstSnapshot(const fs::path& path, const EntryStore& entries, CsvWriter& csv) {
+        static thread_local std::vector<EntryDiff> diffs;
+        static thread_local std::wstring scratch;
+
+        fs::path snapshotFile = SnapshotPath(options.snapshots, path);
+        UserAssistSnapshot snapshot;
+        std::string error;
+        std::error_code ec;
+        if (fs::exists(snapshotFile, ec) && !snapshot.Load(snapshotFile, error)) {
+            Report("ATTENTION", path, "instantané ignoré (" + error + "), export complet");
+        }
+
+        diffs.clear();
+        SnapshotDiffSummary summary = snapshot.Diff(entries, diffs);
+        for (const auto& diff : diffs) {
+            WriteUserAssistDiffCsvRow(csv, entries, diff, scratch);
+        }
+        csv.writer().Flush();
+        stats.changes += diffs.size();
+
+        snapshot.Assign(entries);
+        if (!snapshot.Save(snapshotFile)) {
+            Report("ATTENTION", path, "écriture de l'instantané impossible : " + snapshotFile.u8string());
+        }
+
+        char detail[128];
+        std::snprintf(detail, sizeof(detail), ", %zu nouvelles, %zu modifiées, %zu inchangées, %zu disparues",
+                      summary.added, summary.updated, summary.unchanged, summary.removed);
+        return detail;
+    }
+
+    // -i : relecture limitée aux clés Count changées ; instantané chargé seulement si la hive a changé
+    void ParseIncremental(const fs::path& path, const HiveReader& hive, uint64_t size, const std::wstring& profile,
+                          EntryStore& parsed, IncrementalScan& scan, PerfTally& tally) {
+        scan.snapshotFile = SnapshotPath(options.snapshots, path);
+        scan.stateFile = scan.snapshotFile;
+        scan.stateFile.replace_extension(".uainc");
+        scan.snapshot.clear();
+        std::string error;
+        std::error_code ec;
+        scan.loaded = fs::exists(scan.stateFile, ec) && fs::exists(scan.snapshotFile, ec);
+        if (scan.loaded && !scan.previous.Load(scan.stateFile, error)) {
+            Report("ATTENTION", path, "état incrémental ignoré (" + error + "), relecture complète");
+            scan.loaded = false;
+        }
+        tally.Lap(PERF_ENUMERATE);
+
+        scan.pass = ParseUserAssistIncremental(hive, size, scan.loaded ? &scan.previous : nullptr, scan.next,
+                                               profile.c_str(), parsed, tally);
+        if (scan.pass.skipped || !fs::exists(scan.snapshotFile, ec)) {
+            return;
+        }
+        if (!scan.snapshot.Load(scan.snapshotFile, error)) {
+            Report("ATTENTION", path, "instantané ignoré (" + error + "), export complet");
+            scan.snapshot.clear();
+            if (scan.loaded) {
+                // Les clés non relues n'ont plus de référence : relecture complète
+                scan.loaded = false;
+                parsed.clear();
+                scan.pass = ParseUserAssistIncremental(hive, size, nullptr, scan.next, profile.c_str(), parsed, tally);
+            }
+        }
+        tally.Lap(PERF_ENUMERATE);
+    }
+
+    // -i : différences limitées aux clés Count relues, puis mise à jour partielle de l'instantané
+    std::string IncrementalDiff(const fs::path& path, const EntryStore& entries, CsvWriter& csv, IncrementalScan& scan) {
+        static thread_local std::vector<EntryDiff> diffs;
+        static thread_local std::wstring scratch;
+
+        stats.countKeys += scan.pass.guids;
+        if (scan.pass.skipped) {
+            stats.unchanged++;
+            return ", inchangée (séquence " + std::to_string(scan.next.sequence1) + "), non relue";
+        }
+        stats.reparsed += scan.pass.reparsed;
+
+        AssignIncrementalKeys(scan.next, entries);
+        diffs.clear();
+        SnapshotDiffSummary summary = scan.snapshot.Diff(entries, diffs, scan.loaded ? &scan.pass.staleKeys : nullptr);
+        for (const auto& diff : diffs) {
+            WriteUserAssistDiffCsvRow(csv, entries, diff, scratch);
+        }
+        csv.writer().Flush();
+        stats.changes += diffs.size();
+
+        if (scan.loaded) {
+            scan.snapshot.Replace(scan.pass.staleKeys, entries);
+        } else {
+            scan.snapshot.Assign(entries);
+        }
+        // État écrit après l'instantané : un état sans son instantané à jour n'est jamais réutilisé
+        std::error_code ec;
+        fs::remove(scan.stateFile, ec);
+        if (!scan.snapshot.Save(scan.snapshotFile)) {
+            Report("ATTENTION", path, "écriture de l'instantané impossible : " + scan.snapshotFile.u8string());
+        } else if (!scan.next.Save(scan.stateFile)) {
+            Report("ATTENTION", path, "écriture de l'état incrémental impossible : " + scan.stateFile.u8string());
+        }
+
+        char detail[192];
+        std::snprintf(detail, sizeof(detail),
+                      ", %zu/%zu clés Count relues (%.1f Ko), %zu nouvelles, %zu modifiées, %zu inchangées, %zu disparues",
+                      scan.pass.reparsed, scan.pass.guids, scan.pass.bytesRead / 1024.0,
+                      summary.added, summary.updated, summary.unchanged, summary.removed);
+        return detail;
+    }
+
+    // Image quelconque (hive, vidage mémoire) : pas de validation regf, carving sur tout le buffer
+    void CarveImage(const fs::path& path, const uint8_t* data, size_t size, PerfTally& tally) {
+        static thread_local Utf8Writer writer;
+        writer.Attach(*out);
+        CsvWriter csv(writer);
+
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            tally.Count(PERF_SOURCES);
+            tally.Lap(PERF_ENUMERATE);
+
+            std::wstring source = path.wstring();
+            size_t levels[3] = {};
+            HiveCarver carver(data, size, options.carving);
+            size_t rows = carver.Carve([&](const CarvedValue& value) {
+                WriteCarvedCsvRow(csv, source, value);
+                levels[value.confidence]++;
+                if (log.Enabled(UA_LOG_DEBUG)) {
+                    static const wchar_t* const cells[] = { L"[libre]", L"[allou\u00E9e]", L"[hors hbin]" };
+                    ReportValue(path, cells[value.cell], value.decodedPath, value.counters);
+                }
+                tally.Lap(PERF_EXPORT);
+                return true;
+            }, tally);
+            writer.Flush();
+            tally.Lap(PERF_EXPORT);
+            perf.Add(tally);
+
+            stats.entries += rows;
+            stats.bytes += size;
+
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            char detail[192];
+            std::snprintf(detail, sizeof(detail),
+                          "%zu valeurs récupérées (%zu haute, %zu moyenne, %zu faible confiance), %.1f Mo, %.2f ms, %.1f Mo/s",
+                          rows, levels[CARVE_HIGH], levels[CARVE_MEDIUM], levels[CARVE_LOW], size / 1048576.0, ms,
+                          ms > 0 ? (size / 1048576.0) / (ms / 1000.0) : 0.0);
+            Report("OK", path, detail);
+        } catch (const std::exception& e) {
+            perf.Add(tally);
+            writer.Flush();
+            stats.failures++;
+            Report("ECHEC", path, e.what());
+        }
+    }
+
+    // Hive en mémoire (fichier mappé ou membre d'archive décompressé) ; path sert au profil et aux rapports
+    void ProcessImage(const fs::path& path, const uint8_t* data, size_t size, PerfTally& tally) {
+        if (options.carve) {
+            CarveImage(path, data, size, tally);
+            return;
+        }
+
+        // Consommateur du flux parti (pipe fermé) : inutile de continuer à parser
+        if (stream && !stream->ok()) {
+            return;
+        }
+
+        // Buffer d'export réutilisé d'une hive à l'autre sur chaque worker
+        static thread_local Utf8Writer writer;
+        static thread_local JsonWriter json(writer);
+        static thread_local std::string source;
+        writer.Attach(*out);
+        CsvWriter csv(writer);
+        if (options.ndjson) {
+            source = path.u8string();
+            json.Reset();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            HiveReader hive;
+            if (!hive.Open(data, size)) {
+                stats.failures++;
+                Report("ECHEC", path, "format regf invalide");
+                return;
+            }
+
+            std::wstring profile = ProfileName(path);
+            // Toutes les sous-clés {GUID} présentes (pas seulement Executable/Shortcut) ; -i les localise lui-même
+            std::vector<std::wstring> guids;
+            if (!options.incremental) {
+                guids = ListUserAssistGuids(hive);
+                tally.Count(PERF_BYTES_READ, size);
+            }
+            tally.Count(PERF_SOURCES);
+            tally.Lap(PERF_ENUMERATE);
+            size_t rows = 0;
+            std::string extra;
+            if (options.columnar || !options.snapshots.empty() || !options.aggregates.empty() ||
+                !options.rarity.empty() || !options.filter.empty() || options.globalTimeline) {
+                static thread_local EntryStore parsed;
+                static thread_local IncrementalScan scan;
+                parsed.clear();
+                if (options.incremental) {
+                    ParseIncremental(path, hive, size, profile, parsed, scan, tally);
+                    tally.Count(PERF_BYTES_READ, scan.pass.bytesRead);
+                }
+                for (const std::wstring& guid : guids) {
+                    ParseUserAssistHive(hive, guid.c_str(), profile.c_str(), parsed, tally);
+                }
+
+                // Filtre : lignes retenues recopiées, la suite du traitement ne voit qu'elles
+                static thread_local EntryStore selected;
+                static thread_local std::vector<uint32_t> selection;
+                EntryStore& entries = options.filter.empty() ? parsed : selected;
+                if (!options.filter.empty()) {
+                    options.filter.Select(parsed, selection);
+                    selected.clear();
+                    selected.Append(parsed, selection);
+                    extra = ", " + std::to_string(selection.size()) + "/" + std::to_string(parsed.size()) + " retenues";
+                    tally.Lap(PERF_STORE);
+                }
+                rows = entries.size();
+                for (size_t row = 0; row < rows && log.Enabled(UA_LOG_DEBUG); row++) {
+                    ReportValue(path, entries.Guid(row), entries.DecodedPath(row), entries.Counters(row));
+                }
+
+                if (!engines.empty()) {
+                    engines[pool->WorkerIndex()]->Add(entries);
+                }
+                if (!rarities.empty()) {
+                    rarities[pool->WorkerIndex()]->Add(entries);
+                }
+                tally.Lap(PERF_STORE);
+                if (options.columnar) {
+                    // Groupes de lignes construits par worker, ajoutés au fichier sous verrou
+                    static thread_local TimelineGroupBuilder builder;
+                    timeline->Append(entries, builder);
+                } else if (ordered) {
+                    // Tri par worker, déversé sur disque quand le tampon est plein ; fusion en fin de batch
+                    ordered->Add(pool->WorkerIndex(), entries, PathHash(path));
+                } else if (options.incremental) {
+                    extra += IncrementalDiff(path, entries, csv, scan);
+                } else if (!options.snapshots.empty()) {
+                    extra += DiffAgainstSnapshot(path, entries, csv);
+                } else {
+                    static thread_local std::wstring scratch;
+                    for (size_t row = 0; row < entries.size(); row++) {
+                        if (options.ndjson) {
+                            WriteUserAssistJsonRow(json, entries, row, scratch, source);
+                        } else {
+                            WriteUserAssistCsvRow(csv, entries, row, scratch);
+                        }
+                    }
+                    writer.Flush();
+                }
+                tally.Lap(PERF_EXPORT);
+            } else {
+                // Lignes écrites directement depuis le parseur, sans stockage intermédiaire
+                for (const std::wstring& guid : guids) {
+                    StreamUserAssistHive(hive, guid.c_str(), [&](std::wstring_view encoded, std::wstring_view decoded,
+                                                         const UserAssistCounters& counters) {
+                        if (options.ndjson) {
+                            WriteUserAssistJsonRow(json, encoded, decoded, counters, guid, profile,
+                                                   FindKnownFolder(decoded), source);
+                        } else {
+                            WriteUserAssistCsvRow(csv, encoded, decoded, counters, guid, profile,
+                                                  FindKnownFolder(decoded));
+                        }
+                        ReportValue(path, guid, decoded, counters);
+                        rows++;
+                        tally.Lap(PERF_EXPORT);
+                    }, tally);
+                }
+                writer.Flush();
+                tally.Lap(PERF_EXPORT);
+            }
+            perf.Add(tally);
+
+            stats.entries += rows;
+            stats.bytes += size;
+
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            char detail[160];
+            std::snprintf(detail, sizeof(detail), "%zu entrées, %.1f Ko, %.2f ms, %.1f Mo/s",
+                          rows, size / 1024.0, ms,
+                          ms > 0 ? (size / 1048576.0) / (ms / 1000.0) : 0.0);
+            Report("OK", path, detail + extra);
+        } catch (const std::exception& e) {
+            perf.Add(tally);
+            writer.Flush();
+            stats.failures++;
+            Report("ECHEC", path, e.what());
+        }
+    }
+
+    void ProcessHive(const fs::path& path) {
+        stats.hives++;
+        PerfTally tally(!options.perf.empty());
+        MappedFile file;
+        if (!file.Open(path.c_str())) {
+            stats.failures++;
+            Report("ECHEC", path, "ouverture impossible");
+            return;
+        }
+        ProcessImage(path, file.data(), file.size(), tally);
+    }
+
+    // Membre d'archive : chemin affiché <archive>/<chemin du membre> (profil = dossier parent du membre)
+    void ProcessMember(const fs::path& archive, const ArchiveHive& member) {
+        stats.hives++;
+        fs::path path = archive / fs::u8path(member.name);
+        if (!member.error.empty()) {
+            stats.failures++;
+            Report("ECHEC", path, member.error);
+            return;
+        }
+        stats.inflated += member.size();
+        PerfTally tally(!options.perf.empty());
+        ProcessImage(path, member.data(), member.size(), tally);
+    }
+
+    // Appelé par les threads de décompression : attend que le pool ait consommé assez de membres
+    void AcquireInflight(uint64_t bytes) {
+        std::unique_lock<std::mutex> lock(inflightLock);
+        inflightDone.wait(lock, [&] { return inflight == 0 || inflight + bytes <= ARCHIVE_INFLIGHT_BYTES; });
+        inflight += bytes;
+    }
+
+    void ReleaseInflight(uint64_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(inflightLock);
+            inflight -= bytes;
+        }
+        inflightDone.notify_all();
+    }
+
+    // Handler de TriageArchive : chaque membre complet part au pool pendant que la décompression continue
+    struct ArchiveFeed {
+        BatchRunner& runner;
+        const fs::path& archive;
+        PerfTally& tally;
+        size_t hives = 0;
+        uint64_t pending = 0;   // Réservé, pas encore livré (rendu si la lecture lève une exception)
+
+        void Reserve(uint64_t bytes) {
+            tally.Lap(PERF_INFLATE);
+            runner.AcquireInflight(bytes);
+            pending += bytes;
+            tally.Start();      // Attente de contre-pression exclue du temps de décompression
+        }
+
+        void Deliver(ArchiveHive&& hive) {
+            tally.Lap(PERF_INFLATE);
+            hives++;
+            pending -= hive.reserved;
+            auto member = std::make_shared<ArchiveHive>(std::move(hive));
+            BatchRunner* self = &runner;
+            fs::path path = archive;
+            runner.pool->Submit([self, path, member] {
+                self->ProcessMember(path, *member);
+                uint64_t reserved = member->reserved;
+                member->bytes = std::vector<uint8_t>();
+                member->source.reset();
+                self->ReleaseInflight(reserved);
+            });
+        }
+    };
+
+    // Thread de décompression : une archive entière, membres livrés au fil de l'eau
+    void ReadArchive(const fs::path& path) {
+        auto start = std::chrono::steady_clock::now();
+        stats.archives++;
+        PerfTally tally(!options.perf.empty());
+        auto file = std::make_shared<MappedFile>();
+        if (!file->Open(path.c_str())) {
+            stats.failures++;
+            Report("ECHEC", path, "ouverture de l'archive impossible");
+            return;
+        }
+        tally.Count(PERF_ARCHIVES);
+        tally.Count(PERF_ARCHIVE_BYTES, file->size());
+
+        // Hive seule compressée sans nom d'origine : nom de l'archive sans .gz
+        std::string fallback = path.stem().u8string();
+        ArchiveFeed feed{ *this, path, tally };
+        std::string error;
+        bool ok;
+        try {
+            ok = ReadTriageArchive(std::shared_ptr<const MappedFile>(file), fallback, feed, error);
+        } catch (const std::exception& e) {
+            ok = false;
+            error = e.what();
+            ReleaseInflight(feed.pending);
+            feed.pending = 0;
+        }
+        tally.Lap(PERF_INFLATE);
+        perf.Add(tally);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        char detail[160];
+        std::snprintf(detail, sizeof(detail), "archive, %zu hives, %.1f Mo compressés, %.2f ms, %.1f Mo/s",
+                      feed.hives, file->size() / 1048576.0, ms,
+                      ms > 0 ? (file->size() / 1048576.0) / (ms / 1000.0) : 0.0);
+        if (!ok) {
+            stats.failures++;
+            Report("ECHEC", path, error + " (" + detail + ")");
+        } else if (feed.hives == 0) {
+            Report("ATTENTION", path, "aucune hive NTUSER.DAT dans l'archive");
+        } else {
+            Report("OK", path, detail);
+        }
+    }
+
+public:
+    explicit BatchRunner(const BatchOptions& opts) : options(opts), out(nullptr), timeline(nullptr) {
+        log.OpenStderr();
+        log.SetLevel(options.verbose ? UA_LOG_DEBUG : options.quiet ? UA_LOG_WARNING : UA_LOG_INFO);
+    }
+
+    // Rapport JSON dans un fichier ou sur stdout ("-")
+    template <typename F>
+    static bool WriteJsonReport(const fs::path& path, const char* name, F&& write) {
+        FileSink file;
+        bool toStdout = path == "-";
+        if (!(toStdout ? file.OpenStdout() : file.Open(path.c_str()))) {
+            std::fprintf(stderr, "Impossible de créer %s\n", path.u8string().c_str());
+            return false;
+        }
+        Utf8Writer writer(file);
+        JsonWriter json(writer);
+        write(json);
+        if (!writer.Flush()) {
+            std::fprintf(stderr, "Erreur d'écriture du rapport %s\n", name);
+            return false;
+        }
+        return true;
+    }
+
+    // Fusion k voies des runs et tampons des workers en un seul CSV ordonné (thread appelant)
+    bool WriteGlobalTimeline(SharedSink& shared) {
+        PerfTally tally(!options.perf.empty());
+        Utf8Writer writer(shared);
+        CsvWriter csv(writer);
+        std::wstring encoded;
+        std::string error;
+        bool merged = ordered->Merge([&](const TimelineRow& row) {
+            encoded.assign(row.path.data(), row.path.size());
+            DecodeROT13InPlace(&encoded[0], encoded.size());
+            WriteUserAssistCsvRow(csv, encoded, row.path, row.record->counters, row.guid, row.user,
+                                  row.record->knownFolder);
+            return true;
+        }, error);
+        writer.Flush();
+        tally.Lap(PERF_EXPORT);
+        perf.Add(tally);
+        if (!merged) {
+            std::fprintf(stderr, "Timeline globale : %s\n", error.c_str());
+            return false;
+        }
+        std::fprintf(stderr, "Timeline globale : %llu lignes, %llu runs (%.1f Mo écrits dans %s), %zu passes de fusion\n",
+                     static_cast<unsigned long long>(ordered->Records()),
+                     static_cast<unsigned long long>(ordered->Runs()), ordered->SpilledBytes() / 1048576.0,
+                     ordered->Directory().u8string().c_str(), ordered->Passes());
+        return true;
+    }
+
+    bool WritePerf() {
+        return WriteJsonReport(options.perf, "de performance", [&](JsonWriter& json) {
+            WritePerfJson(json, perf, "UserAssistBatch", "batch", threads);
+        });
+    }
+
+    // Fusionne les agrégats des workers et écrit le rapport JSON
+    bool WriteAggregates() {
+        AggregateEngine total(options.aggregate);
+        for (const auto& engine : engines) {
+            total.Merge(*engine);
+        }
+        if (!WriteJsonReport(options.aggregates, "d'agrégats", [&](JsonWriter& json) { WriteAggregatesJson(json, total); })) {
+            return false;
+        }
+        std::fprintf(stderr, "Agrégats : %zu utilisateurs, %zu applications distinctes, %zu GUID\n",
+                     total.UserCount(), total.ApplicationCount(), total.GuidCount());
+        return true;
+    }
+
+    // Fusionne les moteurs de rareté des workers et écrit le rapport JSON
+    bool WriteRarity() {
+        RarityEngine total(options.rare);
+        for (const auto& engine : rarities) {
+            total.Merge(*engine);
+        }
+        if (!WriteJsonReport(options.rarity, "de rareté", [&](JsonWriter& json) { WriteRarityJson(json, total); })) {
+            return false;
+        }
+        std::fprintf(stderr, "Rareté : %llu hives, %llu chemins distincts, %zu présents sur au plus %u hives (%s)\n",
+                     static_cast<unsigned long long>(total.Hosts()),
+                     static_cast<unsigned long long>(total.DistinctPaths()), total.Rare().size(),
+                     options.rare.maxHosts, total.Approximate() ? "approché" : "exact");
+        return true;
+    }
+
+    int Run() {
+        std::vector<fs::path> hives;
+        std::vector<fs::path> archives;
+        for (const auto& input : options.inputs) {
+            CollectHives(input, hives, archives);
+        }
+        if (hives.empty() && archives.empty()) {
+            std::fprintf(stderr, "Aucune hive à analyser\n");
+            return 1;
+        }
+        std::sort(hives.begin(), hives.end());
+        std::sort(archives.begin(), archives.end());
+
+        FileSink file;
+        bool opened = options.output.empty() ? file.OpenStdout() : file.Open(options.output.c_str());
+        if (!opened) {
+            std::fprintf(stderr, "Impossible de créer %s\n", options.output.u8string().c_str());
+            return 1;
+        }
+        // NDJSON : écriture par un thread dédié derrière une file bornée (contre-pression sur les workers)
+        std::unique_ptr<EventStream> events;
+        if (options.ndjson) {
+            events = std::make_unique<EventStream>(file, options.streamBudget);
+            stream = events.get();
+        }
+        SharedSink shared(events ? static_cast<ByteSink&>(*events) : file);
+        TimelineWriter columnar(shared);
+        out = &shared;
+        timeline = &columnar;
+        if (options.columnar) {
+            columnar.Begin();
+        } else if (options.ndjson) {
+            // Pas d'en-tête : chaque ligne est un document autonome
+        } else if (options.carve) {
+            Utf8Writer header(shared);
+            CsvWriter csv(header);
+            WriteCarvedCsvHeader(csv, !options.output.empty());
+            header.Flush();
+        } else if (!options.snapshots.empty()) {
+            Utf8Writer header(shared);
+            CsvWriter csv(header);
+            WriteUserAssistDiffCsvHeader(csv, !options.output.empty());
+            header.Flush();
+        } else {
+            // BOM uniquement pour un fichier (stdout peut être redirigé vers un autre outil)
+            Utf8Writer header(shared);
+            CsvWriter csv(header);
+            WriteUserAssistCsvHeader(csv, !options.output.empty());
+            header.Flush();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        perf.Reset();
+        {
+            ThreadPool workers(options.threads);
+            pool = &workers;
+            threads = workers.size();
+            // Décompression sur des threads dédiés (un quart du pool), parsing des membres sur le pool
+            size_t readers = std::min(archives.size(), std::max<size_t>(1, threads / 4));
+            if (archives.empty()) {
+                std::fprintf(stderr, "Batch : %zu hives, %zu threads\n", hives.size(), threads);
+            } else {
+                std::fprintf(stderr, "Batch : %zu hives, %zu archives, %zu threads (+%zu décompression)\n",
+                             hives.size(), archives.size(), threads, readers);
+            }
+            if (!options.aggregates.empty()) {
+                for (size_t i = 0; i < threads; i++) {
+                    engines.push_back(std::make_unique<AggregateEngine>(options.aggregate));
+                }
+            }
+            if (options.globalTimeline) {
+                ordered = std::make_unique<ExternalTimeline>(options.merge, threads);
+            }
+            if (!options.rarity.empty()) {
+                RarityOptions perWorker = options.rare;
+                perWorker.memoryBudget /= threads;
+                for (size_t i = 0; i < threads; i++) {
+                    rarities.push_back(std::make_unique<RarityEngine>(perWorker));
+                }
+            }
+            std::atomic<size_t> nextArchive{0};
+            std::vector<std::thread> decompressors;
+            for (size_t i = 0; i < readers; i++) {
+                decompressors.emplace_back([&] {
+                    for (size_t a; (a = nextArchive++) < archives.size();) {
+                        ReadArchive(archives[a]);
+                    }
+                });
+            }
+            for (const auto& hive : hives) {
+                workers.Submit([this, hive] { ProcessHive(hive); });
+            }
+            for (auto& decompressor : decompressors) {
+                decompressor.join();
+            }
+            workers.Wait();
+            pool = nullptr;
+        }
+        if (ordered && !WriteGlobalTimeline(shared)) {
+            return 1;
+        }
+        if (options.columnar) {
+            columnar.Finish();
+        }
+        bool streamed = !events || events->Close();
+        log.Drain();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr,
+                     "Batch terminé : %llu hives (%llu échecs), %llu entrées, %.2f s, %.1f hives/s, %.1f Mo/s\n",
+                     static_cast<unsigned long long>(stats.hives.load()),
+                     static_cast<unsigned long long>(stats.failures.load()),
+                     static_cast<unsigned long long>(stats.entries.load()), seconds,
+                     seconds > 0 ? stats.hives.load() / seconds : 0.0,
+                     seconds > 0 ? (stats.bytes.load() / 1048576.0) / seconds : 0.0);
+
+        if (!archives.empty()) {
+            std::fprintf(stderr, "Archives : %llu lues, %.1f Mo décompressés\n",
+                         static_cast<unsigned long long>(stats.archives.load()), stats.inflated.load() / 1048576.0);
+        }
+        if (!options.snapshots.empty()) {
+            std::fprintf(stderr, "Différences émises : %llu lignes\n",
+                         static_cast<unsigned long long>(stats.changes.load()));
+        }
+        if (options.incremental) {
+            std::fprintf(stderr, "Incrémental : %llu hives non relues, %llu/%llu clés Count relues\n",
+                         static_cast<unsigned long long>(stats.unchanged.load()),
+                         static_cast<unsigned long long>(stats.reparsed.load()),
+                         static_cast<unsigned long long>(stats.countKeys.load()));
+        }
+
+        if (events) {
+            std::fprintf(stderr, "Flux NDJSON : %.1f Mo en %llu blocs, file pic %.1f/%.1f Mo, "
+                         "%llu attentes des workers (%.1f ms)\n",
+                         events->BytesWritten() / 1048576.0, static_cast<unsigned long long>(events->Chunks()),
+                         events->PeakBytes() / 1048576.0, events->Budget() / 1048576.0,
+                         static_cast<unsigned long long>(events->Stalls()), events->StallMs());
+        }
+
+        if (!shared.ok() || !streamed) {
+            std::fprintf(stderr, "Erreur d'écriture de la sortie\n");
+            return 1;
+        }
+        if (!options.aggregates.empty() && !WriteAggregates()) {
+            return 1;
+        }
+        if (!options.rarity.empty() && !WriteRarity()) {
+            return 1;
+        }
+        // En dernier : mémoire pic et durée couvrent aussi les rapports
+        if (!options.perf.empty() && !WritePerf()) {
+            return 1;
+        }
+        return stats.failures.load() ? 2 : 0;
+    }
+};
+
+static void PrintUsage() {
+    std::fprintf(stderr,
+        "UserAssistBatch - décodage UserAssist de hives NTUSER.DAT en parallèle\n\n"
+        "Usage : UserAssistBatch [options] <hive|dossier|archive>...\n"
+        "  Archives de triage (.zip, .gz, .tgz, .tar, aussi trouvées dans les dossiers) : les membres\n"
+        "  NTUSER.DAT sont décompressés en mémoire et analysés sans extraction sur disque\n"
+        "  -o <fichier>  sortie fusionnée (défaut : stdout)\n"
+        "  -f <format>   csv (défaut), uatl (timeline binaire colonnaire, voir UserAssistTimeline) ou\n"
+        "                ndjson (un objet JSON par entrée et par ligne, en flux : pipe, collecteur de logs)\n"
+        "  -Q <Mo>       file d'écriture du flux ndjson : au-delà, les workers attendent le consommateur\n"
+        "                (défaut : 16)\n"
+        "  -s <dossier>  surveillance : instantané par hive dans ce dossier, seules les entrées\n"
+        "                nouvelles ou modifiées depuis l'exécution précédente sont émises (CSV)\n"
+        "  -i            avec -s : relecture incrémentale, hive ignorée si ses numéros de séquence n'ont\n"
+        "                pas changé, sinon seules les clés Count dont une hbin a changé sont relues\n"
+        "  -a <fichier>  rapport JSON des agrégats par utilisateur, GUID et application\n"
+        "                (\"-\" = stdout, uniquement avec -o)\n"
+        "  -k <n>        taille des top-K du rapport d'agrégats (défaut : 5)\n"
+        "  -m <métrique> classement des top-K : runs (défaut) ou focustime\n"
+        "  -r <fichier>  rapport JSON de rareté : chemins présents sur peu de hives du parc\n"
+        "                (\"-\" = stdout, uniquement avec -o)\n"
+        "  -n <n>        seuil de rareté en nombre de hives (défaut : 5)\n"
+        "  -b <Mo>       budget mémoire du comptage exact de rareté, sketches au-delà (défaut : 256)\n"
+        "  -t            timeline globale : un seul CSV trié par date de dernière exécution sur toutes\n"
+        "                les hives (tri externe : runs triés sur disque puis fusion, lignes sans date en fin)\n"
+        "  -M <Mo>       budget mémoire de la timeline globale, tri et fusion (défaut : 256)\n"
+        "  -T <dossier>  dossier des runs de la timeline globale (défaut : dossier temporaire)\n"
+        "  -w <requête>  ne retient que les entrées correspondantes (tous les formats et rapports), ex. :\n"
+        "                \"chemin:*\\powershell.exe runs>=5 date>=2024-03-01 -user:admin\"\n"
+        "                champs : chemin, guid, user (sous-chaîne, glob * ?, = ou !=), runs, focus,\n"
+        "                temps (s par défaut, ms/m/h), date (ISO-8601 UTC) avec =, <, <=, >, >=\n"
+        "  -c            carving : valeurs supprimées retrouvées dans les cellules libres, après la\n"
+        "                dernière hbin ou dans une image quelconque (vidage mémoire), CSV avec position\n"
+        "                et confiance ; les fichiers cités sont analysés quel que soit leur nom\n"
+        "  -C            carving incluant les cellules allouées (valeurs encore présentes)\n"
+        "  -p <fichier>  rapport JSON de performance : temps par étape, octets lus, valeurs ignorées,\n"
+        "                mémoire pic (\"-\" = stdout, uniquement avec -o)\n"
+        "  -l <liste>    fichier listant des hives ou dossiers (un par ligne)\n"
+        "  -j <n>        nombre de threads (défaut : nombre de cœurs)\n"
+        "  -q            n'affiche que les échecs et le résumé\n"
+        "  -v            détaille chaque valeur décodée (GUID, chemin, compteur, date, session, format)\n\n"
+        "Code retour : 0 = succès, 1 = erreur d'usage ou de sortie, 2 = au moins une hive ou archive en échec\n");
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** argv) {
+#else
+int main(int argc, char** argv) {
+#endif
+    std::vector<fs::path> args(argv + 1, argv + argc);
+    BatchOptions options;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        const fs::path& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+
+        if (arg == "-o" && hasValue) {
+            options.output = args[++i];
+        } else if (arg == "-l" && hasValue) {
+            if (!ReadListFile(args[++i], options.inputs)) {
+                std::fprintf(stderr, "Liste illisible : %s\n", args[i].u8string().c_str());
+                return 1;
+            }
+        } else if (arg == "-j" && hasValue) {
+            options.threads = static_cast<size_t>(std::strtoul(args[++i].string().c_str(), nullptr, 10));
+        } else if (arg == "-f" && hasValue) {
+            const fs::path& format = args[++i];
+            if (format != "csv" && format != "uatl" && format != "ndjson") {
+                std::fprintf(stderr, "Format inconnu : %s\n", format.u8string().c_str());
+                return 1;
+            }
+            options.columnar = format == "uatl";
+            options.ndjson = format == "ndjson";
+        } else if (arg == "-Q" && hasValue) {
+            options.streamBudget = std::strtoull(args[++i].string().c_str(), nullptr, 10) << 20;
+        } else if (arg == "-s" && hasValue) {
+            options.snapshots = args[++i];
+        } else if (arg == "-i") {
+            options.incremental = true;
+        } else if (arg == "-a" && hasValue) {
+            options.aggregates = args[++i];
+        } else if (arg == "-k" && hasValue) {
+            options.aggregate.topK = static_cast<size_t>(std::strtoul(args[++i].string().c_str(), nullptr, 10));
+        } else if (arg == "-m" && hasValue) {
+            const fs::path& metric = args[++i];
+            if (metric != "runs" && metric != "focustime") {
+                std::fprintf(stderr, "Métrique inconnue : %s\n", metric.u8string().c_str());
+                return 1;
+            }
+            options.aggregate.metric = metric == "runs" ? UA_METRIC_RUNS : UA_METRIC_FOCUS_TIME;
+        } else if (arg == "-r" && hasValue) {
+            options.rarity = args[++i];
+        } else if (arg == "-n" && hasValue) {
+            options.rare.maxHosts = static_cast<uint32_t>(std::strtoul(args[++i].string().c_str(), nullptr, 10));
+        } else if (arg == "-b" && hasValue) {
+            options.rare.memoryBudget =
+                static_cast<size_t>(std::strtoull(args[++i].string().c_str(), nullptr, 10)) << 20;
+        } else if (arg == "-w" && hasValue) {
+            std::wstring error;
+            if (!options.filter.Parse(args[++i].wstring(), error)) {
+                std::string message;
+                AppendUtf8(message, error);
+                std::fprintf(stderr, "Requête invalide : %s\n", message.c_str());
+                return 1;
+            }
+        } else if (arg == "-t") {
+            options.globalTimeline = true;
+        } else if (arg == "-M" && hasValue) {
+            options.merge.memoryBudget = std::strtoull(args[++i].string().c_str(), nullptr, 10) << 20;
+        } else if (arg == "-T" && hasValue) {
+            options.merge.directory = args[++i];
+        } else if (arg == "-p" && hasValue) {
+            options.perf = args[++i];
+        } else if (arg == "-c" || arg == "-C") {
+            options.carve = true;
+            options.carving.allocated = arg == "-C";
+        } else if (arg == "-q") {
+            options.quiet = true;
+        } else if (arg == "-v") {
+            options.verbose = true;
+        } else if (!arg.native().empty() && arg.native()[0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+
+    if (options.inputs.empty()) {
+        PrintUsage();
+        return 1;
+    }
+    if (options.columnar && !options.snapshots.empty()) {
+        std::fprintf(stderr, "-s produit des différences CSV : incompatible avec -f uatl\n");
+        return 1;
+    }
+    if (options.carve && (options.columnar || !options.snapshots.empty() || !options.aggregates.empty() ||
+                          !options.rarity.empty() || !options.filter.empty())) {
+        std::fprintf(stderr, "-c/-C produit son propre CSV : incompatible avec -f uatl, -s, -a, -r et -w\n");
+        return 1;
+    }
+    if (options.globalTimeline && (options.columnar || !options.snapshots.empty() || options.carve)) {
+        std::fprintf(stderr, "-t produit un CSV trié : incompatible avec -f uatl, -s et -c/-C\n");
+        return 1;
+    }
+    if (options.incremental && (options.snapshots.empty() || !options.aggregates.empty() || !options.rarity.empty())) {
+        std::fprintf(stderr, "-i ne relit que les clés changées : requiert -s, incompatible avec -a et -r\n");
+        return 1;
+    }
+    if (options.ndjson && (!options.snapshots.empty() || options.globalTimeline || options.carve)) {
+        std::fprintf(stderr, "-f ndjson émet les entrées décodées : incompatible avec -s, -t et -c/-C\n");
+        return 1;
+    }
+    if (options.ndjson && options.streamBudget < (1ull << 20)) {
+        std::fprintf(stderr, "-Q : au moins 1 Mo\n");
+        return 1;
+    }
+#ifndef _WIN32
+    // Consommateur fermé : write échoue (EPIPE) au lieu de tuer le processus, le batch s'arrête proprement
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    if (options.globalTimeline && options.merge.memoryBudget < (4ull << 20)) {
+        std::fprintf(stderr, "-M : au moins 4 Mo\n");
+        return 1;
+    }
+    if (!options.merge.directory.empty()) {
+        std::error_code ec;
+        fs::create_directories(options.merge.directory, ec);
+        if (!fs::is_directory(options.merge.directory, ec)) {
+            std::fprintf(stderr, "Dossier des runs inaccessible : %s\n", options.merge.directory.u8string().c_str());
+            return 1;
+        }
+    }
+    if (options.aggregates == "-" && options.output.empty()) {
+        std::fprintf(stderr, "-a - écrit sur stdout : la sortie principale doit aller dans un fichier (-o)\n");
+        return 1;
+    }
+    if (options.rarity == "-" && (options.output.empty() || options.aggregates == "-")) {
+        std::fprintf(stderr, "-r - écrit sur stdout : sortie principale (-o) et agrégats (-a) dans des fichiers\n");
+        return 1;
+    }
+    if (options.perf == "-" && (options.output.empty() || options.aggregates == "-" || options.rarity == "-")) {
+        std::fprintf(stderr, "-p - écrit sur stdout : sortie principale (-o), agrégats (-a) et rareté (-r) dans des fichiers\n");
+        return 1;
+    }
+    if (!options.snapshots.empty()) {
+        std::error_code ec;
+        fs::create_directories(options.snapshots, ec);
+        if (!fs::is_directory(options.snapshots, ec)) {
+            std::fprintf(stderr, "Dossier d'instantanés inaccessible : %s\n", options.snapshots.u8string().c_str());
+            return 1;
+        }
+    }
+
+    BatchRunner runner(options);
+    return runner.Run();
+}
@@ -0,0 +1,1066 @@
+/*
+ * UserAssistBench - micro-benchmarks UserAssistDecoder (WinToolsSuite Serie 3 #21)
+ *
+ * - ROT13 : implémentation historique (wstring += par caractère) vs noyaux scalaire/SSE2/AVX2
+ * - Vérification d'identité bit à bit des noyaux avant mesure
+ * - Mémoire et tri : std::vector<UserAssistEntry> vs EntryStore colonnaire
+ * - Dates : formatage ISO-8601 vs swprintf, requête par intervalle indexée vs parcours linéaire
+ * - Export CSV : wostringstream ligne à ligne vs Utf8Writer/CsvWriter (sortie ignorée)
+ * - Journal : fprintf + fflush sous verrou vs AsyncLogger, plusieurs threads producteurs
+ * - Hive synthétique (HiveGenerator.h) : débit et allocations par étape (ROT13, décodage
+ *   binaire, parcours regf, formatage, export) sur des données XP/Win7, Unicode, corrompues
+ * - Dossiers connus : résolution par hachage parfait constexpr vs recherche linéaire
+ * - Cache de résultats (ResultCache.h) : réouverture mappée et requêtes en place vs nouvelle analyse
+ * - Carving (HiveCarver.h) : recherche de signatures vk scalaire/SSE2/AVX2 (résultats identiques vérifiés)
+ *   et récupération des valeurs supprimées d'une hive générée, sur une image de 256 Mo
+ * - Archives de triage forgées (TriageArchive.h) : tailles et offsets hors du fichier rejetés
+ *   sans réservation démesurée ni lecture hors limites
+ * - Allocations : compteur global (operator new) rapporté par opération pour chaque mesure
+ *
+ * Usage : UserAssistBench [-n itérations] [-v valeurs par GUID] [-s graine]
+ *         UserAssistBench -g dossier [-u profils] [-v valeurs par GUID] [-s graine] [-d % supprimées]
+ *         (écrit dossier/Users/<profil>/NTUSER.DAT pour UserAssistBatch)
+ * Auteur : WinToolsSuite
+ * License : MIT
+ */
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "ExportSink.h"
+#include "AsyncLog.h"
+#include "HiveGenerator.h"
+#include "HiveReader.h"
+#include "HiveCarver.h"
+#include "KnownFolders.h"
+#include "ResultCache.h"
+#include "TriageArchive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cwchar>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Implémentation d'origine de UserAssistDecoder::DecodeROT13 (référence de mesure)
+static std::wstring LegacyDecodeROT13(const std::wstring& input) {
+    std::wstring output;
+    output.reserve(input.size());
+
+    for (wchar_t ch : input) {
+        if (ch >= L'A' && ch <= L'Z') {
+            output += static_cast<wchar_t>((ch - L'A' + 13) % 26 + L'A');
+        } else if (ch >= L'a' && ch <= L'z') {
+            output += static_cast<wchar_t>((ch - L'a' + 13) % 26 + L'a');
+        } else {
+            output += ch;
+        }
+    }
+
+    return output;
+}
+
+// Empêche le compilateur d'éliminer le travail mesuré
+static volatile uint64_t g_sink = 0;
+
+// Allocations sur le tas (toutes les formes de new passent par operator new(size_t)).
+// Non inlinés : GCC signalerait sinon free() sur un pointeur "issu de new".
+static std::atomic<uint64_t> g_allocations{0};
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE __declspec(noinline)
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+BENCH_NOINLINE void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+struct BenchResult {
+    double nsPerOp;
+    double mbPerSec;
+    double allocsPerOp;
+};
+
+template <typename F>
+static BenchResult Measure(size_t iterations, size_t bytesPerOp, F&& op) {
+    op();   // Préchauffage
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        op();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    BenchResult r;
+    r.nsPerOp = ns / iterations;
+    r.mbPerSec = ns > 0 ? (static_cast<double>(bytesPerOp) * iterations / 1048576.0) / (ns / 1e9) : 0.0;
+    r.allocsPerOp = static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocations) / iterations;
+    return r;
+}
+
+static void PrintResult(const char* name, const BenchResult& r, double baselineNs) {
+    std::printf("  %-28s %10.1f ns/op %10.1f Mo/s %10.1f alloc/op   x%.2f\n",
+                name, r.nsPerOp, r.mbPerSec, r.allocsPerOp, baselineNs > 0 ? baselineNs / r.nsPerOp : 1.0);
+}
+
+// Chemin UserAssist typique encodé ROT13, avec caractères non ASCII
+static std::wstring MakeEncodedPath(std::mt19937& rng, size_t length) {
+    static const wchar_t alphabet[] =
+        L"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789\\:._-{} éàüßЖ中";
+    std::uniform_int_distribution<size_t> pick(0, (sizeof(alphabet) / sizeof(wchar_t)) - 2);
+    std::wstring s = L"P:\\Hfref\\";
+    while (s.size() < length) {
+        s.push_back(alphabet[pick(rng)]);
+    }
+    s.resize(length);
+    return s;
+}
+
+template <typename T>
+static bool VerifyKernel(const char* name, Rot13Kernel<T> kernel) {
+    // Exhaustif sur toutes les unités 16 bits, à chaque décalage de fin de buffer
+    std::vector<T> input(0x10000 + 31), expected(input.size()), actual(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = static_cast<T>(i & 0xFFFF);
+    }
+    if (sizeof(T) == 4) {
+        input.push_back(static_cast<T>(0x10FFFF));
+        input.push_back(static_cast<T>(0x1F600));
+        expected.resize(input.size());
+        actual.resize(input.size());
+    }
+
+    for (size_t tail = 0; tail < 32; tail++) {
+        size_t n = input.size() - tail;
+        Rot13Scalar(input.data(), expected.data(), n);
+        kernel(input.data(), actual.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            if (expected[i] != actual[i]) {
+                std::printf("  %s : ÉCHEC à l'indice %zu (U+%04X)\n", name, i, static_cast<unsigned>(input[i]));
+                return false;
+            }
+        }
+    }
+
+    // En place
+    std::vector<T> inPlace(input);
+    kernel(inPlace.data(), inPlace.data(), inPlace.size());
+    Rot13Scalar(input.data(), expected.data(), input.size());
+    if (inPlace != expected) {
+        std::printf("  %s : ÉCHEC du décodage en place\n", name);
+        return false;
+    }
+
+    std::printf("  %s : identique au scalaire\n", name);
+    return true;
+}
+
+static bool VerifyRot13() {
+    std::printf("Vérification ROT13 (noyau actif : %s)\n", Rot13KernelName());
+    bool ok = true;
+
+    std::mt19937 rng(42);
+    for (size_t len = 0; len < 300; len++) {
+        std::wstring s = MakeEncodedPath(rng, len);
+        if (DecodeROT13(s) != LegacyDecodeROT13(s)) {
+            std::printf("  DecodeROT13 : ÉCHEC longueur %zu\n", len);
+            ok = false;
+            break;
+        }
+    }
+
+#ifdef UA_ROT13_X86
+    ok &= VerifyKernel<char16_t>("SSE2 16 bits", &Rot13Sse2<char16_t>);
+    ok &= VerifyKernel<char32_t>("SSE2 32 bits", &Rot13Sse2<char32_t>);
+    if (CpuSupportsAvx2()) {
+        ok &= VerifyKernel<char16_t>("AVX2 16 bits", &Rot13Avx2<char16_t>);
+        ok &= VerifyKernel<char32_t>("AVX2 32 bits", &Rot13Avx2<char32_t>);
+    }
+#endif
+    return ok;
+}
+
+static void BenchRot13(size_t iterations) {
+    std::mt19937 rng(1234);
+    const size_t lengths[] = { 24, 64, 260, 4096 };
+
+    for (size_t length : lengths) {
+        std::wstring input = MakeEncodedPath(rng, length);
+        std::wstring output(length, L'\0');
+        size_t bytes = length * sizeof(wchar_t);
+        size_t iters = iterations * 256 / (length / 16 + 1);
+
+        std::printf("ROT13, %zu caractères (wchar_t %zu octets)\n", length, sizeof(wchar_t));
+
+        BenchResult legacy = Measure(iters, bytes, [&] {
+            std::wstring r = LegacyDecodeROT13(input);
+            g_sink += r[0];
+        });
+        PrintResult("historique (wstring +=)", legacy, legacy.nsPerOp);
+
+        PrintResult("DecodeROT13 (copie)", Measure(iters, bytes, [&] {
+            std::wstring r = DecodeROT13(input);
+            g_sink += r[0];
+        }), legacy.nsPerOp);
+
+        PrintResult("scalaire (buffer)", Measure(iters, bytes, [&] {
+            Rot13Scalar(input.data(), &output[0], length);
+            g_sink += output[0];
+        }), legacy.nsPerOp);
+
+#ifdef UA_ROT13_X86
+        PrintResult("SSE2 (buffer)", Measure(iters, bytes, [&] {
+            Rot13Sse2(input.data(), &output[0], length);
+            g_sink += output[0];
+        }), legacy.nsPerOp);
+
+        if (CpuSupportsAvx2()) {
+            PrintResult("AVX2 (buffer)", Measure(iters, bytes, [&] {
+                Rot13Avx2(input.data(), &output[0], length);
+                g_sink += output[0];
+            }), legacy.nsPerOp);
+        }
+#endif
+
+        PrintResult("DecodeROT13InPlace", Measure(iters, bytes, [&] {
+            DecodeROT13InPlace(&input[0], length);
+            g_sink += input[0];
+        }), legacy.nsPerOp);
+    }
+}
+
+// Octets alloués sur le tas par une chaîne (0 si elle tient dans le buffer SSO)
+static size_t StringBytes(const std::wstring& s) {
+    size_t heap = s.capacity() * sizeof(wchar_t) > sizeof(std::wstring) ? (s.capacity() + 1) * sizeof(wchar_t) : 0;
+    return heap;
+}
+
+static void BenchEntryStore(size_t rows) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> counter(0, 5000);
+    const size_t users = 500;
+    const size_t distinctPaths = rows / 20 + 1;
+
+    std::vector<std::wstring> paths;
+    for (size_t i = 0; i < distinctPaths; i++) {
+        paths.push_back(DecodeROT13(MakeEncodedPath(rng, 40 + i % 120)));
+    }
+
+    std::vector<UserAssistEntry> legacy;
+    EntryStore store;
+    size_t legacyBytes = 0;
+    for (size_t i = 0; i < rows; i++) {
+        UserAssistEntry entry;
+        entry.decodedPath = paths[i % distinctPaths];
+        entry.application = DecodeROT13(entry.decodedPath);
+        entry.runCount = counter(rng);
+        entry.focusCount = counter(rng);
+        entry.focusTime = counter(rng) * 1000;
+        entry.lastExecutionTime = 133000000000000000ull + counter(rng) * 10000000ull;
+        entry.timeStatus = UA_TIME_VALID;
+        entry.lastExecution = FileTimeToString(entry.lastExecutionTime);   // Rendu conservé par l'ancien modèle
+        entry.guid = (i & 1) ? GUID_EXECUTABLE : GUID_SHORTCUT;
+        entry.username = L"utilisateur" + std::to_wstring(i % users);
+        store.Append(entry);
+        legacyBytes += sizeof(UserAssistEntry) + StringBytes(entry.application) + StringBytes(entry.decodedPath) +
+                       StringBytes(entry.lastExecution) + StringBytes(entry.guid) + StringBytes(entry.username);
+        legacy.push_back(std::move(entry));
+    }
+    store.Timeline();   // Construction de l'index hors mesure
+
+    std::printf("Stockage de %zu entrées (%zu chemins, %zu utilisateurs)\n", rows, distinctPaths, users);
+    std::printf("  %-28s %10.1f Mo\n", "vector<UserAssistEntry>", legacyBytes / 1048576.0);
+    std::printf("  %-28s %10.1f Mo   (%zu chaînes internées)\n", "EntryStore", store.MemoryUsage() / 1048576.0,
+                store.strings.size());
+
+    BenchResult legacySort = Measure(3, rows * sizeof(UserAssistEntry), [&] {
+        std::vector<const UserAssistEntry*> order;
+        order.reserve(legacy.size());
+        for (const auto& e : legacy) order.push_back(&e);
+        std::sort(order.begin(), order.end(), [](const UserAssistEntry* a, const UserAssistEntry* b) {
+            return a->runCount > b->runCount;
+        });
+        g_sink += order[0]->runCount;
+    });
+    PrintResult("tri runCount (objets)", legacySort, legacySort.nsPerOp);
+
+    PrintResult("tri runCount (colonne)", Measure(3, rows * sizeof(uint32_t), [&] {
+        std::vector<uint32_t> order(store.size());
+        for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+        const uint32_t* runs = store.runCount.data();
+        std::sort(order.begin(), order.end(), [runs](uint32_t a, uint32_t b) { return runs[a] > runs[b]; });
+        g_sink += runs[order[0]];
+    }), legacySort.nsPerOp);
+
+    // Fenêtre d'une heure au milieu de la plage générée
+    const uint64_t from = 133000000000000000ull + 2000 * 10000000ull;
+    const uint64_t to = from + 3600 * 10000000ull;
+    BenchResult linear = Measure(20, rows * sizeof(uint64_t), [&] {
+        size_t hits = 0;
+        for (size_t i = 0; i < legacy.size(); i++) {
+            uint64_t ft = legacy[i].lastExecutionTime;
+            hits += (ft >= from && ft <= to);
+        }
+        g_sink += hits;
+    });
+    PrintResult("intervalle (parcours)", linear, linear.nsPerOp);
+    PrintResult("intervalle (index trié)", Measure(20, rows * sizeof(uint64_t), [&] {
+        g_sink += store.ExecutedBetween(from, to).size();
+    }), linear.nsPerOp);
+}
+
+// Sortie ignorée : ne mesure que la production des octets
+class NullSink : public ByteSink {
+public:
+    uint64_t bytes = 0;
+    bool Write(const char*, size_t size) override {
+        bytes += size;
+        return true;
+    }
+};
+
+static void BenchExport(size_t rows) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint32_t> counter(0, 5000);
+    EntryStore store;
+    uint32_t guid = store.strings.Intern(GUID_EXECUTABLE, std::wcslen(GUID_EXECUTABLE));
+    uint32_t user = store.strings.Intern(L"utilisateur", 11);
+    for (size_t i = 0; i < rows; i++) {
+        UserAssistCounters counters;
+        counters.runCount = counter(rng);
+        counters.focusCount = counter(rng);
+        counters.focusTime = counter(rng) * 1000;
+        counters.lastExecution = 133000000000000000ull + counter(rng) * 10000000ull;
+        counters.status = UA_TIME_VALID;
+        store.Append(DecodeROT13(MakeEncodedPath(rng, 40 + i % 80)), guid, user, counters);
+    }
+
+    std::printf("Export CSV de %zu lignes\n", rows);
+
+    // Ancien export : flux large, un << par champ, chaînes temporaires par ligne
+    BenchResult legacy = Measure(3, 0, [&] {
+        std::wostringstream csv;
+        UserAssistEntry entry;
+        for (size_t i = 0; i < store.size(); i++) {
+            store.GetEntry(i, entry);
+            csv << L"\"" << entry.application << L"\",\"" << entry.decodedPath << L"\",\"" << entry.runCount
+                << L"\",\"" << entry.lastExecution << L"\",\"" << entry.focusCount << L"\",\""
+                << MsToTimeString(entry.focusTime) << L"\",\"" << entry.guid << L"\",\"" << entry.username << L"\"\n";
+        }
+        g_sink += csv.str().size();
+    });
+    PrintResult("wostringstream (historique)", legacy, legacy.nsPerOp);
+
+    NullSink sink;
+    Utf8Writer writer(sink);
+    std::wstring scratch;
+    BenchResult streamed = Measure(3, 0, [&] {
+        CsvWriter csv(writer);
+        WriteUserAssistCsvHeader(csv, true);
+        for (size_t i = 0; i < store.size(); i++) {
+            WriteUserAssistCsvRow(csv, store, i, scratch);
+        }
+        writer.Flush();
+        g_sink += writer.BytesWritten();
+    });
+    PrintResult("Utf8Writer + CsvWriter", streamed, legacy.nsPerOp);
+    double bytesPerRun = static_cast<double>(sink.bytes) / 4;
+    std::printf("  %-28s %10.1f Mo/s UTF-8 produits\n", "débit", streamed.nsPerOp > 0 ?
+                (bytesPerRun / 1048576.0) / (streamed.nsPerOp / 1e9) : 0.0);
+}
+
+// Chaque GUID de la table est retrouvé, casse indifférente, et rien d'autre
+static bool VerifyKnownFolders() {
+    bool ok = true;
+    for (size_t i = 0; i < KNOWN_FOLDER_COUNT; i++) {
+        std::wstring path = std::wstring(KNOWN_FOLDERS[i].guid) + L"\\outil.exe";
+        std::wstring lower = path;
+        for (auto& ch : lower) ch = static_cast<wchar_t>(std::towlower(ch));
+        if (FindKnownFolder(path) != i + 1 || FindKnownFolder(lower) != i + 1 ||
+            FindKnownFolder(std::wstring_view(path).substr(0, 38)) != i + 1) {
+            std::printf("  Dossiers connus : ÉCHEC %zu\n", i);
+            ok = false;
+        }
+    }
+    // Valeurs de référence recopiées de KnownFolders.h du SDK (indépendantes de la table)
+    struct { const wchar_t* guid; const wchar_t* name; } references[] = {
+        { L"{6D809377-6AF0-444B-8957-A3773F02200E}", L"ProgramFilesX64" },
+        { L"{7C5A40EF-A0FB-4BFC-874A-C0F2E0B9FA8E}", L"ProgramFilesX86" },
+        { L"{905E63B6-C1BF-494E-B29C-65B732D3D21A}", L"ProgramFiles" },
+        { L"{1AC14E77-02E7-4E5D-B744-2EB1AE5198B7}", L"System" },
+        { L"{D65231B0-B2F1-4857-A4CE-A8E7C6EA7D27}", L"SystemX86" },
+        { L"{F38BF404-1D43-42F2-9305-67DE0B28FC23}", L"Windows" },
+        { L"{F1B32785-6FBA-4FCF-9D55-7B8E7F157091}", L"LocalAppData" },
+        { L"{3EB685DB-65F9-4CF6-A03A-E3EF65729F3D}", L"RoamingAppData" },
+        { L"{374DE290-123F-4565-9164-39C4925E467B}", L"Downloads" },
+        { L"{B4BFCC3A-DB2C-424C-B029-7FE99A87C641}", L"Desktop" },
+    };
+    for (const auto& reference : references) {
+        const KnownFolder* folder = KnownFolderById(FindKnownFolder(std::wstring(reference.guid) + L"\\outil.exe"));
+        if (!folder || std::wcscmp(folder->name, reference.name) != 0) {
+            std::printf("  Dossiers connus : ÉCHEC FOLDERID_%ls\n", reference.name);
+            ok = false;
+        }
+    }
+    const wchar_t* misses[] = {
+        L"C:\\Windows\\notepad.exe", L"{00000000-0000-0000-0000-000000000000}\\a.exe",
+        L"{6D809377-6AF0-444B-8957-A3773F02200E}x.exe", L"{6D809377-6AF0-444B-8957-A3773F02200", L"",
+    };
+    for (const wchar_t* miss : misses) {
+        if (FindKnownFolder(std::wstring_view(miss)) != 0) {
+            std::printf("  Dossiers connus : faux positif\n");
+            ok = false;
+        }
+    }
+    std::printf("  Dossiers connus : %s (%zu GUID)\n", ok ? "conforme" : "ÉCHEC", KNOWN_FOLDER_COUNT);
+    return ok;
+}
+
+// Handler de TriageArchive : réservations et membres comptés, rien n'est analysé
+struct ForgedArchiveFeed {
+    uint64_t reserved = 0;
+    uint64_t largest = 0;
+    uint64_t delivered = 0;
+    std::vector<std::string> errors;
+
+    void Reserve(uint64_t bytes) {
+        reserved += bytes;
+        largest = std::max(largest, bytes);
+    }
+    void Deliver(ArchiveHive&& hive) {
+        delivered += hive.reserved;
+        errors.push_back(hive.error);
+    }
+};
+
+static void PutLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+// En-tête ustar d'un membre NTUSER.DAT de taille annoncée quelconque (base 256)
+static std::vector<uint8_t> ForgeTarHeader(uint64_t size) {
+    std::vector<uint8_t> header(TAR_BLOCK, 0);
+    std::memcpy(header.data(), "Users/forge/NTUSER.DAT", 22);
+    std::memcpy(header.data() + 100, "0000644", 7);
+    header[124] = 0x80;
+    for (size_t i = 0; i < 8; i++) {
+        header[135 - i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+    header[156] = '0';
+    std::memcpy(header.data() + 257, "ustar", 6);
+    std::memcpy(header.data() + 263, "00", 2);
+    uint32_t sum = 8 * ' ';
+    for (size_t i = 0; i < TAR_BLOCK; i++) {
+        sum += i >= 148 && i < 156 ? 0 : header[i];
+    }
+    std::snprintf(reinterpret_cast<char*>(header.data()) + 148, 8, "%06o", sum);
+    return header;
+}
+
+// Zip : répertoire central d'une entrée (champs zip64 si fournis), suivi de la fin de répertoire
+static std::vector<uint8_t> ForgeZip(uint64_t localOffset, uint64_t zip64Directory) {
+    std::vector<uint8_t> zip = { 'P', 'K', 3, 4 };
+    zip.resize(64, 0);
+    size_t directory = zip.size();
+    const char name[] = "NTUSER.DAT";
+    PutLE(zip, 0x02014B50, 4);
+    PutLE(zip, 45, 2);                      // Version créatrice
+    PutLE(zip, 45, 2);                      // Version requise
+    PutLE(zip, 0, 2);                       // Drapeaux
+    PutLE(zip, 8, 2);                       // Deflate
+    PutLE(zip, 0, 4);                       // Heure, date
+    PutLE(zip, 0, 4);                       // CRC
+    PutLE(zip, 16, 4);                      // Taille compressée
+    PutLE(zip, 4096, 4);                    // Taille
+    PutLE(zip, 10, 2);
+    PutLE(zip, 12, 2);                      // Champ zip64 : offset local seul
+    PutLE(zip, 0, 2);                       // Commentaire
+    PutLE(zip, 0, 4);                       // Disque, attributs internes
+    PutLE(zip, 0, 4);                       // Attributs externes
+    PutLE(zip, 0xFFFFFFFF, 4);              // Offset local saturé
+    zip.insert(zip.end(), name, name + 10);
+    PutLE(zip, 0x0001, 2);
+    PutLE(zip, 8, 2);
+    PutLE(zip, localOffset, 8);
+    size_t directorySize = zip.size() - directory;
+    if (zip64Directory) {
+        PutLE(zip, 0x07064B50, 4);          // Localisateur zip64
+        PutLE(zip, 0, 4);
+        PutLE(zip, zip64Directory, 8);
+        PutLE(zip, 1, 4);
+    }
+    PutLE(zip, 0x06054B50, 4);
+    PutLE(zip, 0, 4);
+    PutLE(zip, zip64Directory ? 0xFFFF : 1, 2);
+    PutLE(zip, zip64Directory ? 0xFFFF : 1, 2);
+    PutLE(zip, directorySize, 4);
+    PutLE(zip, zip64Directory ? 0xFFFFFFFF : directory, 4);
+    PutLE(zip, 0, 2);
+    return zip;
+}
+
+// Gzip d'un seul bloc deflate stocké
+static std::vector<uint8_t> ForgeGzip(const std::vector<uint8_t>& content) {
+    std::vector<uint8_t> gz = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF, 0x01 };
+    PutLE(gz, content.size(), 2);
+    PutLE(gz, ~content.size() & 0xFFFF, 2);
+    gz.insert(gz.end(), content.begin(), content.end());
+    PutLE(gz, Crc32(0, content.data(), content.size()), 4);
+    PutLE(gz, content.size(), 4);
+    return gz;
+}
+
+// Archives forgées : tailles et offsets annoncés hors du fichier (débordements d'arithmétique)
+static bool VerifyForgedArchives() {
+    std::vector<uint8_t> tar = ForgeTarHeader(1ull << 62);
+    tar.resize(tar.size() + 4 * TAR_BLOCK, 0);
+    std::vector<uint8_t> tgz = ForgeTarHeader(1ull << 62);
+    tgz.resize(tgz.size() + 2 * TAR_BLOCK, 0);
+
+    struct {
+        const char* name;
+        std::vector<uint8_t> bytes;
+        bool readable;          // ReadTriageArchive doit renvoyer true
+        size_t members;         // Membres livrés (tous en échec)
+    } cases[] = {
+        { "tar, taille 2^62", tar, false, 0 },
+        { "tar.gz, taille 2^62", ForgeGzip(tgz), false, 0 },
+        { "zip64, fin de répertoire 2^64-16", ForgeZip(0, 0xFFFFFFFFFFFFFFF0ull), false, 0 },
+        { "zip, en-tête local 2^64-16", ForgeZip(0xFFFFFFFFFFFFFFF0ull, 0), true, 1 },
+    };
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "UserAssistBench-forged.bin";
+    bool ok = true;
+    for (const auto& c : cases) {
+        FILE* f = std::fopen(path.string().c_str(), "wb");
+        bool written = f && std::fwrite(c.bytes.data(), 1, c.bytes.size(), f) == c.bytes.size();
+        if (f) std::fclose(f);
+        auto file = std::make_shared<MappedFile>();
+        if (!written || !file->Open(path.c_str())) {
+            std::printf("  Archives forgées : ÉCHEC d'écriture (%s)\n", c.name);
+            ok = false;
+            continue;
+        }
+        ForgedArchiveFeed feed;
+        std::string error;
+        bool readable = ReadTriageArchive(std::shared_ptr<const MappedFile>(file), "NTUSER.DAT", feed, error);
+        bool failed = std::all_of(feed.errors.begin(), feed.errors.end(), [](const std::string& e) { return !e.empty(); });
+        if (readable != c.readable || feed.errors.size() != c.members || !failed ||
+            feed.reserved != feed.delivered || feed.largest > c.bytes.size() * DEFLATE_MAX_RATIO + 1024) {
+            std::printf("  Archives forgées : ÉCHEC %s (%s, %zu membres, %llu octets réservés)\n", c.name,
+                        error.c_str(), feed.errors.size(), static_cast<unsigned long long>(feed.largest));
+            ok = false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::printf("  Archives forgées : %s (%zu cas)\n", ok ? "rejetées" : "ÉCHEC", std::size(cases));
+    return ok;
+}
+
+// Référence : comparaison du préfixe avec chaque GUID de la table
+static uint8_t LinearKnownFolder(std::wstring_view path) {
+    for (size_t i = 0; i < KNOWN_FOLDER_COUNT; i++) {
+        std::wstring_view guid(KNOWN_FOLDERS[i].guid);
+        if (path.size() >= guid.size() && path.compare(0, guid.size(), guid) == 0) {
+            return static_cast<uint8_t>(i + 1);
+        }
+    }
+    return 0;
+}
+
+static void BenchKnownFolders(size_t iterations) {
+    SyntheticRng rng(3);
+    std::vector<std::wstring> paths;
+    for (size_t i = 0; i < 4096; i++) {
+        paths.push_back(MakeSyntheticPath(rng, false, false));
+    }
+    size_t hits = 0;
+    for (const auto& path : paths) hits += FindKnownFolder(path) != 0;
+    std::printf("Dossiers connus : %zu chemins, %zu avec GUID en tête\n", paths.size(), hits);
+
+    BenchResult linear = Measure(iterations / 10 + 1, 0, [&] {
+        size_t found = 0;
+        for (const auto& path : paths) found += LinearKnownFolder(path);
+        g_sink += found;
+    });
+    linear.nsPerOp /= paths.size();
+    PrintResult("recherche linéaire (/ligne)", linear, linear.nsPerOp);
+
+    BenchResult hashed = Measure(iterations / 10 + 1, 0, [&] {
+        size_t found = 0;
+        for (const auto& path : paths) found += FindKnownFolder(path);
+        g_sink += found;
+    });
+    hashed.nsPerOp /= paths.size();
+    PrintResult("hachage parfait (/ligne)", hashed, linear.nsPerOp);
+}
+
+// Pipeline complet sur une hive générée : chaque étape mesurée séparément
+static void BenchSyntheticHive(const SyntheticHiveOptions& options) {
+    SyntheticHiveStats stats;
+    std::vector<uint8_t> image = GenerateSyntheticHive(options, &stats);
+    HiveReader hive;
+    if (!hive.Open(image.data(), image.size())) {
+        std::printf("Hive synthétique : ÉCHEC d'ouverture\n");
+        return;
+    }
+    std::vector<std::wstring> guids = ListUserAssistGuids(hive);
+
+    std::printf("Hive synthétique (graine %llu) : %zu valeurs, %zu XP/Vista, %zu corrompues, %zu GUID, %.1f Mo\n",
+                static_cast<unsigned long long>(options.seed), stats.values, stats.legacy, stats.corrupt,
+                guids.size(), stats.bytes / 1048576.0);
+
+    // Valeurs brutes, dans l'ordre de la hive
+    std::vector<std::wstring> names;
+    std::vector<HiveValue> values;
+    size_t nameBytes = 0, dataBytes = 0;
+    for (const auto& guid : guids) {
+        ForEachUserAssistValue(hive, guid.c_str(), [&](const HiveValue& value) {
+            names.emplace_back();
+            value.name.AssignTo(names.back());
+            nameBytes += names.back().size() * sizeof(wchar_t);
+            dataBytes += value.dataSize;
+            values.push_back(value);
+            return true;
+        });
+    }
+    size_t iters = 5;
+
+    BenchResult rot13 = Measure(iters, nameBytes, [&] {
+        for (auto& name : names) {
+            DecodeROT13InPlace(&name[0], name.size());
+        }
+        g_sink += names[0][0];
+    });
+    PrintResult("ROT13 (noms en place)", rot13, rot13.nsPerOp);
+
+    BenchResult decode = Measure(iters, dataBytes, [&] {
+        uint64_t runs = 0;
+        for (const auto& value : values) {
+            runs += DecodeUserAssistCounters(value.data, value.dataSize, value.type).runCount;
+        }
+        g_sink += runs;
+    });
+    PrintResult("décodage binaire", decode, decode.nsPerOp);
+
+    BenchResult legacy = Measure(iters, image.size(), [&] {
+        std::vector<UserAssistEntry> entries;
+        for (const auto& guid : guids) {
+            ParseUserAssistHive(hive, guid.c_str(), L"utilisateur", entries);
+        }
+        g_sink += entries.size();
+    });
+    PrintResult("hive -> UserAssistEntry", legacy, legacy.nsPerOp);
+
+    PrintResult("hive -> flux", Measure(iters, image.size(), [&] {
+        size_t rows = 0;
+        for (const auto& guid : guids) {
+            StreamUserAssistHive(hive, guid.c_str(), [&](std::wstring_view, std::wstring_view decoded,
+                                                         const UserAssistCounters& counters) {
+                rows += decoded.size() + counters.runCount;
+            });
+        }
+        g_sink += rows;
+    }), legacy.nsPerOp);
+
+    EntryStore store;
+    PrintResult("hive -> EntryStore", Measure(iters, image.size(), [&] {
+        store.clear();
+        for (const auto& guid : guids) {
+            ParseUserAssistHive(hive, guid.c_str(), L"utilisateur", store);
+        }
+        g_sink += store.size();
+    }), legacy.nsPerOp);
+
+    wchar_t text[UA_TIME_TEXT_CHARS];
+    BenchResult format = Measure(iters, 0, [&] {
+        size_t chars = 0;
+        for (size_t i = 0; i < store.size(); i++) {
+            chars += FormatLastExecution(store.timeStatus[i], store.lastExecution[i], text);
+        }
+        g_sink += chars;
+    });
+    PrintResult("formatage dates", format, format.nsPerOp);
+
+    NullSink sink;
+    Utf8Writer writer(sink);
+    std::wstring scratch;
+    BenchResult exported = Measure(iters, 0, [&] {
+        CsvWriter csv(writer);
+        WriteUserAssistCsvHeader(csv, true);
+        for (size_t i = 0; i < store.size(); i++) {
+            WriteUserAssistCsvRow(csv, store, i, scratch);
+        }
+        writer.Flush();
+        g_sink += writer.BytesWritten();
+    });
+    PrintResult("export CSV", exported, exported.nsPerOp);
+    std::printf("  %-28s %10.1f valeurs/s de bout en bout\n", "débit hive -> CSV",
+                1e9 * values.size() / (legacy.nsPerOp + exported.nsPerOp));
+}
+
+// Réouverture d'un scan : cache mappé (validation + requête) vs nouvelle analyse de la hive
+static void BenchResultCache(const SyntheticHiveOptions& options) {
+    std::vector<uint8_t> image = GenerateSyntheticHive(options);
+    HiveReader hive;
+    if (!hive.Open(image.data(), image.size())) {
+        std::printf("Cache de résultats : ÉCHEC d'ouverture de la hive\n");
+        return;
+    }
+    std::vector<std::wstring> guids = ListUserAssistGuids(hive);
+    EntryStore store;
+    for (const auto& guid : guids) {
+        ParseUserAssistHive(hive, guid.c_str(), L"utilisateur", store);
+    }
+    uint64_t hash = HashContent(image.data(), image.size());
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "UserAssistBench.uacache";
+    if (!WriteResultCache(path, store, hash, 0)) {
+        std::printf("Cache de résultats : ÉCHEC d'écriture\n");
+        return;
+    }
+
+    // Aller-retour : mêmes lignes, mêmes chaînes
+    ResultCache cache;
+    std::string error;
+    EntryStore loaded;
+    bool ok = cache.Open(path, error) && cache.Verify(error) && cache.Matches(hash);
+    if (ok) {
+        cache.LoadInto(loaded);
+        ok = loaded.size() == store.size();
+        for (size_t row = 0; ok && row < store.size(); row++) {
+            ok = loaded.DecodedPath(row) == store.DecodedPath(row) &&
+                 loaded.strings.Get(loaded.userId[row]) == store.strings.Get(store.userId[row]) &&
+                 loaded.lastExecution[row] == store.lastExecution[row] && loaded.runCount[row] == store.runCount[row] &&
+                 loaded.timeStatus[row] == store.timeStatus[row] && loaded.knownFolder[row] == store.knownFolder[row];
+        }
+    }
+    std::printf("Cache de résultats : %zu lignes, %.1f Ko, aller-retour %s\n", store.size(),
+                std::filesystem::file_size(path) / 1024.0, ok ? "OK" : "ÉCHEC");
+    if (!ok) {
+        std::filesystem::remove(path);
+        return;
+    }
+    size_t iters = 20;
+
+    BenchResult parse = Measure(iters, image.size(), [&] {
+        EntryStore fresh;
+        for (const auto& guid : guids) {
+            ParseUserAssistHive(hive, guid.c_str(), L"utilisateur", fresh);
+        }
+        g_sink += fresh.size();
+    });
+    PrintResult("nouvelle analyse", parse, parse.nsPerOp);
+
+    PrintResult("hachage de la hive", Measure(iters, image.size(), [&] {
+        g_sink += HashContent(image.data(), image.size());
+    }), parse.nsPerOp);
+
+    // Requête du dernier mois de l'index, lue en place
+    uint64_t to = cache.TimeCount() ? cache.GetRow(cache.TimeRow(cache.TimeCount() - 1)).counters.lastExecution : 0;
+    uint64_t from = to > 30ull * 86400 * 10000000 ? to - 30ull * 86400 * 10000000 : 0;
+    PrintResult("ouverture + requête", Measure(iters, 0, [&] {
+        ResultCache reopened;
+        std::string openError;
+        size_t first = 0, last = 0;
+        if (reopened.Open(path, openError) && reopened.Matches(hash)) {
+            reopened.ExecutedBetween(from, to, first, last);
+            for (size_t i = first; i < last; i++) {
+                g_sink += reopened.GetRow(reopened.TimeRow(i)).counters.runCount;
+            }
+        }
+        g_sink += last - first;
+    }), parse.nsPerOp);
+
+    PrintResult("cache -> EntryStore", Measure(iters, 0, [&] {
+        EntryStore fresh;
+        cache.LoadInto(fresh);
+        g_sink += fresh.size();
+    }), parse.nsPerOp);
+
+    cache.Close();
+    std::filesystem::remove(path);
+}
+
+// Carving : noyaux de recherche de signatures puis récupération complète, sur une image formée
+// de copies d'une hive avec valeurs supprimées (hbins à la suite, comme dans un vidage mémoire)
+static void BenchCarving(SyntheticHiveOptions options) {
+    options.deletedPercent = 5;
+    SyntheticHiveStats stats;
+    std::vector<uint8_t> hive = GenerateSyntheticHive(options, &stats);
+
+    size_t copies = ((256u << 20) + hive.size() - 1) / hive.size();
+    std::vector<uint8_t> image;
+    image.reserve(copies * hive.size());
+    for (size_t i = 0; i < copies; i++) {
+        image.insert(image.end(), hive.begin(), hive.end());
+    }
+    std::printf("Carving : %zu valeurs supprimées par hive, image de %zu copies (%.1f Mo)\n",
+                stats.deleted, copies, image.size() / 1048576.0);
+
+    struct { const char* name; VkScanKernel kernel; } kernels[] = {
+        { "signatures vk scalaire", &VkScanScalar },
+#ifdef UA_ROT13_X86
+        { "signatures vk SSE2", &VkScanSse2 },
+        { "signatures vk AVX2", CpuSupportsAvx2() ? &VkScanAvx2 : nullptr },
+#endif
+    };
+    std::vector<size_t> expected, hits;
+    VkScanScalar(image.data(), 0, image.size(), expected);
+    double baseline = 0;
+    for (const auto& k : kernels) {
+        if (!k.kernel) {
+            continue;
+        }
+        hits.clear();
+        k.kernel(image.data(), 0, image.size(), hits);
+        if (hits != expected) {
+            std::printf("  %-28s ÉCHEC : %zu positions au lieu de %zu\n", k.name, hits.size(), expected.size());
+            continue;
+        }
+        BenchResult r = Measure(3, image.size(), [&] {
+            hits.clear();
+            k.kernel(image.data(), 0, image.size(), hits);
+            g_sink += hits.size();
+        });
+        if (baseline == 0) {
+            baseline = r.nsPerOp;
+        }
+        PrintResult(k.name, r, baseline);
+    }
+
+    // Récupération : toutes les valeurs supprimées en confiance haute, aucune valeur vivante
+    size_t recovered = 0, high = 0;
+    HiveCarver(hive.data(), hive.size()).Carve([&](const CarvedValue& value) {
+        recovered++;
+        high += value.confidence == CARVE_HIGH;
+        return true;
+    });
+    std::printf("  %-28s %zu/%zu (%zu confiance haute)\n", "valeurs récupérées", recovered, stats.deleted, high);
+
+    PrintResult("carving complet", Measure(3, image.size(), [&] {
+        size_t count = 0;
+        HiveCarver(image.data(), image.size()).Carve([&](const CarvedValue& value) {
+            count += value.decodedPath.size();
+            return true;
+        });
+        g_sink += count;
+    }), baseline);
+}
+
+// Arborescence Users/<profil>/NTUSER.DAT pour les essais de volume de UserAssistBatch
+static bool GenerateHiveTree(const std::filesystem::path& root, size_t profiles, SyntheticHiveOptions options) {
+    size_t values = 0, bytes = 0;
+    uint64_t seed = options.seed;
+    for (size_t i = 0; i < profiles; i++) {
+        options.seed = seed + i;
+        SyntheticHiveStats stats;
+        std::vector<uint8_t> image = GenerateSyntheticHive(options, &stats);
+
+        std::filesystem::path dir = root / "Users" / ("utilisateur" + std::to_string(i));
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::ofstream out(dir / "NTUSER.DAT", std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()))) {
+            std::fprintf(stderr, "Écriture impossible : %s\n", (dir / "NTUSER.DAT").string().c_str());
+            return false;
+        }
+        values += stats.values;
+        bytes += stats.bytes;
+    }
+    std::printf("%zu hives générées dans %s : %zu valeurs, %.1f Mo\n",
+                profiles, root.string().c_str(), values, bytes / 1048576.0);
+    return true;
+}
+
+// Rendu historique : FileTimeToSystemTime + swprintf_s (simulé de façon portable)
+static size_t LegacyFormatFileTime(uint64_t ft, wchar_t* out, size_t capacity) {
+    int64_t year;
+    uint32_t month, day;
+    uint64_t seconds = ft / FILETIME_TICKS_PER_SECOND;
+    CivilFromFileTimeDays(seconds / 86400, year, month, day);
+    uint32_t sod = static_cast<uint32_t>(seconds % 86400);
+    int n = std::swprintf(out, capacity, L"%02u/%02u/%04lld %02u:%02u:%02u", day, month,
+                          static_cast<long long>(year), sod / 3600, (sod / 60) % 60, sod % 60);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+static bool VerifyIso8601() {
+    // Valeurs de référence (calculées indépendamment)
+    struct { uint64_t ft; const char* text; } cases[] = {
+        { 1, "1601-01-01T00:00:00Z" },
+        { 116444736000000000ull, "1970-01-01T00:00:00Z" },
+        { 125911584000000000ull, "2000-01-01T00:00:00Z" },
+        { 125963423990000000ull, "2000-02-29T23:59:59Z" },
+        { 133000000000000000ull, "2022-06-18T04:26:40Z" },
+        { FILETIME_MAX_VALID, "30828-09-14T02:48:05Z" },
+    };
+    bool ok = true;
+    for (const auto& c : cases) {
+        char buf[UA_TIME_TEXT_CHARS];
+        size_t length = FormatFileTimeIso8601(c.ft, buf);
+        if (length != std::strlen(c.text) || std::strcmp(buf, c.text) != 0) {
+            std::printf("  ISO-8601 : ÉCHEC %llu -> %s (attendu %s)\n",
+                        static_cast<unsigned long long>(c.ft), buf, c.text);
+            ok = false;
+        }
+    }
+    std::printf("  ISO-8601 : %s\n", ok ? "conforme" : "ÉCHEC");
+    return ok;
+}
+
+static void BenchTimeFormat(size_t iterations) {
+    std::printf("Formatage FILETIME\n");
+    wchar_t buf[64];
+    uint64_t ft = 133000000000000000ull;
+    BenchResult legacy = Measure(iterations * 50, 0, [&] {
+        ft += 10000000ull * 37;
+        g_sink += LegacyFormatFileTime(ft, buf, 64);
+    });
+    PrintResult("swprintf (historique)", legacy, legacy.nsPerOp);
+    PrintResult("ISO-8601 (table)", Measure(iterations * 50, 0, [&] {
+        ft += 10000000ull * 37;
+        g_sink += FormatFileTimeIso8601(ft, buf);
+    }), legacy.nsPerOp);
+}
+
+static size_t CountLines(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(in, line)) {
+        lines++;
+    }
+    return lines;
+}
+
+static void BenchLog(size_t messages) {
+    constexpr size_t THREADS = 4;
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::filesystem::path legacyPath = dir / "UserAssistBench-legacy.log";
+    std::filesystem::path asyncPath = dir / "UserAssistBench-async.log";
+    size_t perThread = messages / THREADS;
+    std::wstring message = L"Valeur décodée : C:\\Program Files\\Application\\outil.exe";
+
+    std::printf("Journal : %zu messages, %zu threads producteurs\n", perThread * THREADS, THREADS);
+
+    auto run = [&](auto&& produce) {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREADS; t++) {
+            threads.emplace_back([&] {
+                for (size_t i = 0; i < perThread; i++) produce();
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    };
+
+    // Ancien journal : horodatage formaté et flush à chaque ligne, sérialisé par un verrou
+    BenchResult legacy = Measure(1, 0, [&] {
+        std::FILE* file = std::fopen(legacyPath.string().c_str(), "wb");
+        std::mutex lock;
+        std::string utf8;
+        run([&] {
+            std::lock_guard<std::mutex> guard(lock);
+            std::time_t now = std::time(nullptr);
+            char prefix[32];
+            std::strftime(prefix, sizeof(prefix), "[%d/%m/%Y %H:%M:%S] ", std::localtime(&now));
+            utf8.clear();
+            AppendUtf8(utf8, message.data(), message.size());
+            std::fprintf(file, "%s%s\n", prefix, utf8.c_str());
+            std::fflush(file);
+        });
+        std::fclose(file);
+    });
+    PrintResult("fprintf + fflush (historique)", legacy, legacy.nsPerOp);
+
+    BenchResult async = Measure(1, 0, [&] {
+        std::filesystem::remove(asyncPath);
+        AsyncLogger logger;
+        logger.Open(asyncPath);
+        run([&] { logger.Write(UA_LOG_INFO, message); });
+        logger.Close();
+    });
+    PrintResult("AsyncLogger (vidé)", async, legacy.nsPerOp);
+
+    size_t lines = CountLines(asyncPath);
+    std::printf("  %-28s %zu/%zu lignes\n", "journal complet", lines, perThread * THREADS);
+    std::filesystem::remove(legacyPath);
+    std::filesystem::remove(asyncPath);
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = 20000;
+    size_t profiles = 10;
+    std::filesystem::path generate;
+    SyntheticHiveOptions synthetic;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            iterations = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-v" && i + 1 < argc) {
+            synthetic.valuesPerGuid = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-s" && i + 1 < argc) {
+            synthetic.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-u" && i + 1 < argc) {
+            profiles = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-g" && i + 1 < argc) {
+            generate = argv[++i];
+        } else if (arg == "-d" && i + 1 < argc) {
+            synthetic.deletedPercent = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    if (synthetic.valuesPerGuid == 0) {
+        synthetic.valuesPerGuid = 1;
+    }
+    if (!generate.empty()) {
+        return GenerateHiveTree(generate, profiles, synthetic) ? 0 : 1;
+    }
+
+    if (!VerifyRot13() || !VerifyIso8601() || !VerifyKnownFolders() || !VerifyForgedArchives()) {
+        return 1;
+    }
+    std::printf("\n");
+    BenchRot13(iterations);
+    std::printf("\n");
+    BenchTimeFormat(iterations);
+    std::printf("\n");
+    BenchEntryStore(iterations * 25);
+    std::printf("\n");
+    BenchExport(iterations * 25);
+    std::printf("\n");
+    BenchLog(iterations * 10);
+    std::printf("\n");
+    BenchKnownFolders(iterations);
+    std::printf("\n");
+    BenchSyntheticHive(synthetic);
+    std::printf("\n");
+    BenchResultCache(synthetic);
+    std::printf("\n");
+    BenchCarving(synthetic);
+    return 0;
+}
@@ -0,0 +1,576 @@
+/*
+ * UserAssistCore - types et décodage communs (WinToolsSuite Serie 3 #21)
+ * Partagé entre l'interface graphique (registre live) et le lecteur de hives offline.
+ *
+ * Portable : aucune dépendance à windows.h, compile aussi sous Linux.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <string>
+
+#include "Rot13.h"
+
+// Version des outils (rapports de performance, suivi d'une version à l'autre)
+constexpr const char* USERASSIST_VERSION = "1.0";
+
+// GUIDs UserAssist
+constexpr const wchar_t* GUID_EXECUTABLE = L"{CEBFF5CD-ACE2-4F4F-9178-9926F41749EA}";
+constexpr const wchar_t* GUID_SHORTCUT = L"{F4E57C4B-2036-45F0-A9AB-443BCFE33D9F}";
+
+// Chemin de la clé UserAssist relatif à la racine du profil (HKCU ou hive NTUSER.DAT)
+constexpr const wchar_t* USERASSIST_KEY_PATH = L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\UserAssist";
+
+// Types de valeurs registre (identiques à winnt.h)
+constexpr uint32_t UA_REG_BINARY = 3;
+
+// État de l'horodatage d'une entrée (le texte affiché en dépend)
+enum UserAssistTimeStatus : uint8_t {
+    UA_TIME_VALID = 0,      // FILETIME lu (0 = "Jamais")
+    UA_TIME_LEGACY = 1,     // Disposition non reconnue (taille inattendue), compteurs non lus
+    UA_TIME_INVALID = 2     // Données trop courtes ou type inattendu
+};
+
+// Structure pour une entrée UserAssist
+struct UserAssistEntry {
+    std::wstring application;
+    std::wstring decodedPath;
+    uint32_t runCount = 0;
+    std::wstring lastExecution;
+    uint64_t lastExecutionTime = 0;     // FILETIME brut
+    uint8_t timeStatus = UA_TIME_INVALID;
+    uint32_t focusCount = 0;
+    uint32_t focusTime = 0;
+    std::wstring guid;
+    std::wstring username;
+};
+
+// Lecture little-endian sans alignement requis
+inline uint16_t ReadLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t ReadLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t ReadLE64(const uint8_t* p) {
+    return static_cast<uint64_t>(ReadLE32(p)) | (static_cast<uint64_t>(ReadLE32(p + 4)) << 32);
+}
+
+// Somme de contrôle des fichiers produits (FNV-1a 32 bits)
+inline uint32_t Fnv1a32(const uint8_t* data, size_t size) {
+    uint32_t h = 0x811c9dc5;
+    for (size_t i = 0; i < size; i++) {
+        h ^= data[i];
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+// Décodage ROT13 dans un buffer existant (noyau SIMD choisi à l'exécution)
+inline void DecodeROT13InPlace(wchar_t* text, size_t length) {
+    DecodeROT13Buffer(text, text, length);
+}
+
+// Décodage ROT13
+inline std::wstring DecodeROT13(const std::wstring& input) {
+    std::wstring output(input);
+    DecodeROT13InPlace(&output[0], output.size());
+    return output;
+}
+
+// Ajoute une chaîne UTF-16LE brute (telle que stockée dans une hive) à un wstring.
+// Sous Windows wchar_t est déjà UTF-16 ; ailleurs les paires de substitution sont recombinées.
+inline void AppendUtf16LE(std::wstring& out, const uint8_t* data, size_t bytes) {
+    size_t count = bytes / 2;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t cu = ReadLE16(data + i * 2);
+        if (sizeof(wchar_t) == 4 && cu >= 0xD800 && cu <= 0xDBFF && i + 1 < count) {
+            uint32_t low = ReadLE16(data + (i + 1) * 2);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                cu = 0x10000 + ((cu - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        out.push_back(static_cast<wchar_t>(cu));
+    }
+}
+
+// Ajoute une chaîne Latin-1 (nom "compressé" dans une hive) à un wstring
+inline void AppendLatin1(std::wstring& out, const uint8_t* data, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<wchar_t>(data[i]));
+    }
+}
+
+// FILETIME (100 ns depuis 1601-01-01 UTC)
+constexpr uint64_t FILETIME_TICKS_PER_SECOND = 10000000ull;
+constexpr uint64_t FILETIME_MAX_VALID = 0x7FFFFFFFFFFFFFFFull;   // Limite de FileTimeToSystemTime
+
+// Taille minimale d'un buffer de FormatFileTimeIso8601 / FormatLastExecution (zéro final inclus)
+constexpr size_t UA_TIME_TEXT_CHARS = 32;
+
+// Jours depuis 1601-01-01 → date civile (algorithme de H. Hinnant, ères de 400 ans)
+inline void CivilFromFileTimeDays(uint64_t days, int64_t& year, uint32_t& month, uint32_t& day) {
+    int64_t z = static_cast<int64_t>(days) - 134774 + 719468;   // Décalage vers 0000-03-01
+    int64_t era = z / 146097;
+    uint32_t doe = static_cast<uint32_t>(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    year = static_cast<int64_t>(yoe) + era * 400;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    if (month <= 2) {
+        year++;
+    }
+}
+
+// ISO-8601 UTC "AAAA-MM-JJThh:mm:ssZ" sans appel système ni locale ; renvoie la longueur
+template <typename CharT>
+inline size_t FormatFileTimeIso8601(uint64_t ft, CharT* out) {
+    static const char digits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    uint64_t totalSeconds = ft / FILETIME_TICKS_PER_SECOND;
+    uint32_t secOfDay = static_cast<uint32_t>(totalSeconds % 86400);
+    int64_t year;
+    uint32_t month, day;
+    CivilFromFileTimeDays(totalSeconds / 86400, year, month, day);
+
+    auto put2 = [&](size_t pos, uint32_t value) {
+        out[pos] = static_cast<CharT>(digits[value * 2]);
+        out[pos + 1] = static_cast<CharT>(digits[value * 2 + 1]);
+    };
+
+    // Année sur 4 chiffres, 5 au-delà de 9999 (FILETIME valide jusqu'en 30828)
+    uint32_t y = static_cast<uint32_t>(year);
+    size_t p = 0;
+    if (y > 9999) {
+        out[p++] = static_cast<CharT>('0' + y / 10000);
+        y %= 10000;
+    }
+    put2(p, y / 100);
+    put2(p + 2, y % 100);
+    out[p + 4] = CharT('-');
+    put2(p + 5, month);
+    out[p + 7] = CharT('-');
+    put2(p + 8, day);
+    out[p + 10] = CharT('T');
+    put2(p + 11, secOfDay / 3600);
+    out[p + 13] = CharT(':');
+    put2(p + 14, (secOfDay / 60) % 60);
+    out[p + 16] = CharT(':');
+    put2(p + 17, secOfDay % 60);
+    out[p + 19] = CharT('Z');
+    out[p + 20] = CharT(0);
+    return p + 20;
+}
+
+// Date civile → jours depuis 1601-01-01 (inverse de CivilFromFileTimeDays)
+inline int64_t FileTimeDaysFromCivil(int64_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = static_cast<uint32_t>(year - era * 400);
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468 + 134774;
+}
+
+// Lecture "AAAA-MM-JJ", "AAAA-MM-JJThh:mm[:ss][Z]" (espace accepté à la place du T), en UTC.
+// Renvoie false si le texte n'est pas une date valide postérieure à 1601.
+template <typename CharT>
+inline bool ParseIso8601(const CharT* text, uint64_t& fileTime) {
+    uint32_t fields[6] = { 0, 0, 0, 0, 0, 0 };
+    const size_t widths[6] = { 4, 2, 2, 2, 2, 2 };
+    const char separators[6] = { 0, '-', '-', 'T', ':', ':' };
+
+    const CharT* p = text;
+    size_t count = 0;
+    for (; count < 6; count++) {
+        if (count > 0) {
+            if (*p == CharT(0) || *p == CharT('Z')) {
+                break;
+            }
+            bool dateTimeSeparator = count == 3 && *p == CharT(' ');
+            if (*p != CharT(separators[count]) && !dateTimeSeparator) {
+                return false;
+            }
+            p++;
+        }
+        for (size_t i = 0; i < widths[count]; i++, p++) {
+            if (*p < CharT('0') || *p > CharT('9')) {
+                return false;
+            }
+            fields[count] = fields[count] * 10 + static_cast<uint32_t>(*p - CharT('0'));
+        }
+    }
+    if (*p == CharT('Z')) {
+        p++;
+    }
+    if (*p != CharT(0) || count < 3 || count == 4) {
+        return false;
+    }
+
+    static const uint8_t monthDays[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    uint32_t year = fields[0], month = fields[1], day = fields[2];
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (year < 1601 || month < 1 || month > 12 || day < 1 || day > monthDays[month - 1] ||
+        (month == 2 && day == 29 && !leap) || fields[3] > 23 || fields[4] > 59 || fields[5] > 59) {
+        return false;
+    }
+
+    uint64_t days = static_cast<uint64_t>(FileTimeDaysFromCivil(year, month, day));
+    uint64_t seconds = days * 86400 + fields[3] * 3600ull + fields[4] * 60ull + fields[5];
+    fileTime = seconds * FILETIME_TICKS_PER_SECOND;
+    return true;
+}
+
+inline std::wstring FileTimeToString(uint64_t ft) {
+    if (ft == 0) {
+        return L"Jamais";
+    }
+    if (ft > FILETIME_MAX_VALID) {
+        return L"Invalide";
+    }
+    wchar_t buf[UA_TIME_TEXT_CHARS];
+    size_t length = FormatFileTimeIso8601(ft, buf);
+    return std::wstring(buf, length);
+}
+
+// Durée de focus lisible (ex: "1h 02m 03s")
+// Taille minimale d'un buffer de FormatDuration (zéro final inclus)
+constexpr size_t UA_DURATION_TEXT_CHARS = 24;
+
+// "1h 02m 03s" / "2m 03s" / "3s", sans swprintf ; renvoie la longueur
+template <typename CharT>
+inline size_t FormatDuration(uint32_t milliseconds, CharT* out) {
+    uint32_t seconds = milliseconds / 1000;
+    uint32_t minutes = seconds / 60;
+    uint32_t hours = minutes / 60;
+
+    seconds %= 60;
+    minutes %= 60;
+
+    size_t length = 0;
+    auto putNumber = [&](uint32_t value, size_t minDigits) {
+        CharT digits[10];
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<CharT>('0' + value % 10);
+            value /= 10;
+        } while (value || count < minDigits);
+        while (count) {
+            out[length++] = digits[--count];
+        }
+    };
+
+    if (hours > 0) {
+        putNumber(hours, 1);
+        out[length++] = CharT('h');
+        out[length++] = CharT(' ');
+    }
+    if (hours > 0 || minutes > 0) {
+        putNumber(minutes, hours > 0 ? 2 : 1);
+        out[length++] = CharT('m');
+        out[length++] = CharT(' ');
+    }
+    putNumber(seconds, hours > 0 || minutes > 0 ? 2 : 1);
+    out[length++] = CharT('s');
+    out[length] = CharT(0);
+    return length;
+}
+
+inline std::wstring MsToTimeString(uint32_t milliseconds) {
+    wchar_t buf[UA_DURATION_TEXT_CHARS];
+    size_t length = FormatDuration(milliseconds, buf);
+    return std::wstring(buf, length);
+}
+
+// Octets UTF-8 maximum par unité wchar_t (UTF-32 : 4 ; UTF-16 : 3, ou 4 pour une paire)
+constexpr size_t UTF8_MAX_PER_WCHAR = 4;
+
+// Encodage UTF-8 d'un texte wchar_t (UTF-16 sous Windows, UTF-32 ailleurs) dans un buffer
+// d'au moins length * UTF8_MAX_PER_WCHAR octets. Renvoie le nombre d'octets.
+// DoubleQuotes : '"' écrit deux fois (échappement CSV RFC 4180, reste sous la borne)
+template <bool DoubleQuotes = false>
+inline size_t EncodeUtf8(const wchar_t* text, size_t length, char* out) {
+    char* p = out;
+    for (size_t i = 0; i < length; i++) {
+        uint32_t cp = static_cast<uint32_t>(text[i]);
+        if (cp < 0x80) {
+            // Chemin rapide ASCII (la quasi-totalité des chemins)
+            *p++ = static_cast<char>(cp);
+            if (DoubleQuotes && cp == '"') {
+                *p++ = '"';
+            }
+            continue;
+        }
+        if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < length) {
+            uint32_t low = static_cast<uint32_t>(text[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i++;
+            }
+        }
+        if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) {
+            cp = 0xFFFD;   // Demi-paire isolée ou hors Unicode
+        }
+
+        if (cp < 0x800) {
+            *p++ = static_cast<char>(0xC0 | (cp >> 6));
+            *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *p++ = static_cast<char>(0xE0 | (cp >> 12));
+            *p++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *p++ = static_cast<char>(0xF0 | (cp >> 18));
+            *p++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *p++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *p++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return static_cast<size_t>(p - out);
+}
+
+inline void AppendUtf8(std::string& out, const wchar_t* text, size_t length) {
+    size_t used = out.size();
+    out.resize(used + length * UTF8_MAX_PER_WCHAR);
+    out.resize(used + EncodeUtf8(text, length, &out[used]));
+}
+
+inline void AppendUtf8(std::string& out, const std::wstring& text) {
+    AppendUtf8(out, text.data(), text.size());
+}
+
+// Dispositions des données Count, reconnues à leur taille (la valeur "Version" de la clé n'est pas lue)
+enum UserAssistLayout : uint8_t {
+    UA_LAYOUT_INVALID = 0,  // Type autre que REG_BINARY ou moins de 16 octets
+    UA_LAYOUT_UNKNOWN,      // Taille entre les deux formats connus
+    UA_LAYOUT_XP,           // XP/Vista, version 3 : 16 octets
+    UA_LAYOUT_WIN7,         // Windows 7 à 11, version 5 : 72 octets
+    UA_LAYOUT_COUNT
+};
+
+constexpr const char* UA_LAYOUT_NAMES[UA_LAYOUT_COUNT] = { "invalide", "inconnue", "XP", "Win7" };
+
+// Compteurs décodés d'une valeur Count (POD, sans allocation)
+struct UserAssistCounters {
+    uint32_t runCount = 0;
+    uint32_t focusCount = 0;
+    uint32_t focusTime = 0;
+    uint32_t session = 0;           // Identifiant de session du dernier lancement
+    uint64_t lastExecution = 0;     // FILETIME brut
+    uint8_t status = UA_TIME_INVALID;
+    uint8_t layout = UA_LAYOUT_INVALID;
+};
+
+// Champs propres au format Windows 7+, lus à la demande (non conservés dans les colonnes)
+constexpr size_t UA_FOCUS_RATIO_COUNT = 10;
+
+struct UserAssistDetails {
+    float focusRatios[UA_FOCUS_RATIO_COUNT] = {};   // r0..r9, -1.0 tant que non renseigné
+    uint32_t ratioIndex = 0xFFFFFFFF;               // Dernier ratio mis à jour (0xFFFFFFFF = aucun)
+};
+
+// Disposition d'une valeur : offsets et décodage spécialisés à la compilation.
+// Lectures octet par octet (ReadLE32/64) : ni accès non aligné, ni dépendance à l'ordre des octets de l'hôte ;
+// data contient au moins SIZE octets (garanti par UserAssistLayoutFor).
+template <UserAssistLayout L>
+struct UserAssistLayoutTraits;
+
+template <>
+struct UserAssistLayoutTraits<UA_LAYOUT_INVALID> {
+    static constexpr size_t SIZE = 0;
+    static void Decode(const uint8_t*, UserAssistCounters& counters) {
+        counters = UserAssistCounters();
+    }
+};
+
+template <>
+struct UserAssistLayoutTraits<UA_LAYOUT_UNKNOWN> {
+    static constexpr size_t SIZE = 0;
+    static void Decode(const uint8_t*, UserAssistCounters& counters) {
+        counters = UserAssistCounters();
+        counters.status = UA_TIME_LEGACY;
+        counters.layout = UA_LAYOUT_UNKNOWN;
+    }
+};
+
+// XP/Vista : session @0, compteur @4 (commence à 5), FILETIME @8
+template <>
+struct UserAssistLayoutTraits<UA_LAYOUT_XP> {
+    static constexpr size_t SIZE = 16;
+    static constexpr size_t SESSION = 0x00;
+    static constexpr size_t RUN_COUNT = 0x04;
+    static constexpr size_t LAST_EXECUTION = 0x08;
+    static constexpr uint32_t RUN_COUNT_BASE = 5;
+
+    static void Decode(const uint8_t* data, UserAssistCounters& counters) {
+        uint32_t stored = ReadLE32(data + RUN_COUNT);
+        counters.runCount = stored > RUN_COUNT_BASE ? stored - RUN_COUNT_BASE : 0;
+        counters.focusCount = 0;
+        counters.focusTime = 0;
+        counters.session = ReadLE32(data + SESSION);
+        counters.lastExecution = ReadLE64(data + LAST_EXECUTION);
+        counters.status = UA_TIME_VALID;
+        counters.layout = UA_LAYOUT_XP;
+    }
+};
+
+// Windows 7+ : session @0, compteur @4, focus @8, temps de focus (ms) @0xC, ratios r0..r9 (float) @0x10,
+// index du dernier ratio @0x38, FILETIME @0x3C, 4 octets inutilisés @0x44
+template <>
+struct UserAssistLayoutTraits<UA_LAYOUT_WIN7> {
+    static constexpr size_t SIZE = 72;
+    static constexpr size_t SESSION = 0x00;
+    static constexpr size_t RUN_COUNT = 0x04;
+    static constexpr size_t FOCUS_COUNT = 0x08;
+    static constexpr size_t FOCUS_TIME = 0x0C;
+    static constexpr size_t FOCUS_RATIOS = 0x10;
+    static constexpr size_t RATIO_INDEX = 0x38;
+    static constexpr size_t LAST_EXECUTION = 0x3C;
+
+    static void Decode(const uint8_t* data, UserAssistCounters& counters) {
+        counters.runCount = ReadLE32(data + RUN_COUNT);
+        counters.focusCount = ReadLE32(data + FOCUS_COUNT);
+        counters.focusTime = ReadLE32(data + FOCUS_TIME);
+        counters.session = ReadLE32(data + SESSION);
+        counters.lastExecution = ReadLE64(data + LAST_EXECUTION);
+        counters.status = UA_TIME_VALID;
+        counters.layout = UA_LAYOUT_WIN7;
+    }
+
+    static void DecodeDetails(const uint8_t* data, UserAssistDetails& details) {
+        for (size_t i = 0; i < UA_FOCUS_RATIO_COUNT; i++) {
+            uint32_t bits = ReadLE32(data + FOCUS_RATIOS + i * 4);
+            std::memcpy(&details.focusRatios[i], &bits, sizeof(float));
+        }
+        details.ratioIndex = ReadLE32(data + RATIO_INDEX);
+    }
+};
+
+static_assert(UserAssistLayoutTraits<UA_LAYOUT_WIN7>::LAST_EXECUTION + 8 <= UserAssistLayoutTraits<UA_LAYOUT_WIN7>::SIZE,
+              "FILETIME hors de la structure Windows 7");
+static_assert(UserAssistLayoutTraits<UA_LAYOUT_XP>::LAST_EXECUTION + 8 <= UserAssistLayoutTraits<UA_LAYOUT_XP>::SIZE,
+              "FILETIME hors de la structure XP");
+
+// Choix de la disposition ; au-delà de 72 octets, les octets en trop sont ignorés
+inline UserAssistLayout UserAssistLayoutFor(size_t dataSize, uint32_t type) {
+    if (type != UA_REG_BINARY || dataSize < UserAssistLayoutTraits<UA_LAYOUT_XP>::SIZE) {
+        return UA_LAYOUT_INVALID;
+    }
+    if (dataSize >= UserAssistLayoutTraits<UA_LAYOUT_WIN7>::SIZE) {
+        return UA_LAYOUT_WIN7;
+    }
+    return dataSize == UserAssistLayoutTraits<UA_LAYOUT_XP>::SIZE ? UA_LAYOUT_XP : UA_LAYOUT_UNKNOWN;
+}
+
+// Table de décodeurs indexée par disposition
+using UserAssistLayoutDecoder = void (*)(const uint8_t*, UserAssistCounters&);
+
+constexpr UserAssistLayoutDecoder UA_LAYOUT_DECODERS[UA_LAYOUT_COUNT] = {
+    &UserAssistLayoutTraits<UA_LAYOUT_INVALID>::Decode,
+    &UserAssistLayoutTraits<UA_LAYOUT_UNKNOWN>::Decode,
+    &UserAssistLayoutTraits<UA_LAYOUT_XP>::Decode,
+    &UserAssistLayoutTraits<UA_LAYOUT_WIN7>::Decode,
+};
+
+// Interprétation des données binaires d'une valeur Count
+inline UserAssistCounters DecodeUserAssistCounters(const uint8_t* data, size_t dataSize, uint32_t type) {
+    UserAssistCounters counters;
+    UA_LAYOUT_DECODERS[UserAssistLayoutFor(dataSize, type)](data, counters);
+    return counters;
+}
+
+// Ratios de focus et index du dernier ratio (Windows 7+ seulement) ; false pour les autres dispositions
+inline bool DecodeUserAssistDetails(const uint8_t* data, size_t dataSize, uint32_t type, UserAssistDetails& details) {
+    if (UserAssistLayoutFor(dataSize, type) != UA_LAYOUT_WIN7) {
+        return false;
+    }
+    UserAssistLayoutTraits<UA_LAYOUT_WIN7>::DecodeDetails(data, details);
+    return true;
+}
+
+// Données d'une valeur Count à décoder (pointeur stable pendant le décodage, ex. hive mappée)
+struct UserAssistBlob {
+    const uint8_t* data;
+    uint32_t size;
+    uint32_t type;
+};
+
+// Colonnes de destination d'un décodage par lot (count éléments chacune)
+struct UserAssistColumns {
+    uint32_t* runCount;
+    uint32_t* focusCount;
+    uint32_t* focusTime;
+    uint64_t* lastExecution;
+    uint8_t* timeStatus;
+};
+
+// Décodage d'un lot de valeurs directement dans des colonnes (une entrée de table par valeur)
+inline void DecodeUserAssistBatch(const UserAssistBlob* blobs, size_t count, const UserAssistColumns& out) {
+    UserAssistCounters counters;
+    for (size_t i = 0; i < count; i++) {
+        UA_LAYOUT_DECODERS[UserAssistLayoutFor(blobs[i].size, blobs[i].type)](blobs[i].data, counters);
+        out.runCount[i] = counters.runCount;
+        out.focusCount[i] = counters.focusCount;
+        out.focusTime[i] = counters.focusTime;
+        out.lastExecution[i] = counters.lastExecution;
+        out.timeStatus[i] = counters.status;
+    }
+}
+
+// Texte de la colonne "Dernière Exec", formaté à la demande dans un buffer de UA_TIME_TEXT_CHARS.
+// CharT = wchar_t pour l'affichage, char pour les exports UTF-8. Renvoie la longueur.
+template <typename CharT>
+inline size_t FormatLastExecution(uint8_t status, uint64_t lastExecution, CharT* out) {
+    const char* text;
+    if (status == UA_TIME_VALID) {
+        if (lastExecution != 0 && lastExecution <= FILETIME_MAX_VALID) {
+            return FormatFileTimeIso8601(lastExecution, out);
+        }
+        text = lastExecution == 0 ? "Jamais" : "Invalide";
+    } else if (status == UA_TIME_LEGACY) {
+        text = "N/A (format inconnu)";
+    } else {
+        text = "Donn\xC3\xA9" "es invalides";     // UTF-8
+    }
+
+    // Recopie : octets UTF-8 tels quels en char, décodés en wchar_t (seul 'é' est non ASCII)
+    size_t length = 0;
+    for (const char* p = text; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (sizeof(CharT) > 1 && c == 0xC3) {
+            out[length++] = static_cast<CharT>(0xC0 | (static_cast<unsigned char>(*++p) & 0x3F));
+        } else {
+            out[length++] = static_cast<CharT>(c);
+        }
+    }
+    out[length] = CharT(0);
+    return length;
+}
+
+inline std::wstring LastExecutionText(uint8_t status, uint64_t lastExecution) {
+    wchar_t buf[UA_TIME_TEXT_CHARS];
+    size_t length = FormatLastExecution(status, lastExecution, buf);
+    return std::wstring(buf, length);
+}
+
+inline void DecodeUserAssistData(const uint8_t* data, size_t dataSize, uint32_t type, UserAssistEntry& entry) {
+    UserAssistCounters counters = DecodeUserAssistCounters(data, dataSize, type);
+    entry.runCount = counters.runCount;
+    entry.focusCount = counters.focusCount;
+    entry.focusTime = counters.focusTime;
+    entry.lastExecutionTime = counters.lastExecution;
+    entry.timeStatus = counters.status;
+    entry.lastExecution = LastExecutionText(counters.status, counters.lastExecution);
+}
@@ -3,12 +3,21 @@
  * Décode UserAssist (GUID compteurs ROT13), timeline applications exécutées par user
  *
  * Fonctionnalités :
- * - Registry : HKCU\Software\Microsoft\Windows\CurrentVersion\Explorer\UserAssist\{GUID}\Count
+ * - Registry : HKU\<SID> (profils chargés) ou HKCU, Software\Microsoft\Windows\CurrentVersion\Explorer\UserAssist\{GUID}\Count
+ * - Scan parallèle de toutes les sous-clés {GUID} de chaque profil, annulable, progression en direct
+ * - Résultats publiés par lots immuables pendant le scan (ResultModel.h) : ListView virtuelle remplie
+ *   progressivement, cellules formatées à la demande (cache LRU), exports sur un instantané cohérent
  * - GUIDs : {CEBFF5CD} = Executable File Execution, {F4E57C4B} = Shortcut File Execution
  * - Décodage ROT13 des noms valeurs (ex: HRZR_PGYFRFFVATF → UEME_EXECUTABLES)
  * - Parse données binaires : run count, last execution time, focus count, focus time
  * - Reconstruction timeline exécutions applications par user
- * - Export CSV UTF-8 avec logging complet
+ * - Comparaison des utilisateurs : agrégats et top-K en une passe parallèle, rapport JSON
+ * - Export CSV UTF-8 avec logging complet (journal asynchrone, sans blocage du scan)
+ * - Cache de résultats mappé (UserAssistCache\*.uacache) : hive inchangée rouverte sans analyse,
+ *   dernier scan du registre réaffiché au démarrage
+ * - Filtre compilé (chemin, GUID, utilisateur, compteurs, dates) appliqué à la vue et aux exports
+ * - Mesures par étape (parcours, ROT13, décodage, formatage, affichage, export) et valeurs
+ *   ignorées : une ligne JSON par scan ou export dans UserAssistDecoder.perf.json
  *
  * APIs : advapi32.lib, comctl32.lib
  * Auteur : WinToolsSuite
@@ -26,11 +35,24 @@
 #include <shlwapi.h>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <memory>
-#include <map>
+#include <thread>
+
+#include "UserAssistCore.h"
+#include "EntryStore.h"
+#include "HiveReader.h"
+#include "ExportSink.h"
+#include "TimelineFormat.h"
+#include "Snapshot.h"
+#include "Aggregates.h"
+#include "Rarity.h"
+#include "AsyncLog.h"
+#include "ScanScheduler.h"
+#include "ResultCache.h"
+#include "PerfCounters.h"
+#include "Query.h"
+#include "ResultModel.h"
 
 #pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "shlwapi.lib")
@@ -51,65 +73,31 @@ constexpr int IDC_BTN_DECODE = 1003;
 constexpr int IDC_BTN_EXPORT = 1004;
 constexpr int IDC_BTN_COMPARE = 1005;
 constexpr int IDC_STATUS = 1006;
-
-// GUIDs UserAssist
-const wchar_t* GUID_EXECUTABLE = L"{CEBFF5CD-ACE2-4F4F-9178-9926F41749EA}";
-const wchar_t* GUID_SHORTCUT = L"{F4E57C4B-2036-45F0-A9AB-443BCFE33D9F}";
-
-// Structure UserAssist data (Windows 7+)
-#pragma pack(push, 1)
-struct USERASSIST_ENTRY_WIN7 {
-    DWORD size;              // Taille de la structure
-    DWORD version;           // Version (3 pour Win7+)
-    DWORD runCount;          // Nombre d'exécutions
-    DWORD focusCount;        // Nombre de fois focus
-    DWORD focusTime;         // Temps total focus (ms)
-    FILETIME lastExecution;  // Dernière exécution
-    DWORD unknown[10];       // Réservé
-};
-#pragma pack(pop)
-
-// Structure pour une entrée UserAssist
-struct UserAssistEntry {
-    std::wstring application;
-    std::wstring decodedPath;
-    DWORD runCount;
-    std::wstring lastExecution;
-    DWORD focusCount;
-    DWORD focusTime;
-    std::wstring guid;
-    std::wstring username;
-};
-
-// RAII pour clé registry
-class RegKey {
-    HKEY h;
-public:
-    explicit RegKey(HKEY handle) : h(handle) {}
-    ~RegKey() { if (h) RegCloseKey(h); }
-    operator HKEY() const { return h; }
-    bool valid() const { return h != nullptr; }
-};
+constexpr int IDC_BTN_HIVE = 1007;
+constexpr int IDC_EDIT_FILTER = 1008;
+constexpr int IDC_BTN_FILTER = 1009;
 
 // Classe principale
 class UserAssistDecoder {
 private:
     HWND hwndMain, hwndList, hwndStatus;
-    std::vector<UserAssistEntry> entries;
-    std::wofstream logFile;
+    ResultModel results;    // Lots publiés par le worker de scan, instantanés immuables
+    ResultView view;        // Instantané affiché et lignes retenues par le filtre (thread UI)
+    ResultRowCache rowCache;        // Cellules formatées à la demande (LVN_GETDISPINFO)
+    AsyncLogger logger;     // Écriture en arrière-plan, sûr depuis le worker de scan
     HANDLE hWorkerThread;
-    volatile bool stopProcessing;
-
-    void Log(const std::wstring& message) {
-        if (logFile.is_open()) {
-            SYSTEMTIME st;
-            GetLocalTime(&st);
-            wchar_t timeStr[64];
-            swprintf_s(timeStr, L"[%02d/%02d/%04d %02d:%02d:%02d] ",
-                      st.wDay, st.wMonth, st.wYear, st.wHour, st.wMinute, st.wSecond);
-            logFile << timeStr << message << std::endl;
-            logFile.flush();
-        }
+    ScanScheduler scanner;  // Annulation (bouton Scanner / fermeture) et progression du worker
+    std::wstring hivePath;   // Vide = registre live (HKCU)
+    UserAssistSnapshot lastScan;     // Instantané du scan précédent de la même source
+    std::wstring lastScanSource;
+    std::wstring cacheDir;   // <dossier de l'exe>\UserAssistCache
+    PerfCounters perf;      // Scan ou export en cours, rapporté à la fin
+    Query filter;           // Requête du champ de filtre (vide = tout afficher)
+    double filterMs = 0;
+    std::wstring perfPath;
+
+    void Log(const std::wstring& message, LogLevel level = UA_LOG_INFO) {
+        logger.Write(level, message);
     }
 
     void UpdateStatus(const std::wstring& text) {
@@ -117,223 +105,288 @@ private:
         Log(text);
     }
 
-    std::wstring FileTimeToString(FILETIME ft) {
-        if (ft.dwLowDateTime == 0 && ft.dwHighDateTime == 0) {
-            return L"Jamais";
+    // Résumé des changements depuis le scan précédent de la même source, puis nouvel instantané
+    void ReportScanChanges(const EntryStore& entries) {
+        std::wstring status = L"Scan terminé : " + std::to_wstring(entries.size()) + L" entrées trouvées";
+        if (lastScanSource == hivePath && !lastScan.empty()) {
+            std::vector<EntryDiff> diffs;
+            SnapshotDiffSummary summary = lastScan.Diff(entries, diffs);
+            status += L" (" + std::to_wstring(summary.added) + L" nouvelles, " +
+                      std::to_wstring(summary.updated) + L" modifiées depuis le scan précédent)";
         }
+        lastScan.Assign(entries);
+        lastScanSource = hivePath;
+        Log(status);
+        UpdateStatus(status);
+    }
 
-        SYSTEMTIME st;
-        if (FileTimeToSystemTime(&ft, &st)) {
-            wchar_t buf[128];
-            swprintf_s(buf, L"%02d/%02d/%04d %02d:%02d:%02d",
-                      st.wDay, st.wMonth, st.wYear, st.wHour, st.wMinute, st.wSecond);
-            return buf;
+    // Rapport de performance de l'opération terminée, ajouté en NDJSON (historique par version et par hôte)
+    void WritePerfReport(std::string_view operation) {
+        FileSink file;
+        if (!file.Open(perfPath.c_str(), true)) {
+            Log(L"Écriture du rapport de performance impossible : " + perfPath, UA_LOG_WARNING);
+            return;
         }
-        return L"Invalide";
+        Utf8Writer writer(file);
+        JsonWriter json(writer);
+        WritePerfJson(json, perf, "UserAssistDecoder", operation, std::thread::hardware_concurrency());
+        writer.Flush();
     }
 
-    std::wstring MsToTimeString(DWORD milliseconds) {
-        DWORD seconds = milliseconds / 1000;
-        DWORD minutes = seconds / 60;
-        DWORD hours = minutes / 60;
-
-        seconds %= 60;
-        minutes %= 60;
-
-        wchar_t buf[64];
-        if (hours > 0) {
-            swprintf_s(buf, L"%dh %02dm %02ds", hours, minutes, seconds);
-        } else if (minutes > 0) {
-            swprintf_s(buf, L"%dm %02ds", minutes, seconds);
+    // Cache d'une source : registre live, ou hive identifiée par son chemin (le contenu est vérifié par hachage)
+    std::wstring CachePath(const std::wstring& source) const {
+        wchar_t name[32];
+        if (source.empty()) {
+            wcscpy_s(name, L"registre.uacache");
         } else {
-            swprintf_s(buf, L"%ds", seconds);
+            std::wstring lower = source;
+            CharLowerBuffW(&lower[0], static_cast<DWORD>(lower.size()));
+            swprintf_s(name, L"hive-%08x.uacache",
+                       Fnv1a32(reinterpret_cast<const uint8_t*>(lower.data()), lower.size() * sizeof(wchar_t)));
         }
-        return buf;
+        wchar_t path[MAX_PATH];
+        wcsncpy_s(path, cacheDir.c_str(), _TRUNCATE);
+        PathAppendW(path, name);
+        return path;
     }
 
-    // Décodage ROT13
-    std::wstring DecodeROT13(const std::wstring& input) {
-        std::wstring output;
-        output.reserve(input.size());
-
-        for (wchar_t ch : input) {
-            if (ch >= L'A' && ch <= L'Z') {
-                output += static_cast<wchar_t>((ch - L'A' + 13) % 26 + L'A');
-            } else if (ch >= L'a' && ch <= L'z') {
-                output += static_cast<wchar_t>((ch - L'a' + 13) % 26 + L'a');
-            } else {
-                output += ch;
-            }
+    void SaveResultCache(const std::wstring& path, uint64_t sourceHash, const EntryStore& entries) {
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        uint64_t created = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+        if (!WriteResultCache(path, entries, sourceHash, created)) {
+            Log(L"Écriture du cache impossible : " + path, UA_LOG_WARNING);
         }
-
-        return output;
     }
 
-    bool ParseUserAssistKey(HKEY hKeyUser, const wchar_t* guid, const wchar_t* username) {
-        wchar_t subkey[512];
-        swprintf_s(subkey, L"Software\\Microsoft\\Windows\\CurrentVersion\\Explorer\\UserAssist\\%s\\Count", guid);
-
-        HKEY hKey = nullptr;
-        if (RegOpenKeyExW(hKeyUser, subkey, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
-            return false;
+    // Dernier scan du registre réaffiché au démarrage, base des changements du prochain scan
+    void LoadLastScan() {
+        ResultCache cache;
+        std::string error;
+        if (!cache.Open(CachePath(L""), error)) {
+            return;
         }
+        auto entries = std::make_shared<EntryStore>();
+        cache.LoadInto(*entries);
+        lastScan.Assign(*entries);
+        lastScanSource.clear();
+        results.Reset(entries);
+        RefreshView();
+        UpdateStatus(L"Dernier scan du registre (" + LastExecutionText(UA_TIME_VALID, cache.CreatedTime()) +
+                     L") : " + std::to_wstring(entries->size()) + L" entrées reprises du cache");
+    }
 
-        RegKey key(hKey);
-
-        DWORD index = 0;
-        wchar_t valueName[16384];
-        DWORD valueNameSize;
-        BYTE data[1024];
-        DWORD dataSize;
-        DWORD type;
-
-        while (true) {
-            valueNameSize = 16384;
-            dataSize = sizeof(data);
-
-            LONG result = RegEnumValueW(hKey, index, valueName, &valueNameSize, nullptr, &type, data, &dataSize);
-
-            if (result == ERROR_NO_MORE_ITEMS) {
-                break;
-            }
-
-            if (result != ERROR_SUCCESS) {
-                index++;
-                continue;
-            }
+    // Toutes les sources (profils chargés sous HKU, ou la hive offline choisie), toutes les
+    // sous-clés {GUID} en parallèle ; appelé depuis le worker. Les clés terminées sont publiées
+    // au fil du scan, puis le résultat fusionné (ordre déterministe) les remplace. Renvoie false si annulé.
+    bool ScanUserAssist() {
+        std::vector<ScanSource> sources;
+        if (hivePath.empty()) {
+            sources = EnumerateLoadedProfiles();
+        } else {
+            // Le profil est le dossier parent (C:\Users\<nom>\NTUSER.DAT)
+            wchar_t username[MAX_PATH];
+            wcsncpy_s(username, hivePath.c_str(), _TRUNCATE);
+            PathRemoveFileSpecW(username);
+
+            ScanSource source;
+            source.kind = UA_SOURCE_HIVE;
+            source.user = PathFindFileNameW(username);
+            source.hive = hivePath;
+            sources.push_back(std::move(source));
+        }
 
-            // Décoder le nom (ROT13)
-            std::wstring decodedName = DecodeROT13(valueName);
-
-            UserAssistEntry entry;
-            entry.application = valueName;
-            entry.decodedPath = decodedName;
-            entry.guid = guid;
-            entry.username = username;
-
-            // Parser les données binaires
-            if (dataSize >= sizeof(USERASSIST_ENTRY_WIN7) && type == REG_BINARY) {
-                USERASSIST_ENTRY_WIN7* uaData = reinterpret_cast<USERASSIST_ENTRY_WIN7*>(data);
-
-                // Version 3 ou 5 (Windows 7/8/10)
-                if (uaData->version == 3 || uaData->version == 5) {
-                    entry.runCount = uaData->runCount;
-                    entry.focusCount = uaData->focusCount;
-                    entry.focusTime = uaData->focusTime;
-                    entry.lastExecution = FileTimeToString(uaData->lastExecution);
-                } else {
-                    // Version ancienne (XP/Vista)
-                    entry.runCount = dataSize >= 8 ? *reinterpret_cast<DWORD*>(data + 4) : 0;
-                    entry.focusCount = 0;
-                    entry.focusTime = 0;
-                    entry.lastExecution = L"N/A (ancienne version)";
-                }
-            } else {
-                entry.runCount = 0;
-                entry.focusCount = 0;
-                entry.focusTime = 0;
-                entry.lastExecution = L"Données invalides";
+        // Hive au contenu inchangé depuis le dernier scan : lignes reprises du cache, sans analyse
+        std::wstring cachePath = CachePath(hivePath);
+        uint64_t sourceHash = 0;
+        auto entries = std::make_shared<EntryStore>();
+        if (!hivePath.empty() && HashFileContent(hivePath, sourceHash)) {
+            ResultCache cache;
+            std::string error;
+            if (cache.Open(cachePath, error) && cache.Matches(sourceHash)) {
+                PerfTally tally;
+                cache.LoadInto(*entries);
+                tally.Count(PERF_VALUES, entries->size());
+                tally.Lap(PERF_STORE);
+                perf.Add(tally);
+                Log(L"Hive inchangée, " + std::to_wstring(entries->size()) + L" entrées reprises du cache");
+                results.Reset(entries);
+                return true;
             }
-
-            entries.push_back(entry);
-            index++;
         }
 
-        return index > 0;
+        bool complete = scanner.Run(sources, *entries);
+        Log(L"Scan " + std::wstring(complete ? L"terminé" : L"annulé") + L" : " +
+            std::to_wstring(sources.size()) + L" source(s), " + std::to_wstring(entries->size()) + L" entrées");
+        if (complete) {
+            SaveResultCache(cachePath, sourceHash, *entries);
+        }
+        results.Reset(entries);
+        return complete;
     }
 
-    bool ScanUserAssist() {
-        entries.clear();
-
-        // Scan HKEY_CURRENT_USER
-        wchar_t username[256] = L"Utilisateur actuel";
-        DWORD size = 256;
-        GetUserNameW(username, &size);
+    void OnScanProgress() {
+        ScanProgress progress = scanner.Progress();
+        if (progress.cancelled) {
+            return;
+        }
+        RefreshView();
+        SetWindowTextW(hwndStatus, (L"Scan en cours : " + std::to_wstring(progress.sourcesDone) + L"/" +
+                                    std::to_wstring(progress.sources) + L" profils, " +
+                                    std::to_wstring(progress.tasksDone) + L"/" + std::to_wstring(progress.tasks) +
+                                    L" clés GUID, " + std::to_wstring(progress.values) + L" valeurs").c_str());
+    }
 
-        int count = 0;
-        if (ParseUserAssistKey(HKEY_CURRENT_USER, GUID_EXECUTABLE, username)) {
-            count++;
+    void OnScanFinished(bool complete) {
+        if (hWorkerThread) {
+            WaitForSingleObject(hWorkerThread, INFINITE);   // Le worker a posté sa fin : sortie immédiate
+            CloseHandle(hWorkerThread);
+            hWorkerThread = nullptr;
         }
-        if (ParseUserAssistKey(HKEY_CURRENT_USER, GUID_SHORTCUT, username)) {
-            count++;
+        SetDlgItemTextW(hwndMain, IDC_BTN_SCAN, L"Scanner UserAssist");
+        EnableWindow(GetDlgItem(hwndMain, IDC_BTN_HIVE), TRUE);
+
+        RefreshView();
+        std::shared_ptr<const EntryStore> entries = view.Snapshot().Flatten();
+        if (!complete) {
+            UpdateStatus(L"Scan annulé : " + std::to_wstring(entries->size()) + L" entrées partielles");
+        } else if (entries->empty()) {
+            UpdateStatus(L"Aucune donnée UserAssist trouvée");
+        } else {
+            ReportScanChanges(*entries);
         }
-
-        // Optionnel : Scanner d'autres profils utilisateurs via HKU
-        // (nécessite élévation pour accéder à HKEY_USERS)
-
-        UpdateStatus(L"Scan terminé : " + std::to_wstring(entries.size()) + L" entrées trouvées");
-        return !entries.empty();
+        WritePerfReport(complete ? "scan" : "scan annule");
     }
 
-    void PopulateListView() {
-        ListView_DeleteAllItems(hwndList);
-
-        for (size_t i = 0; i < entries.size(); i++) {
-            LVITEMW lvi = {};
-            lvi.mask = LVIF_TEXT;
-            lvi.iItem = static_cast<int>(i);
-
-            lvi.iSubItem = 0;
-            lvi.pszText = const_cast<LPWSTR>(entries[i].decodedPath.c_str());
-            ListView_InsertItem(hwndList, &lvi);
-
-            ListView_SetItemText(hwndList, i, 1, const_cast<LPWSTR>(entries[i].application.c_str()));
-
-            wchar_t buf[32];
-            swprintf_s(buf, L"%u", entries[i].runCount);
-            ListView_SetItemText(hwndList, i, 2, buf);
-
-            ListView_SetItemText(hwndList, i, 3, const_cast<LPWSTR>(entries[i].lastExecution.c_str()));
-
-            swprintf_s(buf, L"%u", entries[i].focusCount);
-            ListView_SetItemText(hwndList, i, 4, buf);
-
-            std::wstring focusTimeStr = MsToTimeString(entries[i].focusTime);
-            ListView_SetItemText(hwndList, i, 5, const_cast<LPWSTR>(focusTimeStr.c_str()));
-
-            ListView_SetItemText(hwndList, i, 6, const_cast<LPWSTR>(entries[i].guid.c_str()));
+    // Dernier instantané publié affiché : seules les lignes nouvelles sont filtrées, la ListView
+    // virtuelle ne reçoit que le nombre d'items (cellules demandées par LVN_GETDISPINFO).
+    // reselect : filtre modifié, toutes les lignes de l'instantané courant sont resélectionnées.
+    void RefreshView(bool reselect = false) {
+        uint64_t start = PerfNow();
+        PerfTally tally;
+        bool reset = reselect;
+        if (reselect) {
+            view.Reselect(filter);
+        }
+        reset |= view.Update(results.Current(), filter);
+        filterMs = (PerfNow() - start) / 1e6;
+        tally.Lap(PERF_STORE);
+
+        int count = static_cast<int>(view.size());
+        if (reset) {
+            rowCache.Clear();
+            ListView_SetItemCountEx(hwndList, count, 0);
+            InvalidateRect(hwndList, nullptr, FALSE);
+        } else {
+            // Lignes ajoutées en fin de vue : items existants inchangés, défilement conservé
+            ListView_SetItemCountEx(hwndList, count, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+        }
+        tally.Lap(PERF_DISPLAY);
+        perf.Add(tally);
+    }
 
-            ListView_SetItemText(hwndList, i, 7, const_cast<LPWSTR>(entries[i].username.c_str()));
+    // LVN_GETDISPINFO : cellule d'un item visible, formatée au premier affichage de la ligne
+    void OnGetDispInfo(NMLVDISPINFOW* info) {
+        LVITEMW& item = info->item;
+        if (!(item.mask & LVIF_TEXT) || item.iItem < 0 || static_cast<size_t>(item.iItem) >= view.size() ||
+            item.iSubItem < 0 || static_cast<size_t>(item.iSubItem) >= RESULT_COLUMNS) {
+            return;
         }
+        PerfTally tally;
+        const FormattedRow& row = rowCache.Get(view, static_cast<size_t>(item.iItem));
+        wcsncpy_s(item.pszText, item.cchTextMax, row.cells[item.iSubItem].c_str(), _TRUNCATE);
+        tally.Lap(PERF_FORMAT);
+        perf.Add(tally);
     }
 
+    // Le worker ne touche pas à l'UI : fin et progression sont postées à la fenêtre
     static DWORD WINAPI ScanThreadProc(LPVOID param) {
         auto* pThis = static_cast<UserAssistDecoder*>(param);
+        bool complete = pThis->ScanUserAssist();
+        PostMessage(pThis->hwndMain, WM_USER + 1, complete ? 1 : 0, 0); // Signal scan terminé
+        return 0;
+    }
 
-        pThis->UpdateStatus(L"Scan UserAssist en cours...");
+    void StartScan() {
+        scanner.Reset();
+        perf.Reset();
+        // Vue vidée puis remplie au fil des clés GUID terminées (progression)
+        results.Reset(nullptr);
+        RefreshView();
+        UpdateStatus(hivePath.empty() ? L"Scan UserAssist en cours..." : L"Analyse de la hive : " + hivePath);
+        hWorkerThread = CreateThread(nullptr, 0, ScanThreadProc, this, 0, nullptr);
 
-        if (pThis->ScanUserAssist()) {
-            PostMessage(pThis->hwndMain, WM_USER + 1, 0, 0); // Signal scan terminé
-        } else {
-            pThis->UpdateStatus(L"Aucune donnée UserAssist trouvée");
+        if (hWorkerThread) {
+            SetDlgItemTextW(hwndMain, IDC_BTN_SCAN, L"Annuler le scan");
+            EnableWindow(GetDlgItem(hwndMain, IDC_BTN_HIVE), FALSE);
         }
-
-        return 0;
     }
 
     void OnScan() {
-        stopProcessing = false;
-        hWorkerThread = CreateThread(nullptr, 0, ScanThreadProc, this, 0, nullptr);
-
         if (hWorkerThread) {
-            EnableWindow(GetDlgItem(hwndMain, IDC_BTN_SCAN), FALSE);
+            // Annulation coopérative : les workers s'arrêtent à la valeur suivante
+            scanner.Cancel();
+            UpdateStatus(L"Annulation du scan...");
+            return;
+        }
+        hivePath.clear();
+        StartScan();
+    }
+
+    void OnLoadHive() {
+        OPENFILENAMEW ofn = {};
+        wchar_t fileName[MAX_PATH] = L"NTUSER.DAT";
+
+        ofn.lStructSize = sizeof(OPENFILENAMEW);
+        ofn.hwndOwner = hwndMain;
+        ofn.lpstrFilter = L"Hives registre (NTUSER.DAT)\0NTUSER.DAT;*.dat;*.hve\0All Files (*.*)\0*.*\0";
+        ofn.lpstrFile = fileName;
+        ofn.nMaxFile = MAX_PATH;
+        ofn.lpstrTitle = L"Charger une hive NTUSER.DAT offline";
+        ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST;
+
+        if (GetOpenFileNameW(&ofn)) {
+            hivePath = fileName;
+            StartScan();
         }
     }
 
     void OnDecode() {
-        if (entries.empty()) {
+        if (view.Snapshot().empty()) {
             MessageBoxW(hwndMain, L"Scannez d'abord les données UserAssist", L"Information", MB_ICONINFORMATION);
             return;
         }
 
         // Le décodage est déjà fait pendant le scan
         // Cette fonction pourrait être utilisée pour un re-décodage ou affichage alternatif
-        UpdateStatus(L"Décodage : " + std::to_wstring(entries.size()) + L" entrées décodées");
+        UpdateStatus(L"Décodage : " + std::to_wstring(view.total()) + L" entrées décodées");
         Log(L"Décodage ROT13 vérifié pour toutes les entrées");
     }
 
+    // Filtre compilé une fois, appliqué à la vue puis aux exports
+    void OnFilter() {
+        wchar_t text[1024];
+        GetDlgItemTextW(hwndMain, IDC_EDIT_FILTER, text, 1024);
+        Query query;
+        std::wstring error;
+        if (!query.Parse(text, error)) {
+            MessageBoxW(hwndMain, (L"Requête invalide : " + error).c_str(), L"Filtre", MB_ICONWARNING);
+            return;
+        }
+        filter = std::move(query);
+        RefreshView(true);
+
+        wchar_t elapsed[32];
+        swprintf_s(elapsed, L"%.2f", filterMs);
+        UpdateStatus(filter.empty() ? L"Filtre retiré : " + std::to_wstring(view.total()) + L" entrées"
+                                    : L"Filtre \"" + std::wstring(text) + L"\" : " +
+                                      std::to_wstring(view.size()) + L"/" + std::to_wstring(view.total()) +
+                                      L" entrées en " + elapsed + L" ms");
+    }
+
+    // Exports sur l'instantané affiché : cohérents même pendant un scan (lots immuables)
     void OnExport() {
-        if (entries.empty()) {
+        if (view.empty()) {
             MessageBoxW(hwndMain, L"Aucune donnée à exporter", L"Information", MB_ICONINFORMATION);
             return;
         }
@@ -343,7 +396,7 @@ private:
 
         ofn.lStructSize = sizeof(OPENFILENAMEW);
         ofn.hwndOwner = hwndMain;
-        ofn.lpstrFilter = L"CSV Files (*.csv)\0*.csv\0All Files (*.*)\0*.*\0";
+        ofn.lpstrFilter = L"CSV Files (*.csv)\0*.csv\0Timeline colonnaire (*.uatl)\0*.uatl\0All Files (*.*)\0*.*\0";
         ofn.lpstrFile = fileName;
         ofn.nMaxFile = MAX_PATH;
         ofn.lpstrTitle = L"Exporter la timeline UserAssist";
@@ -351,73 +404,175 @@ private:
         ofn.lpstrDefExt = L"csv";
 
         if (GetSaveFileNameW(&ofn)) {
-            std::wofstream csv(fileName, std::ios::binary);
-            if (!csv.is_open()) {
+            if (ofn.nFilterIndex == 2 || _wcsicmp(PathFindExtensionW(fileName), L".uatl") == 0) {
+                ExportColumnar(fileName);
+                return;
+            }
+
+            perf.Reset();
+            PerfTally tally;
+            FileSink file;
+            if (!file.Open(fileName)) {
                 MessageBoxW(hwndMain, L"Impossible de créer le fichier CSV", L"Erreur", MB_ICONERROR);
                 return;
             }
 
-            // BOM UTF-8
-            unsigned char bom[] = { 0xEF, 0xBB, 0xBF };
-            csv.write(reinterpret_cast<wchar_t*>(bom), sizeof(bom) / sizeof(wchar_t));
-
-            csv << L"Application,CheminDécodé,CompteurExéc,DernièreExéc,CompteurFocus,TempsFocus,GUID,Username\n";
-
-            for (const auto& entry : entries) {
-                csv << L"\"" << entry.application << L"\",\""
-                    << entry.decodedPath << L"\",\""
-                    << entry.runCount << L"\",\""
-                    << entry.lastExecution << L"\",\""
-                    << entry.focusCount << L"\",\""
-                    << MsToTimeString(entry.focusTime) << L"\",\""
-                    << entry.guid << L"\",\""
-                    << entry.username << L"\"\n";
+            // UTF-8 avec BOM, transcodé directement dans un buffer réutilisé
+            Utf8Writer writer(file);
+            CsvWriter csv(writer);
+            WriteUserAssistCsvHeader(csv, true);
+
+            // Lignes affichées (filtre courant)
+            std::wstring encodedName;
+            for (size_t item = 0; item < view.size(); item++) {
+                ResultRow row = view.Row(item);
+                WriteUserAssistCsvRow(csv, *row.store, row.row, encodedName);
             }
 
-            csv.close();
+            if (!writer.Flush()) {
+                MessageBoxW(hwndMain, L"Erreur d'écriture du fichier CSV", L"Erreur", MB_ICONERROR);
+                return;
+            }
+            tally.Count(PERF_VALUES, view.size());
+            tally.Lap(PERF_EXPORT);
+            perf.Add(tally);
+            WritePerfReport("export csv");
             UpdateStatus(L"Export réussi : " + std::wstring(fileName));
             Log(L"Export CSV : " + std::wstring(fileName));
             MessageBoxW(hwndMain, L"Export CSV réussi !", L"Succès", MB_ICONINFORMATION);
         }
     }
 
-    void OnCompare() {
-        if (entries.empty()) {
-            MessageBoxW(hwndMain, L"Scannez d'abord les données UserAssist", L"Information", MB_ICONINFORMATION);
+    // Timeline binaire colonnaire (relue par UserAssistTimeline ou un moteur d'analyse)
+    void ExportColumnar(const wchar_t* fileName) {
+        perf.Reset();
+        PerfTally tally;
+        FileSink file;
+        if (!file.Open(fileName)) {
+            MessageBoxW(hwndMain, L"Impossible de créer le fichier timeline", L"Erreur", MB_ICONERROR);
             return;
         }
 
-        // Créer une map par utilisateur pour comparaison
-        std::map<std::wstring, std::vector<UserAssistEntry*>> userEntries;
+        // Filtre actif ou scan en cours : lignes retenues recopiées dans un store dédié (groupes contigus)
+        EntryStore selected;
+        const ResultSnapshot& snapshot = view.Snapshot();
+        bool single = !view.Filtered() && snapshot.batches.size() == 1;
+        if (!single) {
+            view.Select(selected);
+        }
 
-        for (auto& entry : entries) {
-            userEntries[entry.username].push_back(&entry);
+        TimelineWriter timeline(file);
+        TimelineGroupBuilder builder;
+        if (!timeline.Begin() || !timeline.Append(single ? *snapshot.batches[0]->rows : selected, builder) ||
+            !timeline.Finish()) {
+            MessageBoxW(hwndMain, L"Erreur d'écriture du fichier timeline", L"Erreur", MB_ICONERROR);
+            return;
         }
+        tally.Count(PERF_VALUES, view.size());
+        tally.Lap(PERF_EXPORT);
+        perf.Add(tally);
+        WritePerfReport("export uatl");
+        UpdateStatus(L"Export réussi : " + std::wstring(fileName));
+        Log(L"Export timeline colonnaire : " + std::wstring(fileName));
+        MessageBoxW(hwndMain, L"Export timeline colonnaire réussi !", L"Succès", MB_ICONINFORMATION);
+    }
 
-        std::wstringstream report;
-        report << L"=== Rapport de Comparaison UserAssist ===\n\n";
+    // Rapport JSON des agrégats (mêmes données que UserAssistBatch -a)
+    void ExportAggregates(const AggregateEngine& engine) {
+        OPENFILENAMEW ofn = {};
+        wchar_t fileName[MAX_PATH] = L"userassist_agregats.json";
 
-        for (const auto& pair : userEntries) {
-            report << L"Utilisateur : " << pair.first << L"\n";
-            report << L"  Nombre d'applications : " << pair.second.size() << L"\n";
+        ofn.lStructSize = sizeof(OPENFILENAMEW);
+        ofn.hwndOwner = hwndMain;
+        ofn.lpstrFilter = L"JSON Files (*.json)\0*.json\0All Files (*.*)\0*.*\0";
+        ofn.lpstrFile = fileName;
+        ofn.nMaxFile = MAX_PATH;
+        ofn.lpstrTitle = L"Enregistrer le rapport de comparaison";
+        ofn.Flags = OFN_OVERWRITEPROMPT;
+        ofn.lpstrDefExt = L"json";
 
-            // Top 5 applications les plus exécutées
-            std::vector<UserAssistEntry*> sorted = pair.second;
-            std::sort(sorted.begin(), sorted.end(), [](UserAssistEntry* a, UserAssistEntry* b) {
-                return a->runCount > b->runCount;
-            });
+        if (!GetSaveFileNameW(&ofn)) {
+            return;
+        }
+        FileSink file;
+        if (!file.Open(fileName)) {
+            MessageBoxW(hwndMain, L"Impossible de créer le fichier JSON", L"Erreur", MB_ICONERROR);
+            return;
+        }
+        Utf8Writer writer(file);
+        JsonWriter json(writer);
+        WriteAggregatesJson(json, engine);
+        if (!writer.Flush()) {
+            MessageBoxW(hwndMain, L"Erreur d'écriture du fichier JSON", L"Erreur", MB_ICONERROR);
+            return;
+        }
+        UpdateStatus(L"Rapport enregistré : " + std::wstring(fileName));
+        Log(L"Rapport de comparaison JSON : " + std::wstring(fileName));
+    }
+
+    void OnCompare() {
+        // Toutes les lignes de l'instantané affiché, profils contigus (ordre du scan final)
+        std::shared_ptr<const EntryStore> all = view.Snapshot().Flatten();
+        if (all->empty()) {
+            MessageBoxW(hwndMain, L"Scannez d'abord les données UserAssist", L"Information", MB_ICONINFORMATION);
+            return;
+        }
+        const EntryStore& entries = *all;
+
+        // Une passe parallèle : agrégats par utilisateur/GUID/application et top-K bornés
+        AggregateEngine engine;
+        {
+            ThreadPool pool;
+            AggregateEntries(entries, engine, pool);
+        }
 
-            report << L"  Top 5 exécutions :\n";
-            for (size_t i = 0; i < std::min(size_t(5), sorted.size()); i++) {
-                report << L"    " << (i + 1) << L". " << sorted[i]->decodedPath
-                       << L" (" << sorted[i]->runCount << L" fois)\n";
+        wchar_t duration[UA_DURATION_TEXT_CHARS];
+        bool byFocusTime = engine.Options().metric == UA_METRIC_FOCUS_TIME;
+        std::wstring report = L"=== Rapport de Comparaison UserAssist ===\n\n";
+        for (const AggregateGroup* user : engine.Users()) {
+            report += L"Utilisateur : " + user->key + L"\n";
+            report += L"  Applications distinctes : " + std::to_wstring(user->DistinctApplications());
+            report += L", exécutions : " + std::to_wstring(user->runs);
+            report += L", temps de focus : ";
+            report.append(duration, FormatDuration(static_cast<uint32_t>(std::min<uint64_t>(user->focusTime, UINT32_MAX)),
+                                                   duration));
+            report += L"\n  Top " + std::to_wstring(engine.Options().topK) +
+                      (byFocusTime ? L" temps de focus :\n" : L" exécutions :\n");
+
+            size_t rank = 1;
+            for (const auto& item : engine.Top(*user)) {
+                report += L"    " + std::to_wstring(rank++) + L". " + std::wstring(item.second) + L" (";
+                if (byFocusTime) {
+                    report.append(duration, FormatDuration(static_cast<uint32_t>(std::min<uint64_t>(item.first, UINT32_MAX)),
+                                                           duration));
+                    report += L")\n";
+                } else {
+                    report += std::to_wstring(item.first) + L" fois)\n";
+                }
             }
+            report += L"\n";
+        }
 
-            report << L"\n";
+        // Rareté : applications vues chez un seul utilisateur (les lignes d'un profil sont contiguës)
+        if (engine.UserCount() > 1) {
+            RarityOptions rarityOptions;
+            rarityOptions.maxHosts = 1;
+            RarityEngine rarity(rarityOptions);
+            rarity.Add(entries);
+            std::vector<RarePath> rare = rarity.Rare();
+            report += L"Applications vues chez un seul utilisateur : " + std::to_wstring(rare.size()) + L"\n";
+            for (size_t i = 0; i < rare.size() && i < 10; i++) {
+                report += L"    " + rare[i].path + L"\n";
+            }
+            report += L"\n";
         }
+        report += L"Enregistrer le rapport complet (JSON) ?";
 
-        MessageBoxW(hwndMain, report.str().c_str(), L"Comparaison Utilisateurs", MB_ICONINFORMATION);
-        Log(L"Comparaison utilisateurs effectuée");
+        Log(L"Comparaison utilisateurs effectuée : " + std::to_wstring(engine.UserCount()) + L" utilisateurs, " +
+            std::to_wstring(engine.ApplicationCount()) + L" applications distinctes");
+        if (MessageBoxW(hwndMain, report.c_str(), L"Comparaison Utilisateurs", MB_ICONINFORMATION | MB_YESNO) == IDYES) {
+            ExportAggregates(engine);
+        }
     }
 
     void CreateControls(HWND hwnd) {
@@ -438,9 +593,24 @@ private:
                      MARGIN + (BUTTON_WIDTH + 10) * 3, btnY, BUTTON_WIDTH, BUTTON_HEIGHT, hwnd,
                      (HMENU)IDC_BTN_COMPARE, nullptr, nullptr);
 
+        CreateWindowW(L"BUTTON", L"Charger NTUSER.DAT", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+                     MARGIN + (BUTTON_WIDTH + 10) * 4, btnY, BUTTON_WIDTH, BUTTON_HEIGHT, hwnd,
+                     (HMENU)IDC_BTN_HIVE, nullptr, nullptr);
+
+        // Filtre : requête (ex. "chemin:*\\cmd.exe runs>=5 date>=2024-03-01"), appliquée par le bouton
+        int filterX = MARGIN + (BUTTON_WIDTH + 10) * 5;
+        int filterButton = 100;
+        CreateWindowExW(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | WS_TABSTOP | ES_AUTOHSCROLL,
+                        filterX, btnY + 4, WINDOW_WIDTH - filterX - filterButton - MARGIN * 2 - 20, BUTTON_HEIGHT - 8,
+                        hwnd, (HMENU)IDC_EDIT_FILTER, nullptr, nullptr);
+
+        CreateWindowW(L"BUTTON", L"Filtrer", WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+                     WINDOW_WIDTH - filterButton - MARGIN - 20, btnY, filterButton, BUTTON_HEIGHT, hwnd,
+                     (HMENU)IDC_BTN_FILTER, nullptr, nullptr);
+
         // ListView
         hwndList = CreateWindowExW(WS_EX_CLIENTEDGE, WC_LISTVIEWW, L"",
-                                  WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL,
+                                  WS_CHILD | WS_VISIBLE | LVS_REPORT | LVS_SINGLESEL | LVS_OWNERDATA,
                                   MARGIN, btnY + BUTTON_HEIGHT + 10,
                                   WINDOW_WIDTH - MARGIN * 2 - 20,
                                   WINDOW_HEIGHT - btnY - BUTTON_HEIGHT - 80,
@@ -476,6 +646,9 @@ private:
         lvc.cx = 150; lvc.pszText = const_cast<LPWSTR>(L"Username");
         ListView_InsertColumn(hwndList, 7, &lvc);
 
+        lvc.cx = 350; lvc.pszText = const_cast<LPWSTR>(L"Chemin Résolu");
+        ListView_InsertColumn(hwndList, 8, &lvc);
+
         // Status bar
         hwndStatus = CreateWindowExW(0, L"STATIC", L"Prêt - Cliquez sur 'Scanner UserAssist' pour commencer",
                                      WS_CHILD | WS_VISIBLE | SS_SUNKEN | SS_LEFT,
@@ -507,23 +680,38 @@ private:
                         case IDC_BTN_DECODE: pThis->OnDecode(); break;
                         case IDC_BTN_EXPORT: pThis->OnExport(); break;
                         case IDC_BTN_COMPARE: pThis->OnCompare(); break;
+                        case IDC_BTN_HIVE: pThis->OnLoadHive(); break;
+                        case IDC_BTN_FILTER: pThis->OnFilter(); break;
                     }
                     return 0;
 
-                case WM_USER + 1: // Scan terminé
-                    pThis->PopulateListView();
-                    EnableWindow(GetDlgItem(hwnd, IDC_BTN_SCAN), TRUE);
-                    if (pThis->hWorkerThread) {
-                        CloseHandle(pThis->hWorkerThread);
-                        pThis->hWorkerThread = nullptr;
+                case WM_NOTIFY: {
+                    NMHDR* header = reinterpret_cast<NMHDR*>(lParam);
+                    if (header->idFrom == IDC_LISTVIEW && header->code == LVN_GETDISPINFOW) {
+                        pThis->OnGetDispInfo(reinterpret_cast<NMLVDISPINFOW*>(lParam));
+                    } else if (header->idFrom == IDC_LISTVIEW && header->code == LVN_ODCACHEHINT) {
+                        NMLVCACHEHINT* hint = reinterpret_cast<NMLVCACHEHINT*>(lParam);
+                        pThis->rowCache.Prefetch(pThis->view, static_cast<size_t>(std::max(0, hint->iFrom)),
+                                                 static_cast<size_t>(std::max(0, hint->iTo)));
                     }
                     return 0;
+                }
+
+                case WM_USER + 1: // Scan terminé (wParam = 0 si annulé)
+                    pThis->OnScanFinished(wParam != 0);
+                    return 0;
+
+                case WM_USER + 2: // Progression du scan (limitée par ScanScheduler)
+                    pThis->OnScanProgress();
+                    return 0;
 
                 case WM_DESTROY:
-                    pThis->stopProcessing = true;
+                    // Le worker ne bloque jamais sur l'UI : attente courte après annulation
+                    pThis->scanner.Cancel();
                     if (pThis->hWorkerThread) {
-                        WaitForSingleObject(pThis->hWorkerThread, 2000);
+                        WaitForSingleObject(pThis->hWorkerThread, INFINITE);
                         CloseHandle(pThis->hWorkerThread);
+                        pThis->hWorkerThread = nullptr;
                     }
                     PostQuitMessage(0);
                     return 0;
@@ -535,22 +723,27 @@ private:
 
 public:
     UserAssistDecoder() : hwndMain(nullptr), hwndList(nullptr), hwndStatus(nullptr),
-                         hWorkerThread(nullptr), stopProcessing(false) {
+                         hWorkerThread(nullptr) {
+        scanner.OnProgress([this](const ScanProgress&) { PostMessage(hwndMain, WM_USER + 2, 0, 0); });
+        scanner.OnBatch([this](size_t source, const std::wstring& guid, std::shared_ptr<const EntryStore> entries) {
+            results.Append(ResultBatch{ source, guid, std::move(entries) });
+        });
+        scanner.SetPerfCounters(&perf);
         wchar_t logPath[MAX_PATH];
         GetModuleFileNameW(nullptr, logPath, MAX_PATH);
         PathRemoveFileSpecW(logPath);
+        cacheDir = logPath;
+        cacheDir += L"\\UserAssistCache";
+        perfPath = std::wstring(logPath) + L"\\UserAssistDecoder.perf.json";
         PathAppendW(logPath, L"UserAssistDecoder.log");
 
-        logFile.open(logPath, std::ios::app);
-        logFile.imbue(std::locale(std::locale(), new std::codecvt_utf8<wchar_t>));
+        logger.Open(logPath);
         Log(L"=== UserAssistDecoder démarré ===");
     }
 
     ~UserAssistDecoder() {
         Log(L"=== UserAssistDecoder terminé ===");
-        if (logFile.is_open()) {
-            logFile.close();
-        }
+        logger.Close();
     }
 
     int Run(HINSTANCE hInstance, int nCmdShow) {
@@ -583,6 +776,7 @@ public:
 
         ShowWindow(hwndMain, nCmdShow);
         UpdateWindow(hwndMain);
+        LoadLastScan();
 
         MSG msg = {};
         while (GetMessage(&msg, nullptr, 0, 0)) {
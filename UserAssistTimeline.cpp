@@ -0,0 +1,233 @@
+/*
+ * UserAssistTimeline - lecteur/vérificateur de timelines colonnaires .uatl (WinToolsSuite Serie 3 #21)
+ * Produites par UserAssistBatch (-f uatl) ou l'export "Timeline colonnaire" de UserAssistDecoder.
+ *
+ * Commandes :
+ * - info   : groupes de lignes, volumes et plages de dates
+ * - verify : contrôle complet (structure, sommes de contrôle, dictionnaires, statistiques)
+ * - dump   : CSV UTF-8 sur stdout ; -a/-b filtrent par date (groupes hors plage ignorés sans lecture),
+ *            -c ne charge que les colonnes demandées
+ *
+ * Portable : Windows (cl.exe, voir go.bat) et Linux (g++, voir go.sh)
+ * Auteur : WinToolsSuite
+ * License : MIT
+ */
+
+#include "UserAssistCore.h"
+#include "ExportSink.h"
+#include "HiveReader.h"
+#include "TimelineFormat.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Colonnes exportables par dump (nom d'option, en-tête CSV en UTF-8)
+struct DumpColumn {
+    const char* option;
+    const char* header;
+    uint32_t column;
+};
+
+static const DumpColumn DUMP_COLUMNS[] = {
+    { "path", "CheminD\xC3\xA9" "cod\xC3\xA9", TL_COL_PATH },
+    { "run", "CompteurEx\xC3\xA9" "c", TL_COL_RUN_COUNT },
+    { "time", "Derni\xC3\xA8reEx\xC3\xA9" "c", TL_COL_LAST_EXECUTION },
+    { "focus", "CompteurFocus", TL_COL_FOCUS_COUNT },
+    { "focustime", "TempsFocus", TL_COL_FOCUS_TIME },
+    { "guid", "GUID", TL_COL_GUID },
+    { "user", "Username", TL_COL_USER },
+};
+
+static void PrintUsage() {
+    std::fprintf(stderr,
+        "UserAssistTimeline - lecture des timelines colonnaires .uatl\n\n"
+        "Usage : UserAssistTimeline <info|verify|dump> <fichier.uatl> [options]\n"
+        "  -a <date>      dump : exécutions à partir de cette date (ISO-8601 UTC, ex. 2024-01-31T08:00:00Z)\n"
+        "  -b <date>      dump : exécutions jusqu'à cette date incluse\n"
+        "  -c <colonnes>  dump : colonnes séparées par des virgules\n"
+        "                 (path,run,time,focus,focustime,guid,user ; défaut : toutes)\n\n"
+        "Code retour : 0 = succès, 1 = erreur d'usage ou de lecture, 2 = fichier invalide\n");
+}
+
+static std::string FormatTime(uint64_t ft) {
+    char text[UA_TIME_TEXT_CHARS];
+    return std::string(text, FormatFileTimeIso8601(ft, text));
+}
+
+static int CommandInfo(const TimelineReader& reader, uint64_t fileSize) {
+    std::printf("Groupes : %zu, lignes : %llu, taille : %.1f Ko\n", reader.groups(),
+                static_cast<unsigned long long>(reader.rows()), fileSize / 1024.0);
+    for (size_t g = 0; g < reader.groups(); g++) {
+        const TimelineGroupInfo& info = reader.group(g);
+        std::printf("  [%zu] %u lignes, %u chaînes, ", g, info.rows, info.dictCount);
+        if (info.minTime > info.maxTime) {
+            std::printf("aucune date valide\n");
+        } else {
+            std::printf("%s -> %s\n", FormatTime(info.minTime).c_str(), FormatTime(info.maxTime).c_str());
+        }
+    }
+    return 0;
+}
+
+static int CommandDump(const TimelineReader& reader, uint64_t from, uint64_t to,
+                       const std::vector<const DumpColumn*>& columns) {
+    bool timeFilter = from != 0 || to != UINT64_MAX;
+
+    FileSink out;
+    out.OpenStdout();
+    Utf8Writer writer(out);
+    CsvWriter csv(writer);
+
+    std::string header;
+    for (const DumpColumn* column : columns) {
+        if (!header.empty()) header += ',';
+        header += column->header;
+    }
+    csv.RawRecord(header);
+
+    uint64_t skipped = 0;
+    for (size_t g = 0; g < reader.groups(); g++) {
+        const TimelineGroupInfo& info = reader.group(g);
+        if (timeFilter && !info.Overlaps(from, to)) {
+            skipped++;
+            continue;
+        }
+
+        // Seules les colonnes utiles sont touchées (pages du mapping jamais lues sinon)
+        auto times = reader.Column<uint64_t>(g, TL_COL_LAST_EXECUTION);
+        auto status = reader.Column<uint8_t>(g, TL_COL_TIME_STATUS);
+        for (uint32_t row = 0; row < info.rows; row++) {
+            if (timeFilter) {
+                uint64_t ft = times[row];
+                if (status[row] != UA_TIME_VALID || ft == 0 || ft < from || ft > to) {
+                    continue;
+                }
+            }
+            for (const DumpColumn* column : columns) {
+                switch (column->column) {
+                case TL_COL_PATH:
+                case TL_COL_GUID:
+                case TL_COL_USER: {
+                    std::string_view text = reader.DictString(g, reader.Column<uint32_t>(g, column->column)[row]);
+                    csv.Field(text.data(), text.size());
+                    break;
+                }
+                case TL_COL_LAST_EXECUTION: {
+                    char text[UA_TIME_TEXT_CHARS];
+                    csv.Field(text, FormatLastExecution(status[row], times[row], text));
+                    break;
+                }
+                case TL_COL_FOCUS_TIME: {
+                    char text[UA_DURATION_TEXT_CHARS];
+                    csv.Field(text, FormatDuration(reader.Column<uint32_t>(g, TL_COL_FOCUS_TIME)[row], text));
+                    break;
+                }
+                default:
+                    csv.Field(static_cast<uint64_t>(reader.Column<uint32_t>(g, column->column)[row]));
+                    break;
+                }
+            }
+            csv.EndRow();
+        }
+    }
+
+    if (!writer.Flush()) {
+        std::fprintf(stderr, "Erreur d'écriture de la sortie\n");
+        return 1;
+    }
+    if (timeFilter) {
+        std::fprintf(stderr, "%llu groupe(s) sur %zu ignoré(s) par les statistiques min/max\n",
+                     static_cast<unsigned long long>(skipped), reader.groups());
+    }
+    return 0;
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** argv) {
+#else
+int main(int argc, char** argv) {
+#endif
+    std::vector<fs::path> args(argv + 1, argv + argc);
+    if (args.size() < 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string command = args[0].u8string();
+    const fs::path& path = args[1];
+    uint64_t from = 0, to = UINT64_MAX;
+    std::vector<const DumpColumn*> columns;
+
+    for (size_t i = 2; i < args.size(); i++) {
+        const fs::path& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        if ((arg == "-a" || arg == "-b") && hasValue) {
+            uint64_t& bound = arg == "-a" ? from : to;
+            if (!ParseIso8601(args[++i].c_str(), bound)) {
+                std::fprintf(stderr, "Date invalide : %s\n", args[i].u8string().c_str());
+                return 1;
+            }
+        } else if (arg == "-c" && hasValue) {
+            std::string list = args[++i].u8string();
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) end = list.size();
+                std::string name = list.substr(start, end - start);
+                const DumpColumn* found = nullptr;
+                for (const auto& column : DUMP_COLUMNS) {
+                    if (name == column.option) found = &column;
+                }
+                if (!found) {
+                    std::fprintf(stderr, "Colonne inconnue : %s\n", name.c_str());
+                    return 1;
+                }
+                columns.push_back(found);
+                start = end + 1;
+            }
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (columns.empty()) {
+        for (const auto& column : DUMP_COLUMNS) columns.push_back(&column);
+    }
+
+    MappedFile file;
+    if (!file.Open(path.c_str())) {
+        std::fprintf(stderr, "Ouverture impossible : %s\n", path.u8string().c_str());
+        return 1;
+    }
+
+    TimelineReader reader;
+    std::string error;
+    if (!reader.Open(file.data(), file.size(), error)) {
+        std::fprintf(stderr, "[INVALIDE] %s : %s\n", path.u8string().c_str(), error.c_str());
+        return 2;
+    }
+
+    if (command == "info") {
+        return CommandInfo(reader, file.size());
+    }
+    if (command == "verify") {
+        if (!reader.Verify(error)) {
+            std::fprintf(stderr, "[INVALIDE] %s : %s\n", path.u8string().c_str(), error.c_str());
+            return 2;
+        }
+        std::fprintf(stderr, "[OK] %s : %zu groupes, %llu lignes\n", path.u8string().c_str(), reader.groups(),
+                     static_cast<unsigned long long>(reader.rows()));
+        return 0;
+    }
+    if (command == "dump") {
+        return CommandDump(reader, from, to, columns);
+    }
+
+    PrintUsage();
+    return 1;
+}
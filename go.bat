@@ -6,23 +6,58 @@ echo ========================================
 echo Building UserAssistDecoder
 echo ========================================
 
-cl.exe /nologo /W4 /EHsc /O2 /DUNICODE /D_UNICODE ^
+cl.exe /nologo /W4 /EHsc /O2 /std:c++17 /DUNICODE /D_UNICODE ^
     /Fe:UserAssistDecoder.exe ^
     UserAssistDecoder.cpp ^
     /link ^
     comctl32.lib shlwapi.lib advapi32.lib user32.lib gdi32.lib shell32.lib
 
-if %ERRORLEVEL% EQU 0 (
-    echo.
-    echo ========================================
-    echo Build successful!
-    echo Executable: UserAssistDecoder.exe
-    echo ========================================
-    if exist UserAssistDecoder.obj del UserAssistDecoder.obj
-) else (
-    echo.
-    echo ========================================
-    echo Build FAILED!
-    echo ========================================
-    exit /b 1
-)
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo ========================================
+echo Building UserAssistBatch (mode headless)
+echo ========================================
+
+cl.exe /nologo /W4 /EHsc /O2 /std:c++17 /DUNICODE /D_UNICODE ^
+    /Fe:UserAssistBatch.exe ^
+    UserAssistBatch.cpp
+
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo ========================================
+echo Building UserAssistTimeline (lecteur .uatl)
+echo ========================================
+
+cl.exe /nologo /W4 /EHsc /O2 /std:c++17 /DUNICODE /D_UNICODE ^
+    /Fe:UserAssistTimeline.exe ^
+    UserAssistTimeline.cpp
+
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo ========================================
+echo Building UserAssistBench (benchmarks)
+echo ========================================
+
+cl.exe /nologo /W4 /EHsc /O2 /std:c++17 /DUNICODE /D_UNICODE ^
+    /Fe:UserAssistBench.exe ^
+    UserAssistBench.cpp
+
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo.
+echo ========================================
+echo Build successful!
+echo Executables: UserAssistDecoder.exe, UserAssistBatch.exe, UserAssistTimeline.exe, UserAssistBench.exe
+echo ========================================
+if exist UserAssistDecoder.obj del UserAssistDecoder.obj
+if exist UserAssistBatch.obj del UserAssistBatch.obj
+if exist UserAssistTimeline.obj del UserAssistTimeline.obj
+if exist UserAssistBench.obj del UserAssistBench.obj
+exit /b 0
+
+:failed
+echo.
+echo ========================================
+echo Build FAILED!
+echo ========================================
+exit /b 1
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Compilation script for UserAssistBatch, UserAssistTimeline and UserAssistBench (Linux / analysis farm)
+# WinToolsSuite Serie 3 - Forensics Tool #21
+#
+# L'interface graphique (UserAssistDecoder.cpp) reste Windows uniquement : voir go.bat
+
+set -e
+CXX=${CXX:-g++}
+
+echo "========================================"
+echo "Building UserAssistBatch"
+echo "========================================"
+
+$CXX -std=c++17 -O2 -Wall -Wextra -pthread -o UserAssistBatch UserAssistBatch.cpp
+
+echo "========================================"
+echo "Building UserAssistTimeline"
+echo "========================================"
+
+$CXX -std=c++17 -O2 -Wall -Wextra -pthread -o UserAssistTimeline UserAssistTimeline.cpp
+
+echo "========================================"
+echo "Building UserAssistBench"
+echo "========================================"
+
+$CXX -std=c++17 -O2 -Wall -Wextra -pthread -o UserAssistBench UserAssistBench.cpp
+
+echo "Build successful! Executables: UserAssistBatch, UserAssistTimeline, UserAssistBench"